@@ -4,6 +4,8 @@ namespace LearnVulkan
 {
     void Application::run()
     {
+        mStartTime = std::chrono::steady_clock::now();
+
         initWindow();
         initVulkan();
         mainLoop();
@@ -34,22 +36,96 @@ namespace LearnVulkan
 
         mSwapChain->createFrameBuffers(mRenderPass);
 
+        // 所有初始资源（纹理、模型缓冲区）的上传收集到一起，记录命令缓冲区之前一次提交
+        mUploadContext = Wrapper::UploadContext::create(mDevice);
+
+        const auto textureStart = std::chrono::steady_clock::now();
+
+        if (mTextureBudget > 0)
+        {
+            TextureStreamer::Settings streamSettings{};
+            streamSettings.mBudget = mTextureBudget;
+
+            mTextureStreamer = TextureStreamer::create(mDevice, streamSettings);
+        }
+
+        mAssetCache = AssetCache::create(mDevice);
+
         mUniformManager = UniformManager::create();
-        mUniformManager->init(mDevice, mCommandPool, mSwapChain->getImageCount());
+        mUniformManager->setObjectCapacity(mObjectCount);
+        // 常量环形缓冲区的分段、簇剔除的描述符集和间接参数都按在途帧数分配，与交换链图像数无关
+        mUniformManager->init(mDevice, mUploadContext, mFramesInFlight, mTextureDecodeThreads, mTextureStreamer, mAssetCache);
+
+        std::cout << "Texture load: "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - textureStart).count() << " ms ("
+                  << (mTextureDecodeThreads == 1 ? "serial" : "parallel") << " decode)" << std::endl;
+
+        const auto samplerCache = mDevice->getSamplerCache();
+        std::cout << "Samplers: " << samplerCache->getSamplerCount() << " unique for " << samplerCache->getRequestCount()
+                  << " requests (maxSamplerAllocationCount " << samplerCache->getMaxSamplerCount() << ")" << std::endl;
+
+        AssetCache::ModelOptions modelOptions{};
+        modelOptions.mOptimizeMesh       = true;
+        modelOptions.mVertexQuantization = Model::VertexQuantization::Snorm16;
+        modelOptions.mBuildMeshlets      = true;
+        modelOptions.mGenerateLods       = true;
+
+        mModel = mAssetCache->getModel("assets/models/diablo3_pose/diablo3_pose.obj", modelOptions, mUploadContext);
+
+        mAssetCache->printStats();
+
+        // 簇剔除的常量只有一个模型矩阵，只用于单个物体
+        if (mModel->getMeshletCount() > 0 && mObjectCount == 1)
+        {
+            mClusterCuller = ClusterCuller::create(mDevice, mModel, mFramesInFlight);
+        }
+
+        // 多个物体在 XZ 平面上排成方阵，以模型原点为中心列向远离相机的方向延伸；列号轮换使第一个物体正好在原点
+        const int   gridSide = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(mObjectCount))));
+        const float spacing  = mModel->getBoundingSphere().w * 2.5f;
+
+        for (uint32_t i = 0; i < mObjectCount; ++i)
+        {
+            const int column = (static_cast<int>(i) % gridSide + gridSide / 2) % gridSide - gridSide / 2;
+            const int row    = static_cast<int>(i) / gridSide;
+
+            mObjectPositions.push_back(glm::vec3(column * spacing, 0.0f, -row * spacing));
+        }
 
-        mModel = Model::create(mDevice);
-        mModel->loadModel("assets/models/diablo3_pose/diablo3_pose.obj", mDevice);
+        const uint32_t recordThreads = mRecordThreads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : mRecordThreads;
+
+        if (recordThreads > 1 && mObjectCount >= 2 * SecondaryRecorder::MinItemsPerSegment)
+        {
+            mSecondaryRecorder = SecondaryRecorder::create(mDevice, recordThreads, mFramesInFlight);
+        }
+
+        std::cout << "Objects: " << mObjectCount << ", recorded "
+                  << (mSecondaryRecorder ? "on " + std::to_string(recordThreads) + " threads" : std::string("inline")) << std::endl;
+
+        // 只提交不等待：上传在传输队列上进行时，之后的渲染提交按队列顺序排在获取屏障之后
+        mUploadContext->submit();
 
         mPipeline = Wrapper::Pipeline::create(mDevice, mRenderPass);
         createPipeline();
 
-        mCommandBuffers.resize(mSwapChain->getImageCount());
-        createCommandBuffers();
-
         createSyncObjects();
+
+        mDevice->getAllocator()->printStats();
     }
 
     void Application::createPipeline()
+    {
+        // 深度预渲染：先只用位置流写深度，颜色 Pass 以 EQUAL 测试，每个像素只着色一次
+        if (mDepthPrepass)
+        {
+            mDepthPipeline = Wrapper::Pipeline::create(mDevice, mRenderPass);
+            setupPipeline(mDepthPipeline, true);
+        }
+
+        setupPipeline(mPipeline, false);
+    }
+
+    void Application::setupPipeline(const Wrapper::Pipeline::Ptr& pipeline, bool depthOnly)
     {
         VkViewport viewport = {};
         viewport.x = 0.0f;
@@ -63,58 +139,65 @@ namespace LearnVulkan
         scissor.offset   = { 0, 0 };
         scissor.extent   = { mWidth, mHeight };
 
-        mPipeline->setViewports({ viewport });
-        mPipeline->setScissors({ scissor });
+        pipeline->setViewports({ viewport });
+        pipeline->setScissors({ scissor });
 
         std::vector<Wrapper::Shader::Ptr> shaderGroup{};
 
-        auto shaderVertex = Wrapper::Shader::create(mDevice, "shaders/vs.spv", VK_SHADER_STAGE_VERTEX_BIT, "main");
+        // 深度 Pass 没有片段着色器，只输出深度
+        auto shaderVertex = Wrapper::Shader::create(mDevice, depthOnly ? "shaders/depth.spv" : "shaders/vs.spv", VK_SHADER_STAGE_VERTEX_BIT, "main");
         shaderGroup.push_back(shaderVertex);
 
-        auto shaderFragment = Wrapper::Shader::create(mDevice, "shaders/fs.spv", VK_SHADER_STAGE_FRAGMENT_BIT, "main");
-        shaderGroup.push_back(shaderFragment);
+        if (!depthOnly)
+        {
+            auto shaderFragment = Wrapper::Shader::create(mDevice, "shaders/fs.spv", VK_SHADER_STAGE_FRAGMENT_BIT, "main");
+            shaderGroup.push_back(shaderFragment);
+        }
+
+        pipeline->setShaderGroup(shaderGroup);
 
-        mPipeline->setShaderGroup(shaderGroup);
+        auto bindingDescription = mModel->getVertexInputBindingDescriptions(depthOnly);
+        auto attributeDescriptions = mModel->getAttributeDescriptions(depthOnly);
 
-        auto bindingDescription = mModel->getVertexInputBindingDescriptions();
-        auto attributeDescriptions = mModel->getAttributeDescriptions();
+        pipeline->mVertexInputState.vertexBindingDescriptionCount   = bindingDescription.size();
+        pipeline->mVertexInputState.pVertexBindingDescriptions      = bindingDescription.data();
+        pipeline->mVertexInputState.vertexAttributeDescriptionCount = attributeDescriptions.size();
+        pipeline->mVertexInputState.pVertexAttributeDescriptions    = attributeDescriptions.data();
 
-        mPipeline->mVertexInputState.vertexBindingDescriptionCount   = bindingDescription.size();
-        mPipeline->mVertexInputState.pVertexBindingDescriptions      = bindingDescription.data();
-        mPipeline->mVertexInputState.vertexAttributeDescriptionCount = attributeDescriptions.size();
-        mPipeline->mVertexInputState.pVertexAttributeDescriptions    = attributeDescriptions.data();
+        pipeline->mAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        pipeline->mAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        pipeline->mAssemblyState.primitiveRestartEnable = VK_FALSE;
 
-        mPipeline->mAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        mPipeline->mAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        mPipeline->mAssemblyState.primitiveRestartEnable = VK_FALSE;
+        pipeline->mRasterState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        pipeline->mRasterState.polygonMode = VK_POLYGON_MODE_FILL;
+        pipeline->mRasterState.lineWidth = 1.0f;
+        pipeline->mRasterState.cullMode = VK_CULL_MODE_BACK_BIT;
+        pipeline->mRasterState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
 
-        mPipeline->mRasterState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        mPipeline->mRasterState.polygonMode = VK_POLYGON_MODE_FILL;
-        mPipeline->mRasterState.lineWidth = 1.0f;
-        mPipeline->mRasterState.cullMode = VK_CULL_MODE_BACK_BIT;
-        mPipeline->mRasterState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        pipeline->mRasterState.depthBiasEnable         = VK_FALSE;
+        pipeline->mRasterState.depthBiasConstantFactor = 0.0f;
+        pipeline->mRasterState.depthBiasClamp          = 0.0f;
+        pipeline->mRasterState.depthBiasSlopeFactor    = 0.0f;
 
-        mPipeline->mRasterState.depthBiasEnable         = VK_FALSE;
-        mPipeline->mRasterState.depthBiasConstantFactor = 0.0f;
-        mPipeline->mRasterState.depthBiasClamp          = 0.0f;
-        mPipeline->mRasterState.depthBiasSlopeFactor    = 0.0f;
+        pipeline->mSampleState.sampleShadingEnable   = VK_FALSE;
+        pipeline->mSampleState.rasterizationSamples  = VK_SAMPLE_COUNT_1_BIT;
+        pipeline->mSampleState.minSampleShading      = 1.0f;
+        pipeline->mSampleState.pSampleMask           = nullptr;
+        pipeline->mSampleState.alphaToCoverageEnable = VK_FALSE;
+        pipeline->mSampleState.alphaToOneEnable      = VK_FALSE;
 
-        mPipeline->mSampleState.sampleShadingEnable   = VK_FALSE;
-        mPipeline->mSampleState.rasterizationSamples  = VK_SAMPLE_COUNT_1_BIT;
-        mPipeline->mSampleState.minSampleShading      = 1.0f;
-        mPipeline->mSampleState.pSampleMask           = nullptr;
-        mPipeline->mSampleState.alphaToCoverageEnable = VK_FALSE;
-        mPipeline->mSampleState.alphaToOneEnable      = VK_FALSE;
+        // 有深度预渲染时颜色 Pass 不再写深度，只有与预渲染深度相同的（最近的）片段通过
+        const bool colorAfterPrepass = !depthOnly && mDepthPrepass;
 
-        mPipeline->mDepthStencilState.depthTestEnable = VK_FALSE;
-        mPipeline->mDepthStencilState.depthWriteEnable = VK_FALSE;
-        mPipeline->mDepthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
+        pipeline->mDepthStencilState.depthTestEnable  = VK_TRUE;
+        pipeline->mDepthStencilState.depthWriteEnable = colorAfterPrepass ? VK_FALSE : VK_TRUE;
+        pipeline->mDepthStencilState.depthCompareOp   = colorAfterPrepass ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS;
 
         VkPipelineColorBlendAttachmentState blendAttachment{};
-        blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-                                         VK_COLOR_COMPONENT_G_BIT |
-                                         VK_COLOR_COMPONENT_B_BIT |
-                                         VK_COLOR_COMPONENT_A_BIT;
+        blendAttachment.colorWriteMask = depthOnly ? 0 : (VK_COLOR_COMPONENT_R_BIT |
+                                                          VK_COLOR_COMPONENT_G_BIT |
+                                                          VK_COLOR_COMPONENT_B_BIT |
+                                                          VK_COLOR_COMPONENT_A_BIT);
 
         blendAttachment.blendEnable         = VK_FALSE;
         blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
@@ -125,24 +208,24 @@ namespace LearnVulkan
         blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
         blendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
 
-        mPipeline->pushBlendAttachment(blendAttachment);
+        pipeline->pushBlendAttachment(blendAttachment);
 
-        mPipeline->mBlendState.logicOpEnable = VK_FALSE;
-        mPipeline->mBlendState.logicOp = VK_LOGIC_OP_COPY;
+        pipeline->mBlendState.logicOpEnable = VK_FALSE;
+        pipeline->mBlendState.logicOp = VK_LOGIC_OP_COPY;
 
-        mPipeline->mBlendState.blendConstants[0] = 0.0f;
-        mPipeline->mBlendState.blendConstants[1] = 0.0f;
-        mPipeline->mBlendState.blendConstants[2] = 0.0f;
-        mPipeline->mBlendState.blendConstants[3] = 0.0f;
+        pipeline->mBlendState.blendConstants[0] = 0.0f;
+        pipeline->mBlendState.blendConstants[1] = 0.0f;
+        pipeline->mBlendState.blendConstants[2] = 0.0f;
+        pipeline->mBlendState.blendConstants[3] = 0.0f;
 
-        mPipeline->mLayoutState.setLayoutCount = 1;
+        pipeline->mLayoutState.setLayoutCount = 1;
         auto layout = mUniformManager->getDescriptorLayout()->getLayout();
-        mPipeline->mLayoutState.pSetLayouts = &layout;
+        pipeline->mLayoutState.pSetLayouts = &layout;
 
-        mPipeline->mLayoutState.pushConstantRangeCount = 0;
-        mPipeline->mLayoutState.pPushConstantRanges = nullptr;
+        pipeline->mLayoutState.pushConstantRangeCount = 0;
+        pipeline->mLayoutState.pPushConstantRanges = nullptr;
 
-        mPipeline->build();
+        pipeline->build();
     }
 
     void Application::createRenderPass()
@@ -159,7 +242,8 @@ namespace LearnVulkan
 
         mRenderPass->addAttachment(colorAttachment);
 
-        /*VkAttachmentDescription depthAttachment{};
+        // 深度只在本通道内使用，不需要保存
+        VkAttachmentDescription depthAttachment{};
         depthAttachment.format         = Wrapper::Image::findDepthFormat(mDevice);
         depthAttachment.samples        = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
@@ -169,19 +253,19 @@ namespace LearnVulkan
         depthAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
         depthAttachment.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-        mRenderPass->addAttachment(depthAttachment);*/
+        mRenderPass->addAttachment(depthAttachment);
 
         VkAttachmentReference colorAttachmentRef{};
         colorAttachmentRef.attachment = 0;
         colorAttachmentRef.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-        /*VkAttachmentReference depthattachmentRef{};
+        VkAttachmentReference depthattachmentRef{};
         depthattachmentRef.attachment = 1;
-        depthattachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;*/
+        depthattachmentRef.layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
         Wrapper::SubPass subPass{};
         subPass.addColorAttachmentReference(colorAttachmentRef);
-        //subPass.setDepthStencilAttachmentReference(depthattachmentRef);
+        subPass.setDepthStencilAttachmentReference(depthattachmentRef);
         subPass.buildSubPassDescription();
 
         mRenderPass->addSubPass(subPass);
@@ -189,78 +273,165 @@ namespace LearnVulkan
         VkSubpassDependency dependency{};
         dependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
         dependency.dstSubpass    = 0;
-        dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        // 深度图像按交换链图像分配，但清除之前仍要等上一次使用它的帧完成深度测试
+        dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
         mRenderPass->addDependency(dependency);
 
         mRenderPass->buildRenderPass();
     }
 
-    void Application::createCommandBuffers()
+    void Application::recordCommandBuffer(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t imageIndex, uint32_t frameIndex)
     {
-        for (int i = 0; i < mSwapChain->getImageCount(); ++i)
+        // 每帧录制、只提交一次，驱动可以省去为重复提交保留命令的开销
+        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        VkRenderPassBeginInfo renderBeginInfo{};
+        renderBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderBeginInfo.renderPass        = mRenderPass->getRenderPass();
+        renderBeginInfo.framebuffer       = mSwapChain->getFrameBuffer(imageIndex);
+        renderBeginInfo.renderArea.offset = { 0, 0 };
+        renderBeginInfo.renderArea.extent = mSwapChain->getExtent();
+
+        std::vector<VkClearValue> clearColors;
+        VkClearValue clearColor;
+        clearColor.color = { 0.0f, 0.0f, 0.0f, 1.0f };
+        clearColors.push_back(clearColor);
+
+        VkClearValue depthClearColor;
+        depthClearColor.depthStencil = { 1.0f, 0 };
+        clearColors.push_back(depthClearColor);
+
+        renderBeginInfo.clearValueCount = static_cast<uint32_t>(clearColors.size());
+        renderBeginInfo.pClearValues    = clearColors.data();
+
+        // 簇剔除的计算分发必须在渲染通道之外录制
+        if (mClusterCuller)
         {
-            mCommandBuffers[i] = Wrapper::CommandBuffer::create(mDevice, mCommandPool);
+            mClusterCuller->recordCull(commandBuffer, frameIndex);
+        }
 
-            mCommandBuffers[i]->begin();
+        if (!mSecondaryRecorder)
+        {
+            commandBuffer->beginRenderPass(renderBeginInfo);
 
-            VkRenderPassBeginInfo renderBeginInfo{};
-            renderBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-            renderBeginInfo.renderPass        = mRenderPass->getRenderPass();
-            renderBeginInfo.framebuffer       = mSwapChain->getFrameBuffer(i);
-            renderBeginInfo.renderArea.offset = { 0, 0 };
-            renderBeginInfo.renderArea.extent = mSwapChain->getExtent();
+            if (mDepthPrepass)
+            {
+                recordPass(commandBuffer, frameIndex, true, 0, mObjectCount);
+            }
 
-            VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-            renderBeginInfo.clearValueCount = 1;
-            renderBeginInfo.pClearValues = &clearColor;
+            recordPass(commandBuffer, frameIndex, false, 0, mObjectCount);
 
-            /*std::vector<VkClearValue> clearColors;
-            VkClearValue clearColor;
-            clearColor.color = { 0.0f, 0.0f, 0.0f, 1.0f };
-            clearColors.push_back(clearColor);
+            commandBuffer->endRenderPass();
+            commandBuffer->end();
 
-            VkClearValue depthClearColor;
-            depthClearColor.depthStencil = { 1.0f, 0 };
-            clearColors.push_back(depthClearColor);
+            return;
+        }
 
-            renderBeginInfo.clearValueCount = static_cast<uint32_t>(clearColors.size());
-            renderBeginInfo.pClearValues    = clearColors.data();*/
+        // 多线程录制：子通道内容全部来自二级命令缓冲区，主命令缓冲区只负责按顺序执行
+        commandBuffer->beginRenderPass(renderBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-            mCommandBuffers[i]->beginRenderPass(renderBeginInfo);
+        VkCommandBufferInheritanceInfo inheritance{};
+        inheritance.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance.renderPass  = mRenderPass->getRenderPass();
+        inheritance.subpass     = 0;
+        inheritance.framebuffer = mSwapChain->getFrameBuffer(imageIndex);
 
-            mCommandBuffers[i]->bindGraphicPipeline(mPipeline->getPipeline());
+        // 深度预渲染和颜色 Pass 分别切段：所有物体的深度都写完之后颜色 Pass 的 EQUAL 测试才正确
+        std::vector<VkCommandBuffer> secondaries{};
 
-            mCommandBuffers[i]->bindDescriptorSet(mPipeline->getLayout(), mUniformManager->getDescriptorSet(mCurrentFrame));
+        if (mDepthPrepass)
+        {
+            secondaries = mSecondaryRecorder->record(frameIndex, inheritance, mObjectCount,
+                [&](const Wrapper::CommandBuffer::Ptr& secondary, uint32_t begin, uint32_t end)
+                {
+                    recordPass(secondary, frameIndex, true, begin, end);
+                });
+        }
+
+        const auto colorSecondaries = mSecondaryRecorder->record(frameIndex, inheritance, mObjectCount,
+            [&](const Wrapper::CommandBuffer::Ptr& secondary, uint32_t begin, uint32_t end)
+            {
+                recordPass(secondary, frameIndex, false, begin, end);
+            });
+
+        secondaries.insert(secondaries.end(), colorSecondaries.begin(), colorSecondaries.end());
+
+        commandBuffer->executeCommands(secondaries);
+
+        commandBuffer->endRenderPass();
+        commandBuffer->end();
+    }
+
+    void Application::recordPass(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex, bool depthOnly, uint32_t begin, uint32_t end)
+    {
+        // 可能在录制线程上调用，只读取本帧已经更新好的状态
+        commandBuffer->bindGraphicPipeline(depthOnly ? mDepthPipeline->getPipeline() : mPipeline->getPipeline());
+        commandBuffer->bindVertexBuffer(mModel->getVertexBuffers(depthOnly));
+
+        recordObjects(commandBuffer, frameIndex, begin, end);
+    }
 
-            //mCommandBuffers[i]->bindVertexBuffer({ mModel->getVertexBuffer()->getBuffer() });
+    void Application::recordObjects(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex, uint32_t begin, uint32_t end)
+    {
+        // 两个管线的布局相同；所有物体共用一个描述符集，每个物体只换物体常量的动态偏移
+        const auto descriptorSet = mUniformManager->getDescriptorSet(frameIndex);
 
-            mCommandBuffers[i]->bindVertexBuffer(mModel->getVertexBuffers());
+        if (mClusterCuller)
+        {
+            commandBuffer->bindDescriptorSet(mPipeline->getLayout(), descriptorSet, mUniformManager->getDynamicOffsets(frameIndex));
+            mClusterCuller->recordDraw(commandBuffer);
 
-            mCommandBuffers[i]->bindIndexBuffer(mModel->getIndexBuffer()->getBuffer());
+            return;
+        }
 
-            mCommandBuffers[i]->drawIndex(mModel->getIndexCount());
+        // 命令每帧录制，每个物体自己那一级 LOD 的索引区间直接写进绘制命令
+        commandBuffer->bindIndexBuffer(mModel->getIndexBuffer()->getBuffer(), mModel->getIndexType());
 
-            mCommandBuffers[i]->endRenderPass();
+        for (uint32_t object = begin; object < end; ++object)
+        {
+            const auto& lod = mModel->getLod(mObjectLods[object]);
 
-            mCommandBuffers[i]->end();
+            commandBuffer->bindDescriptorSet(mPipeline->getLayout(), descriptorSet, mUniformManager->getDynamicOffsets(frameIndex, object));
+            commandBuffer->drawIndex(lod.mIndexCount, lod.mFirstIndex);
         }
     }
 
-    void Application::createSyncObjects()
+    void Application::updateObjectUniforms()
     {
-        for (int i = 0; i < mSwapChain->getImageCount(); ++i)
+        const ObjectUniform base = mModel->getUniform();
+
+        mObjectUniforms.resize(mObjectPositions.size());
+        mObjectLods.resize(mObjectPositions.size());
+
+        for (size_t i = 0; i < mObjectPositions.size(); ++i)
         {
-            auto imageSemaphore = Wrapper::Semaphore::create(mDevice);
-            mImageAvailableSemaphores.push_back(imageSemaphore);
+            mObjectUniforms[i]              = base;
+            mObjectUniforms[i].mModelMatrix = glm::translate(glm::mat4(1.0f), mObjectPositions[i]) * base.mModelMatrix;
+
+            // 远处的副本投影误差小，各自选择误差不超过阈值的最粗一级
+            mObjectLods[i] = mModel->selectLod(mModel->getVPUniform(), mObjectUniforms[i].mModelMatrix, mHeight);
+        }
+    }
 
-            auto renderSemaphore = Wrapper::Semaphore::create(mDevice);
-            mRenderFinishedSemaphores.push_back(renderSemaphore);
+    void Application::createSyncObjects()
+    {
+        // 帧上下文与交换链无关，只创建一次
+        if (mFrames.empty())
+        {
+            for (uint32_t i = 0; i < mFramesInFlight; ++i)
+            {
+                mFrames.push_back(FrameContext::create(mDevice, i));
+            }
+        }
 
-            auto fence = Wrapper::Fence::create(mDevice);
-            mFences.push_back(fence);
+        // 渲染完成信号量由呈现等待，按交换链图像分配：图像再次被获取时，上一次呈现一定已经用完了它
+        for (uint32_t i = 0; i < mSwapChain->getImageCount(); ++i)
+        {
+            mRenderFinishedSemaphores.push_back(Wrapper::Semaphore::create(mDevice));
         }
     }
 
@@ -292,21 +463,17 @@ namespace LearnVulkan
         mPipeline = Wrapper::Pipeline::create(mDevice, mRenderPass);
         createPipeline();
 
-        mCommandBuffers.resize(mSwapChain->getImageCount());
-        createCommandBuffers();
-
         createSyncObjects();
     }
 
     void Application::cleanupSwapChain()
     {
+        // 帧上下文（命令池、命令缓冲区、获取信号量、栅栏）与交换链无关，保留；命令每帧按取得的图像重新录制
         mSwapChain.reset();
-        mCommandBuffers.clear();
         mPipeline.reset();
+        mDepthPipeline.reset();
         mRenderPass.reset();
-        mImageAvailableSemaphores.clear();
         mRenderFinishedSemaphores.clear();
-        mFences.clear();
     }
 
     void Application::mainLoop()
@@ -315,9 +482,32 @@ namespace LearnVulkan
         {
             mWindow->pollEvents();
 
+            // 先等这个帧上下文上一次的 GPU 工作完成，再改写它的常量和间接参数；
+            // 其余帧上下文的工作不受影响，CPU 准备这一帧时 GPU 仍可执行上一帧
+            const auto& frame = mFrames[mCurrentFrame];
+            frame->wait();
+
+            // 上传完成后回收暂存空间
+            mUploadContext->poll();
+
             mModel->update(mWidth, mHeight);
 
-            mUniformManager->update(mModel->getVPUniform(), mModel->getUniform(), mCurrentFrame);
+            if (mTextureStreamer)
+            {
+                mUniformManager->setTextureScreenSize(mModel->getProjectedSize(mModel->getVPUniform(), mHeight));
+                mTextureStreamer->update(mUploadContext);
+
+                // 本帧的栅栏已等待过，只改写本帧的描述符集；其他帧仍可在 GPU 上执行。命令缓冲区在 render 中重新录制
+                mTextureStreamer->applySwaps(frame->getIndex());
+            }
+
+            updateObjectUniforms();
+            mUniformManager->update(mModel->getVPUniform(), mObjectUniforms, frame->getIndex());
+
+            if (mClusterCuller)
+            {
+                mClusterCuller->update(mModel->getVPUniform(), mModel->getUniform(), frame->getIndex());
+            }
 
             render();
         }
@@ -329,46 +519,59 @@ namespace LearnVulkan
     {
         #pragma region Draw
 
-        mFences[mCurrentFrame]->block();
+        // 本帧上下文的栅栏已在 mainLoop 开头等待过
+        const auto& frame = mFrames[mCurrentFrame];
 
         uint32_t imageIndex{ 0 };
         VkResult result = vkAcquireNextImageKHR(mDevice->getDevice(),
                                                 mSwapChain->getSwapChain(),
                                                 UINT64_MAX,
-                                                mImageAvailableSemaphores[mCurrentFrame]->getSemaphore(),
+                                                frame->getImageAvailableSemaphore()->getSemaphore(),
                                                 VK_NULL_HANDLE,
                                                 &imageIndex);
 
+        // 没有取得图像时信号量不会触发，也不能提交；栅栏尚未重置，下一次循环不会阻塞
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
             recreateSwapChain();
             mWindow->mWindowResized = false;
+            return;
         }
         else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
         {
             throw std::runtime_error("Error: failed to acquire next image!");
         }
 
+        // 帧缓冲取决于刚取得的图像，所以在获取之后录制；栅栏已等待过，整池重置后重新录制
+        frame->resetCommands();
+
+        if (mSecondaryRecorder)
+        {
+            mSecondaryRecorder->beginFrame(frame->getIndex());
+        }
+
+        recordCommandBuffer(frame->getCommandBuffer(), imageIndex, frame->getIndex());
+
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-        VkSemaphore waitSemaphores[]      = { mImageAvailableSemaphores[mCurrentFrame]->getSemaphore() };
+        VkSemaphore waitSemaphores[]      = { frame->getImageAvailableSemaphore()->getSemaphore() };
         VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
         submitInfo.waitSemaphoreCount     = 1;
         submitInfo.pWaitSemaphores        = waitSemaphores;
         submitInfo.pWaitDstStageMask      = waitStages;
 
-        auto commandBuffer            = mCommandBuffers[imageIndex]->getCommandBuffer();
+        auto commandBuffer            = frame->getCommandBuffer()->getCommandBuffer();
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers    = &commandBuffer;
 
-        VkSemaphore signalSemaphores[]  = { mRenderFinishedSemaphores[mCurrentFrame]->getSemaphore() };
+        VkSemaphore signalSemaphores[]  = { mRenderFinishedSemaphores[imageIndex]->getSemaphore() };
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores    = signalSemaphores;
 
-        mFences[mCurrentFrame]->resetFence();
+        frame->getFence()->resetFence();
 
-        if (vkQueueSubmit(mDevice->getGraphicQueue(), 1, &submitInfo, mFences[mCurrentFrame]->getFence()) != VK_SUCCESS)
+        if (vkQueueSubmit(mDevice->getGraphicQueue(), 1, &submitInfo, frame->getFence()->getFence()) != VK_SUCCESS)
         {
             throw std::runtime_error("Error: failed to submit renderCommand!");
         }
@@ -401,12 +604,23 @@ namespace LearnVulkan
 
         #pragma endregion
 
-        mCurrentFrame = (mCurrentFrame + 1) % mSwapChain->getImageCount();
+        if (!mFirstFramePresented)
+        {
+            mFirstFramePresented = true;
+
+            std::cout << "Time to first frame: "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStartTime).count() << " ms" << std::endl;
+        }
+
+        mCurrentFrame = (mCurrentFrame + 1) % static_cast<int>(mFrames.size());
     }
 
     void Application::cleanUp()
     {
+        mSecondaryRecorder.reset();
+        mFrames.clear();
         mPipeline.reset();
+        mDepthPipeline.reset();
         mRenderPass.reset();
         mSwapChain.reset();
         mDevice.reset();
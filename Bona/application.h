@@ -14,6 +14,7 @@
 #include "vulkanWrapper/semaphore.h"
 #include "vulkanWrapper/fence.h"
 #include "vulkanWrapper/buffer.h"
+#include "vulkanWrapper/uploadContext.h"
 #include "vulkanWrapper/descriptorSetLayout.h"
 #include "vulkanWrapper/descriptorPool.h"
 #include "vulkanWrapper/descriptorSet.h"
@@ -22,8 +23,13 @@
 #include "vulkanWrapper/image.h"
 #include "vulkanWrapper/sampler.h"
 #include "texture/texture.h"
+#include "texture/textureStreamer.h"
 
 #include "model.h"
+#include "assetCache.h"
+#include "clusterCuller.h"
+#include "frameContext.h"
+#include "secondaryRecorder.h"
 
 namespace LearnVulkan
 {
@@ -35,12 +41,34 @@ namespace LearnVulkan
 
         void run();
 
+        // 贴图解码线程数：0 为按硬件线程数并行，1 为串行（用于对比启动耗时）
+        void setTextureDecodeThreads(uint32_t threadCount) { mTextureDecodeThreads = threadCount; }
+
+        // 流送贴图的显存预算（字节），为 0 时不流送，贴图整条 mip 链一次上传
+        void setTextureBudget(VkDeviceSize budget) { mTextureBudget = budget; }
+
+        // 深度预渲染：先只用位置流写深度，颜色 Pass 以 EQUAL 测试，片段着色次数与像素数而不是重叠的三角形数相关
+        void setDepthPrepass(bool enable) { mDepthPrepass = enable; }
+
+        // 在途帧数（至少 1），与交换链图像数无关；需在 run 之前设置
+        void setFramesInFlight(uint32_t frameCount) { mFramesInFlight = std::max(1u, frameCount); }
+
+        // 绘制的物体数（至少 1）：模型的多个副本排成网格，每个副本一次绘制、一份物体常量；多于 1 个时不做簇剔除
+        void setObjectCount(uint32_t objectCount) { mObjectCount = std::max(1u, objectCount); }
+
+        // 录制渲染通道内绘制的线程数：0 为按硬件线程数，1 为在主线程内联录制；物体数不够切成两段时总是内联录制
+        void setRecordThreads(uint32_t threadCount) { mRecordThreads = threadCount; }
+
     private:
         void initWindow();
         void initVulkan();
         void createPipeline();
+        void setupPipeline(const Wrapper::Pipeline::Ptr& pipeline, bool depthOnly);
         void createRenderPass();
-        void createCommandBuffers();
+        void recordCommandBuffer(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t imageIndex, uint32_t frameIndex);
+        void recordPass(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex, bool depthOnly, uint32_t begin, uint32_t end);
+        void recordObjects(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t frameIndex, uint32_t begin, uint32_t end);
+        void updateObjectUniforms();
         void createSyncObjects();
         void mainLoop();
         void render();
@@ -52,6 +80,15 @@ namespace LearnVulkan
         unsigned int mWidth{ 1280 };
         unsigned int mHeight{ 720 };
 
+        uint32_t                              mTextureDecodeThreads{ 0 };
+        VkDeviceSize                          mTextureBudget{ 256ull * 1024 * 1024 };
+        bool                                  mDepthPrepass{ false };
+        uint32_t                              mFramesInFlight{ 2 };
+        uint32_t                              mObjectCount{ 1 };
+        uint32_t                              mRecordThreads{ 0 };
+        std::chrono::steady_clock::time_point mStartTime{};               // run() 开始的时刻，用于统计首帧耗时
+        bool                                  mFirstFramePresented{ false };
+
     private:
         int                         mCurrentFrame{ 0 };
         Wrapper::Window::Ptr        mWindow{ nullptr };
@@ -60,17 +97,29 @@ namespace LearnVulkan
         Wrapper::WindowSurface::Ptr mSurface{ nullptr };
         Wrapper::SwapChain::Ptr     mSwapChain{ nullptr };
         Wrapper::Pipeline::Ptr      mPipeline{ nullptr };
+        Wrapper::Pipeline::Ptr      mDepthPipeline{ nullptr };   // 深度预渲染，只在 mDepthPrepass 时创建
         Wrapper::RenderPass::Ptr    mRenderPass{ nullptr };
 
-        Wrapper::CommandPool::Ptr                mCommandPool{ nullptr };
-        std::vector<Wrapper::CommandBuffer::Ptr> mCommandBuffers{};
+        Wrapper::CommandPool::Ptr mCommandPool{ nullptr };
+
+        std::vector<FrameContext::Ptr>       mFrames{};                     // 按 mCurrentFrame 环形使用
+        std::vector<Wrapper::Semaphore::Ptr> mRenderFinishedSemaphores{};   // 每个交换链图像一个
+
+        Wrapper::UploadContext::Ptr mUploadContext{ nullptr };   // 资源上传的暂存环形缓冲区和批量提交
 
-        std::vector<Wrapper::Semaphore::Ptr> mImageAvailableSemaphores{};
-        std::vector<Wrapper::Semaphore::Ptr> mRenderFinishedSemaphores{};
-        std::vector<Wrapper::Fence::Ptr>     mFences{};
+        AssetCache::Ptr      mAssetCache{ nullptr };       // 按路径 / 内容去重的模型和纹理
+        TextureStreamer::Ptr mTextureStreamer{ nullptr };
 
         UniformManager::Ptr mUniformManager{ nullptr };
         Model::Ptr          mModel{ nullptr };
+        ClusterCuller::Ptr  mClusterCuller{ nullptr };
+
+        std::vector<glm::vec3>     mObjectPositions{};   // 每个物体相对模型原点的平移
+        std::vector<ObjectUniform> mObjectUniforms{};
+        std::vector<uint32_t>      mObjectLods{};        // 每个物体按自己的投影误差选择的 LOD，录制前每帧更新
+
+        SecondaryRecorder::Ptr mSecondaryRecorder{ nullptr };   // 多线程录制二级命令缓冲区，内联录制时为空
+
         VPMatrices          mVPMatrices;
     };
 }
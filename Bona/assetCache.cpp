@@ -0,0 +1,328 @@
+﻿#include "assetCache.h"
+#include "mappedFile.h"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        std::string textureOptions(const Texture::Source& source)
+        {
+            return "|t" + std::to_string(static_cast<uint32_t>(source.mMipmapMode)) +
+                   "|" + std::to_string(static_cast<uint32_t>(source.mBlockFormat));
+        }
+
+        std::string modelOptions(const AssetCache::ModelOptions& options)
+        {
+            return "|m" + std::to_string(options.mOptimizeMesh ? 1 : 0) +
+                   "|" + std::to_string(static_cast<uint32_t>(options.mVertexQuantization)) +
+                   "|" + std::to_string(static_cast<uint32_t>(options.mStreamLayout)) +
+                   "|" + std::to_string(options.mBuildMeshlets ? 1 : 0) +
+                   "|" + std::to_string(options.mGenerateLods ? 1 : 0);
+        }
+    }
+
+    AssetCache::AssetCache(const Wrapper::Device::Ptr& device)
+    {
+        mDevice = device;
+    }
+
+    AssetCache::~AssetCache()
+    {
+    }
+
+    std::string AssetCache::canonicalPath(const std::string& path)
+    {
+        std::error_code error;
+        const auto canonical = std::filesystem::weakly_canonical(std::filesystem::path(path), error);
+
+        return error ? path : canonical.generic_string();
+    }
+
+    std::string AssetCache::contentKey(const std::string& path, const std::string& options)
+    {
+        auto file = MappedFile::open(path);
+
+        if (!file)
+        {
+            return {};
+        }
+
+        return std::to_string(hashBytes(file->getData(), file->getSize())) + ":" + std::to_string(file->getSize()) + options;
+    }
+
+    template<typename T>
+    std::shared_ptr<T> AssetCache::findByPath(Table<T>& table, const std::string& pathKey)
+    {
+        auto it = table.mByPath.find(pathKey);
+
+        if (it == table.mByPath.end())
+        {
+            return nullptr;
+        }
+
+        ++mPathHits;
+        return it->second->mAsset;
+    }
+
+    template<typename T>
+    std::shared_ptr<T> AssetCache::findByContent(Table<T>& table, const std::string& pathKey, const std::string& contentKey)
+    {
+        if (contentKey.empty())
+        {
+            return nullptr;
+        }
+
+        auto it = table.mByContent.find(contentKey);
+
+        if (it == table.mByContent.end())
+        {
+            return nullptr;
+        }
+
+        // 记下新名字，之后按路径直接命中
+        it->second->mPathKeys.push_back(pathKey);
+        table.mByPath[pathKey] = it->second;
+
+        ++mContentHits;
+        return it->second->mAsset;
+    }
+
+    template<typename T>
+    void AssetCache::insert(Table<T>& table, const std::shared_ptr<T>& asset, const std::string& pathKey, const std::string& contentKey)
+    {
+        auto entry = std::make_shared<Entry<T>>();
+        entry->mAsset      = asset;
+        entry->mPathKeys   = { pathKey };
+        entry->mContentKey = contentKey;
+
+        table.mByPath[pathKey] = entry;
+
+        if (!contentKey.empty())
+        {
+            table.mByContent[contentKey] = entry;
+        }
+
+        table.mEntries.push_back(entry);
+    }
+
+    template<typename T>
+    uint32_t AssetCache::evict(Table<T>& table)
+    {
+        uint32_t evicted = 0;
+
+        for (auto it = table.mEntries.begin(); it != table.mEntries.end();)
+        {
+            auto& entry = *it;
+
+            if (entry->mAsset.use_count() > 1)
+            {
+                ++it;
+                continue;
+            }
+
+            for (const auto& pathKey : entry->mPathKeys)
+            {
+                table.mByPath.erase(pathKey);
+            }
+
+            if (!entry->mContentKey.empty())
+            {
+                table.mByContent.erase(entry->mContentKey);
+            }
+
+            it = table.mEntries.erase(it);
+            ++evicted;
+        }
+
+        return evicted;
+    }
+
+    template<typename T, typename Load>
+    std::vector<std::shared_ptr<T>> AssetCache::getBatch(Table<T>& table, const std::vector<Texture::Source>& sources, Load&& load)
+    {
+        std::vector<std::shared_ptr<T>> textures(sources.size());
+
+        // 步骤1：按路径、再按内容查找；批内重复的内容只解码一次
+        std::vector<Texture::Source> loadSources{};
+        std::vector<std::string>     loadPathKeys{};
+        std::vector<std::string>     loadContentKeys{};
+        std::vector<size_t>          loadSlots(sources.size(), SIZE_MAX);   // 每个未命中的 source 对应 loadSources 的下标
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            const std::string options = textureOptions(sources[i]);
+            const std::string pathKey = canonicalPath(sources[i].mPath) + options;
+
+            if ((textures[i] = findByPath(table, pathKey)) != nullptr)
+            {
+                continue;
+            }
+
+            const std::string content = contentKey(sources[i].mPath, options);
+
+            if ((textures[i] = findByContent(table, pathKey, content)) != nullptr)
+            {
+                continue;
+            }
+
+            for (size_t j = 0; j < loadSources.size(); ++j)
+            {
+                if (loadPathKeys[j] == pathKey || (!content.empty() && loadContentKeys[j] == content))
+                {
+                    loadSlots[i] = j;
+                    break;
+                }
+            }
+
+            if (loadSlots[i] == SIZE_MAX)
+            {
+                loadSlots[i] = loadSources.size();
+                loadSources.push_back(sources[i]);
+                loadPathKeys.push_back(pathKey);
+                loadContentKeys.push_back(content);
+            }
+        }
+
+        if (loadSources.empty())
+        {
+            return textures;
+        }
+
+        // 步骤2：并行解码未命中的纹理，依次创建并登记
+        const auto loaded = load(loadSources);
+
+        mLoadCount += static_cast<uint32_t>(loaded.size());
+
+        for (size_t j = 0; j < loaded.size(); ++j)
+        {
+            insert(table, loaded[j], loadPathKeys[j], loadContentKeys[j]);
+        }
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            if (loadSlots[i] == SIZE_MAX)
+            {
+                continue;
+            }
+
+            textures[i] = loaded[loadSlots[i]];
+
+            // 批内名字不同、内容相同的纹理也登记自己的路径
+            const std::string pathKey = canonicalPath(sources[i].mPath) + textureOptions(sources[i]);
+
+            if (table.mByPath.find(pathKey) == table.mByPath.end())
+            {
+                auto entry = table.mByPath[loadPathKeys[loadSlots[i]]];
+                entry->mPathKeys.push_back(pathKey);
+                table.mByPath[pathKey] = entry;
+
+                ++mContentHits;
+            }
+        }
+
+        return textures;
+    }
+
+    std::vector<Texture::Ptr> AssetCache::getTextures(const std::vector<Texture::Source>& sources,
+                                                      const Wrapper::UploadContext::Ptr& uploadContext,
+                                                      uint32_t threadCount)
+    {
+        return getBatch(mTextures, sources, [&](const std::vector<Texture::Source>& loadSources)
+        {
+            return Texture::createTextures(mDevice, loadSources, uploadContext, threadCount);
+        });
+    }
+
+    std::vector<TextureStreamer::StreamedTexture::Ptr> AssetCache::getStreamedTextures(const std::vector<Texture::Source>& sources,
+                                                                                      const TextureStreamer::Ptr& streamer,
+                                                                                      const Wrapper::UploadContext::Ptr& uploadContext,
+                                                                                      uint32_t threadCount)
+    {
+        return getBatch(mStreamedTextures, sources, [&](const std::vector<Texture::Source>& loadSources)
+        {
+            return streamer->addTextures(loadSources, uploadContext, threadCount);
+        });
+    }
+
+    Texture::Ptr AssetCache::getTexture(const Texture::Source& source, const Wrapper::UploadContext::Ptr& uploadContext)
+    {
+        return getTextures({ source }, uploadContext, 1).front();
+    }
+
+    Model::Ptr AssetCache::getModel(const std::string& path,
+                                    const ModelOptions& options,
+                                    const Wrapper::UploadContext::Ptr& uploadContext)
+    {
+        const std::string optionKey = modelOptions(options);
+        const std::string pathKey   = canonicalPath(path) + optionKey;
+
+        if (auto model = findByPath(mModels, pathKey))
+        {
+            return model;
+        }
+
+        const std::string content = contentKey(path, optionKey);
+
+        if (auto model = findByContent(mModels, pathKey, content))
+        {
+            return model;
+        }
+
+        auto model = Model::create(mDevice);
+        model->setOptimizeMesh(options.mOptimizeMesh);
+        model->setVertexQuantization(options.mVertexQuantization);
+        model->setStreamLayout(options.mStreamLayout);
+        model->setBuildMeshlets(options.mBuildMeshlets);
+        model->setGenerateLods(options.mGenerateLods);
+        model->loadModel(path, mDevice, uploadContext);
+
+        ++mLoadCount;
+        insert(mModels, model, pathKey, content);
+
+        return model;
+    }
+
+    uint32_t AssetCache::evictUnused()
+    {
+        return evict(mTextures) + evict(mStreamedTextures) + evict(mModels);
+    }
+
+    AssetCache::Stats AssetCache::getStats() const
+    {
+        Stats stats{};
+        stats.mTextureCount = static_cast<uint32_t>(mTextures.mEntries.size() + mStreamedTextures.mEntries.size());
+        stats.mModelCount   = static_cast<uint32_t>(mModels.mEntries.size());
+        stats.mLoadCount    = mLoadCount;
+        stats.mPathHits     = mPathHits;
+        stats.mContentHits  = mContentHits;
+
+        for (const auto& entry : mTextures.mEntries)
+        {
+            stats.mUnusedCount += entry->mAsset.use_count() == 1 ? 1 : 0;
+        }
+
+        for (const auto& entry : mStreamedTextures.mEntries)
+        {
+            stats.mUnusedCount += entry->mAsset.use_count() == 1 ? 1 : 0;
+        }
+
+        for (const auto& entry : mModels.mEntries)
+        {
+            stats.mUnusedCount += entry->mAsset.use_count() == 1 ? 1 : 0;
+        }
+
+        return stats;
+    }
+
+    void AssetCache::printStats() const
+    {
+        const auto stats = getStats();
+
+        std::cout << "Assets: " << stats.mTextureCount << " textures, " << stats.mModelCount << " models ("
+                  << stats.mLoadCount << " loads, " << stats.mPathHits << " path hits, "
+                  << stats.mContentHits << " content hits, " << stats.mUnusedCount << " unused)" << std::endl;
+    }
+}
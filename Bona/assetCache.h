@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "vulkanWrapper/device.h"
+#include "vulkanWrapper/uploadContext.h"
+#include "texture/texture.h"
+#include "texture/textureStreamer.h"
+#include "model.h"
+
+#include <unordered_map>
+
+namespace LearnVulkan
+{
+    // 资源缓存：按规范化路径 + 加载选项去重，同一个文件只加载、上传一次，返回共享的句柄。
+    //   - 路径未命中时再按文件内容哈希（+ 大小 + 选项）查找，内容相同、名字不同的文件共用同一份解码结果
+    //   - 句柄的引用计数即为使用者数量；evictUnused 释放只剩缓存自身引用的资源
+    //   - 流送纹理另存一张表，同一文件只创建一个流送句柄；它同时由 TextureStreamer 持有，不会被 evictUnused 释放
+    // 返回的 Model 是共享的网格，模型矩阵等逐物体状态由使用方自行维护；只在主线程使用
+    class AssetCache
+    {
+    public:
+        using Ptr = std::shared_ptr<AssetCache>;
+
+        // 与 Model 的 set* 导入选项一一对应，不同选项视为不同的资源
+        struct ModelOptions
+        {
+            bool                      mOptimizeMesh{ false };
+            Model::VertexQuantization mVertexQuantization{ Model::VertexQuantization::None };
+            Model::StreamLayout       mStreamLayout{ Model::StreamLayout::Split };
+            bool                      mBuildMeshlets{ false };
+            bool                      mGenerateLods{ false };
+        };
+
+        struct Stats
+        {
+            uint32_t mTextureCount{ 0 };
+            uint32_t mModelCount{ 0 };
+            uint32_t mUnusedCount{ 0 };    // 只剩缓存自身引用的资源
+            uint32_t mLoadCount{ 0 };      // 实际加载的次数
+            uint32_t mPathHits{ 0 };
+            uint32_t mContentHits{ 0 };    // 路径不同、内容相同
+        };
+
+        static Ptr create(const Wrapper::Device::Ptr& device)
+        {
+            return std::make_shared<AssetCache>(device);
+        }
+
+        AssetCache(const Wrapper::Device::Ptr& device);
+
+        ~AssetCache();
+
+        /// 批量取得纹理，结果与 sources 一一对应；未命中的纹理并行解码（threadCount 同 Texture::createTextures），
+        /// 上传记录在 uploadContext 中，为空时单独提交并等待完成
+        std::vector<Texture::Ptr> getTextures(const std::vector<Texture::Source>& sources,
+                                              const Wrapper::UploadContext::Ptr& uploadContext = nullptr,
+                                              uint32_t threadCount = 0);
+
+        Texture::Ptr getTexture(const Texture::Source& source, const Wrapper::UploadContext::Ptr& uploadContext = nullptr);
+
+        /// 同 getTextures，但返回流送纹理句柄：未命中的纹理由 streamer->addTextures 创建，上传记录在 uploadContext 中
+        std::vector<TextureStreamer::StreamedTexture::Ptr> getStreamedTextures(const std::vector<Texture::Source>& sources,
+                                                                               const TextureStreamer::Ptr& streamer,
+                                                                               const Wrapper::UploadContext::Ptr& uploadContext,
+                                                                               uint32_t threadCount = 0);
+
+        Model::Ptr getModel(const std::string& path,
+                            const ModelOptions& options,
+                            const Wrapper::UploadContext::Ptr& uploadContext = nullptr);
+
+        /// 释放没有使用者的资源，返回释放的数量；调用前使用这些资源的帧应已完成
+        uint32_t evictUnused();
+
+        [[nodiscard]] Stats getStats() const;
+
+        void printStats() const;
+
+    private:
+        // 一份资源可以有多个路径键（不同名字、同一内容），但只有一个内容键
+        template<typename T>
+        struct Entry
+        {
+            std::shared_ptr<T>       mAsset{ nullptr };
+            std::vector<std::string> mPathKeys{};
+            std::string              mContentKey{};
+        };
+
+        template<typename T>
+        struct Table
+        {
+            std::unordered_map<std::string, std::shared_ptr<Entry<T>>> mByPath{};
+            std::unordered_map<std::string, std::shared_ptr<Entry<T>>> mByContent{};
+            std::vector<std::shared_ptr<Entry<T>>>                     mEntries{};
+        };
+
+        /// 规范化路径，文件不存在时返回原路径
+        static std::string canonicalPath(const std::string& path);
+
+        /// 内容键：文件内容哈希 + 大小 + 选项，文件不可读时返回空串
+        static std::string contentKey(const std::string& path, const std::string& options);
+
+        template<typename T>
+        std::shared_ptr<T> findByPath(Table<T>& table, const std::string& pathKey);
+
+        template<typename T>
+        std::shared_ptr<T> findByContent(Table<T>& table, const std::string& pathKey, const std::string& contentKey);
+
+        template<typename T>
+        void insert(Table<T>& table, const std::shared_ptr<T>& asset, const std::string& pathKey, const std::string& contentKey);
+
+        template<typename T>
+        uint32_t evict(Table<T>& table);
+
+        /// 纹理的批量查找：命中的直接返回，未命中的（批内按路径 / 内容去重）交给 load 一次创建并登记
+        template<typename T, typename Load>
+        std::vector<std::shared_ptr<T>> getBatch(Table<T>& table, const std::vector<Texture::Source>& sources, Load&& load);
+
+    private:
+        Wrapper::Device::Ptr mDevice{ nullptr };
+
+        Table<Texture>                          mTextures{};
+        Table<TextureStreamer::StreamedTexture> mStreamedTextures{};
+        Table<Model>                            mModels{};
+
+        uint32_t mLoadCount{ 0 };
+        uint32_t mPathHits{ 0 };
+        uint32_t mContentHits{ 0 };
+    };
+}
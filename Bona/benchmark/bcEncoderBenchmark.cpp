@@ -0,0 +1,280 @@
+﻿// BC 块压缩编码器：吞吐量和质量
+//
+// 用法：bcEncoderBenchmark [--threads <N>] [--iterations <N>] [image ...]
+// 不指定文件时使用 assets 下 diablo3_pose 的漫反射 / 法线 / 高光贴图。对每张图的第 0 级分别编码为 BC1 / BC3 / BC4 / BC5 / BC7，
+// 报告最佳编码耗时（MPixel/s）、压缩比，以及解码回 RGBA8 后在该格式保留的通道上的 PSNR。
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../stb_image.h"
+#include "../texture/blockCompressor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using LearnVulkan::BlockFormat;
+
+    struct FormatCase
+    {
+        const char* mName{ nullptr };
+        BlockFormat mFormat{ BlockFormat::None };
+        int         mChannels[4]{};   // 参与 PSNR 的通道，-1 结束
+    };
+
+    void decodeColorBlock(const uint8_t* in, uint8_t* out)
+    {
+        const uint16_t c0 = uint16_t(in[0] | (in[1] << 8));
+        const uint16_t c1 = uint16_t(in[2] | (in[3] << 8));
+
+        int palette[4][3];
+        for (int e = 0; e < 2; ++e)
+        {
+            const uint16_t c = e == 0 ? c0 : c1;
+            const int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+
+            palette[e][0] = (r << 3) | (r >> 2);
+            palette[e][1] = (g << 2) | (g >> 4);
+            palette[e][2] = (b << 3) | (b >> 2);
+        }
+
+        for (int ch = 0; ch < 3; ++ch)
+        {
+            if (c0 > c1)
+            {
+                palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+                palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+            }
+            else
+            {
+                palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+                palette[3][ch] = 0;
+            }
+        }
+
+        uint32_t bits;
+        memcpy(&bits, in + 4, sizeof(bits));
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const int index = (bits >> (i * 2)) & 3;
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                out[i * 4 + ch] = static_cast<uint8_t>(palette[index][ch]);
+            }
+        }
+    }
+
+    void decodeChannelBlock(const uint8_t* in, int channel, uint8_t* out)
+    {
+        int values[8];
+        values[0] = in[0];
+        values[1] = in[1];
+
+        for (int i = 2; i < 8; ++i)
+        {
+            values[i] = values[0] > values[1] ? ((8 - i) * values[0] + (i - 1) * values[1]) / 7
+                                              : (i < 6 ? ((6 - i) * values[0] + (i - 1) * values[1]) / 5 : (i == 6 ? 0 : 255));
+        }
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 6; ++i)
+        {
+            bits |= uint64_t(in[2 + i]) << (i * 8);
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            out[i * 4 + channel] = static_cast<uint8_t>(values[(bits >> (i * 3)) & 7]);
+        }
+    }
+
+    // 只解码模式 6（编码器只输出这一种模式）
+    void decodeBC7Block(const uint8_t* in, uint8_t* out)
+    {
+        uint32_t position = 0;
+        auto get = [&](uint32_t bits)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < bits; ++i, ++position)
+            {
+                value |= uint32_t((in[position >> 3] >> (position & 7)) & 1) << i;
+            }
+            return value;
+        };
+
+        if (get(7) != (1u << 6))
+        {
+            memset(out, 0, 64);
+            return;
+        }
+
+        int endpoints[2][4];
+        for (int c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = static_cast<int>(get(7));
+            endpoints[1][c] = static_cast<int>(get(7));
+        }
+
+        const int p0 = static_cast<int>(get(1));
+        const int p1 = static_cast<int>(get(1));
+
+        for (int c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = (endpoints[0][c] << 1) | p0;
+            endpoints[1][c] = (endpoints[1][c] << 1) | p1;
+        }
+
+        static constexpr int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const int w = weights[get(i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; ++c)
+            {
+                out[i * 4 + c] = static_cast<uint8_t>(((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6);
+            }
+        }
+    }
+
+    void decodeBlock(const uint8_t* in, BlockFormat format, uint8_t* out)
+    {
+        memset(out, 0, 64);
+
+        switch (format)
+        {
+        case BlockFormat::BC1: decodeColorBlock(in, out); break;
+        case BlockFormat::BC3: decodeChannelBlock(in, 3, out); decodeColorBlock(in + 8, out); break;
+        case BlockFormat::BC4: decodeChannelBlock(in, 0, out); break;
+        case BlockFormat::BC5: decodeChannelBlock(in, 0, out); decodeChannelBlock(in + 8, 1, out); break;
+        case BlockFormat::BC7: decodeBC7Block(in, out); break;
+        default: break;
+        }
+    }
+
+    double computePsnr(const uint8_t* rgba, uint32_t width, uint32_t height, const uint8_t* compressed, const FormatCase& format)
+    {
+        const uint32_t blockBytes = LearnVulkan::BlockCompressor::getBlockBytes(format.mFormat);
+        const uint32_t blocksX    = (width + 3) / 4;
+
+        double   squaredError = 0.0;
+        uint64_t samples      = 0;
+        uint8_t  decoded[64];
+
+        for (uint32_t by = 0; by < (height + 3) / 4; ++by)
+        {
+            for (uint32_t bx = 0; bx < blocksX; ++bx)
+            {
+                decodeBlock(compressed + (size_t(by) * blocksX + bx) * blockBytes, format.mFormat, decoded);
+
+                for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+                {
+                    for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                    {
+                        const uint8_t* source = rgba + (size_t(by * 4 + y) * width + bx * 4 + x) * 4;
+
+                        for (int c = 0; c < 4 && format.mChannels[c] >= 0; ++c)
+                        {
+                            const int channel = format.mChannels[c];
+                            const double diff = double(source[channel]) - double(decoded[(y * 4 + x) * 4 + channel]);
+
+                            squaredError += diff * diff;
+                            ++samples;
+                        }
+                    }
+                }
+            }
+        }
+
+        const double mse = squaredError / std::max<uint64_t>(samples, 1);
+        return mse <= 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t threads    = 0;
+    int      iterations = 5;
+    std::vector<std::string> paths{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--threads" && i + 1 < argc)
+        {
+            threads = static_cast<uint32_t>(std::max(0, std::stoi(argv[++i])));
+        }
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            iterations = std::max(1, std::stoi(argv[++i]));
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.empty())
+    {
+        paths.push_back("assets/models/diablo3_pose/diablo3_pose_diffuse.tga");
+        paths.push_back("assets/models/diablo3_pose/diablo3_pose_nm_tangent.tga");
+        paths.push_back("assets/models/diablo3_pose/diablo3_pose_spec.tga");
+    }
+
+    const FormatCase formats[] =
+    {
+        { "BC1", BlockFormat::BC1, { 0, 1, 2, -1 } },
+        { "BC3", BlockFormat::BC3, { 0, 1, 2, 3 } },
+        { "BC4", BlockFormat::BC4, { 0, -1 } },
+        { "BC5", BlockFormat::BC5, { 0, 1, -1 } },
+        { "BC7", BlockFormat::BC7, { 0, 1, 2, 3 } },
+    };
+
+    for (const auto& path : paths)
+    {
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+        if (!pixels)
+        {
+            std::cout << "cannot load " << path << std::endl;
+            continue;
+        }
+
+        const std::vector<LearnVulkan::Wrapper::MipLevel> levels = { { 0, uint32_t(width), uint32_t(height) } };
+        const double megapixels = double(width) * height / 1e6;
+
+        std::cout << path << " (" << width << "x" << height << ")\n"
+                  << "  format   best ms   MPixel/s   ratio    PSNR dB" << std::endl;
+
+        for (const auto& format : formats)
+        {
+            std::vector<LearnVulkan::Wrapper::MipLevel> compressedLevels{};
+            std::vector<uint8_t> compressed{};
+            double best = 1e30;
+
+            for (int i = 0; i < iterations; ++i)
+            {
+                auto start = Clock::now();
+                compressed = LearnVulkan::BlockCompressor::compress(pixels, levels, format.mFormat, compressedLevels, threads);
+                best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+            }
+
+            const double ratio = double(width) * height * 4 / double(compressed.size());
+            const double psnr  = computePsnr(pixels, uint32_t(width), uint32_t(height), compressed.data(), format);
+
+            char line[160];
+            std::snprintf(line, sizeof(line), "  %-6s %9.2f %10.1f %7.1fx %10.2f",
+                          format.mName, best * 1000.0, megapixels / best, ratio, psnr);
+            std::cout << line << std::endl;
+        }
+
+        stbi_image_free(pixels);
+    }
+
+    return 0;
+}
@@ -0,0 +1,563 @@
+﻿// 命令录制开销：每帧释放再分配 vs 逐个重置 vs 整池重置（TRANSIENT）
+//
+// 用法：commandRecordBenchmark [--draws <N>] [--frames <N>] [--shader <depth.spv>]
+// 创建不带窗口的 Vulkan 设备，以及与深度预渲染相同的管线（shaders/depth.spv，只读位置流）。每帧向一个主命令缓冲区录制一个渲染通道，
+// 每次绘制绑定顶点 / 索引缓冲区、以不同的动态偏移绑定描述符集，再 vkCmdDrawIndexed，与 Application 每个物体的录制内容相同。
+// 只计 CPU 录制耗时（含分配 / 重置），不提交。不指定 --draws 时依次测 100、1000、10000 次绘制，
+// 报告每帧的最佳 / 平均耗时，以及折算到每 1000 次绘制的微秒数。
+// 需要在构建目录下运行（默认着色器路径相对于工作目录），测量时不要开启验证层。
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    constexpr VkDeviceSize BufferSize        = 64 * 1024;
+    constexpr uint32_t     UniformStride     = 256;   // 不小于任何实现的 minUniformBufferOffsetAlignment
+    constexpr uint32_t     DynamicSlotCount  = 64;
+
+    void check(VkResult result, const char* what)
+    {
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Error: failed to ") + what + "!");
+        }
+    }
+
+    enum class Strategy
+    {
+        FreeAndAllocate,   // 每帧 vkAllocateCommandBuffers / vkFreeCommandBuffers
+        ResetBuffer,       // RESET_COMMAND_BUFFER 池，逐个 vkResetCommandBuffer
+        ResetPool,         // TRANSIENT 池，每帧 vkResetCommandPool
+    };
+
+    struct StrategyCase
+    {
+        const char*              mName{ nullptr };
+        Strategy                 mStrategy{ Strategy::ResetPool };
+        VkCommandPoolCreateFlags mPoolFlags{ 0 };
+    };
+
+    // 与 Application 深度预渲染相同的管线和资源，只为录制提供合法的句柄
+    class Context
+    {
+    public:
+        explicit Context(const std::string& shaderPath)
+        {
+            createDevice();
+            createRenderPass();
+            createPipeline(shaderPath);
+            createResources();
+        }
+
+        ~Context()
+        {
+            if (mDevice != VK_NULL_HANDLE)
+            {
+                vkDeviceWaitIdle(mDevice);
+
+                vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
+                vkDestroyBuffer(mDevice, mBuffer, nullptr);
+                vkFreeMemory(mDevice, mMemory, nullptr);
+                vkDestroyPipeline(mDevice, mPipeline, nullptr);
+                vkDestroyPipelineLayout(mDevice, mPipelineLayout, nullptr);
+                vkDestroyDescriptorSetLayout(mDevice, mSetLayout, nullptr);
+                vkDestroyFramebuffer(mDevice, mFramebuffer, nullptr);
+                vkDestroyRenderPass(mDevice, mRenderPass, nullptr);
+                vkDestroyDevice(mDevice, nullptr);
+            }
+
+            if (mInstance != VK_NULL_HANDLE)
+            {
+                vkDestroyInstance(mInstance, nullptr);
+            }
+        }
+
+        Context(const Context&) = delete;
+        Context& operator=(const Context&) = delete;
+
+        VkCommandPool createPool(VkCommandPoolCreateFlags flags) const
+        {
+            VkCommandPoolCreateInfo createInfo{};
+            createInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            createInfo.flags            = flags;
+            createInfo.queueFamilyIndex = mQueueFamily;
+
+            VkCommandPool pool{ VK_NULL_HANDLE };
+            check(vkCreateCommandPool(mDevice, &createInfo, nullptr, &pool), "create command pool");
+
+            return pool;
+        }
+
+        VkCommandBuffer allocate(VkCommandPool pool) const
+        {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool        = pool;
+            allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+            check(vkAllocateCommandBuffers(mDevice, &allocInfo, &commandBuffer), "allocate command buffer");
+
+            return commandBuffer;
+        }
+
+        void record(VkCommandBuffer commandBuffer, uint32_t drawCount) const
+        {
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            check(vkBeginCommandBuffer(commandBuffer, &beginInfo), "begin command buffer");
+
+            VkRenderPassBeginInfo renderBeginInfo{};
+            renderBeginInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            renderBeginInfo.renderPass        = mRenderPass;
+            renderBeginInfo.framebuffer       = mFramebuffer;
+            renderBeginInfo.renderArea.extent = { 1, 1 };
+
+            vkCmdBeginRenderPass(commandBuffer, &renderBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+
+            const VkDeviceSize vertexOffset = 0;
+
+            for (uint32_t i = 0; i < drawCount; ++i)
+            {
+                const uint32_t dynamicOffset = (i % DynamicSlotCount) * UniformStride;
+
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mBuffer, &vertexOffset);
+                vkCmdBindIndexBuffer(commandBuffer, mBuffer, 0, VK_INDEX_TYPE_UINT32);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1, &mDescriptorSet, 1, &dynamicOffset);
+                vkCmdDrawIndexed(commandBuffer, 3, 1, 0, 0, 0);
+            }
+
+            vkCmdEndRenderPass(commandBuffer);
+
+            check(vkEndCommandBuffer(commandBuffer), "end command buffer");
+        }
+
+        [[nodiscard]] auto getDevice()     const { return mDevice; }
+        [[nodiscard]] auto getDeviceName() const { return std::string(mDeviceName); }
+
+    private:
+        void createDevice()
+        {
+            VkApplicationInfo appInfo{};
+            appInfo.sType            = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+            appInfo.pApplicationName = "commandRecordBenchmark";
+            appInfo.apiVersion       = VK_API_VERSION_1_0;
+
+            VkInstanceCreateInfo instanceInfo{};
+            instanceInfo.sType            = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+            instanceInfo.pApplicationInfo = &appInfo;
+
+            check(vkCreateInstance(&instanceInfo, nullptr, &mInstance), "create instance");
+
+            uint32_t deviceCount = 0;
+            vkEnumeratePhysicalDevices(mInstance, &deviceCount, nullptr);
+
+            std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
+            vkEnumeratePhysicalDevices(mInstance, &deviceCount, physicalDevices.data());
+
+            // 取第一个带图形队列的设备
+            for (auto physicalDevice : physicalDevices)
+            {
+                uint32_t familyCount = 0;
+                vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+
+                std::vector<VkQueueFamilyProperties> families(familyCount);
+                vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+                for (uint32_t i = 0; i < familyCount; ++i)
+                {
+                    if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+                    {
+                        mPhysicalDevice = physicalDevice;
+                        mQueueFamily    = i;
+                        break;
+                    }
+                }
+
+                if (mPhysicalDevice != VK_NULL_HANDLE)
+                {
+                    break;
+                }
+            }
+
+            if (mPhysicalDevice == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("Error: no physical device with a graphics queue!");
+            }
+
+            VkPhysicalDeviceProperties properties{};
+            vkGetPhysicalDeviceProperties(mPhysicalDevice, &properties);
+            std::snprintf(mDeviceName, sizeof(mDeviceName), "%s", properties.deviceName);
+
+            const float priority = 1.0f;
+
+            VkDeviceQueueCreateInfo queueInfo{};
+            queueInfo.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueInfo.queueFamilyIndex = mQueueFamily;
+            queueInfo.queueCount       = 1;
+            queueInfo.pQueuePriorities = &priority;
+
+            VkDeviceCreateInfo deviceInfo{};
+            deviceInfo.sType                = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+            deviceInfo.queueCreateInfoCount = 1;
+            deviceInfo.pQueueCreateInfos    = &queueInfo;
+
+            check(vkCreateDevice(mPhysicalDevice, &deviceInfo, nullptr, &mDevice), "create device");
+        }
+
+        void createRenderPass()
+        {
+            // 不带附件的渲染通道和 1x1 帧缓冲：录制开销与附件无关
+            VkSubpassDescription subpass{};
+            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+            VkRenderPassCreateInfo renderPassInfo{};
+            renderPassInfo.sType        = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            renderPassInfo.subpassCount = 1;
+            renderPassInfo.pSubpasses   = &subpass;
+
+            check(vkCreateRenderPass(mDevice, &renderPassInfo, nullptr, &mRenderPass), "create render pass");
+
+            VkFramebufferCreateInfo framebufferInfo{};
+            framebufferInfo.sType      = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = mRenderPass;
+            framebufferInfo.width      = 1;
+            framebufferInfo.height     = 1;
+            framebufferInfo.layers     = 1;
+
+            check(vkCreateFramebuffer(mDevice, &framebufferInfo, nullptr, &mFramebuffer), "create framebuffer");
+        }
+
+        void createPipeline(const std::string& shaderPath)
+        {
+            std::ifstream file(shaderPath, std::ios::binary | std::ios::ate);
+
+            if (!file)
+            {
+                throw std::runtime_error("Error: cannot open " + shaderPath);
+            }
+
+            std::vector<uint32_t> code(static_cast<size_t>(file.tellg()) / sizeof(uint32_t));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(code.data()), code.size() * sizeof(uint32_t));
+
+            VkShaderModuleCreateInfo moduleInfo{};
+            moduleInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            moduleInfo.codeSize = code.size() * sizeof(uint32_t);
+            moduleInfo.pCode    = code.data();
+
+            VkShaderModule shaderModule{ VK_NULL_HANDLE };
+            check(vkCreateShaderModule(mDevice, &moduleInfo, nullptr, &shaderModule), "create shader module");
+
+            // 与 UniformManager 相同：binding 0 为 VP 矩阵，binding 1 为按物体动态偏移的物体常量
+            VkDescriptorSetLayoutBinding bindings[2]{};
+            bindings[0].binding         = 0;
+            bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            bindings[0].descriptorCount = 1;
+            bindings[0].stageFlags      = VK_SHADER_STAGE_VERTEX_BIT;
+            bindings[1]                 = bindings[0];
+            bindings[1].binding         = 1;
+            bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+
+            VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+            setLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            setLayoutInfo.bindingCount = 2;
+            setLayoutInfo.pBindings    = bindings;
+
+            check(vkCreateDescriptorSetLayout(mDevice, &setLayoutInfo, nullptr, &mSetLayout), "create descriptor set layout");
+
+            VkPipelineLayoutCreateInfo layoutInfo{};
+            layoutInfo.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            layoutInfo.setLayoutCount = 1;
+            layoutInfo.pSetLayouts    = &mSetLayout;
+
+            check(vkCreatePipelineLayout(mDevice, &layoutInfo, nullptr, &mPipelineLayout), "create pipeline layout");
+
+            VkPipelineShaderStageCreateInfo stage{};
+            stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stage.stage  = VK_SHADER_STAGE_VERTEX_BIT;
+            stage.module = shaderModule;
+            stage.pName  = "main";
+
+            VkVertexInputBindingDescription vertexBinding{};
+            vertexBinding.binding   = 0;
+            vertexBinding.stride    = sizeof(float) * 3;
+            vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            VkVertexInputAttributeDescription vertexAttribute{};
+            vertexAttribute.location = 0;
+            vertexAttribute.binding  = 0;
+            vertexAttribute.format   = VK_FORMAT_R32G32B32_SFLOAT;
+
+            VkPipelineVertexInputStateCreateInfo vertexInput{};
+            vertexInput.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vertexInput.vertexBindingDescriptionCount   = 1;
+            vertexInput.pVertexBindingDescriptions      = &vertexBinding;
+            vertexInput.vertexAttributeDescriptionCount = 1;
+            vertexInput.pVertexAttributeDescriptions    = &vertexAttribute;
+
+            VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+            inputAssembly.sType    = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+            inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+            VkViewport viewport{ 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+            VkRect2D   scissor{ { 0, 0 }, { 1, 1 } };
+
+            VkPipelineViewportStateCreateInfo viewportState{};
+            viewportState.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+            viewportState.viewportCount = 1;
+            viewportState.pViewports    = &viewport;
+            viewportState.scissorCount  = 1;
+            viewportState.pScissors     = &scissor;
+
+            VkPipelineRasterizationStateCreateInfo rasterization{};
+            rasterization.sType       = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+            rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+            rasterization.cullMode    = VK_CULL_MODE_NONE;
+            rasterization.frontFace   = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+            rasterization.lineWidth   = 1.0f;
+
+            VkPipelineMultisampleStateCreateInfo multisample{};
+            multisample.sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+            multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+            VkPipelineColorBlendStateCreateInfo colorBlend{};
+            colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+
+            VkGraphicsPipelineCreateInfo pipelineInfo{};
+            pipelineInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            pipelineInfo.stageCount          = 1;
+            pipelineInfo.pStages             = &stage;
+            pipelineInfo.pVertexInputState   = &vertexInput;
+            pipelineInfo.pInputAssemblyState = &inputAssembly;
+            pipelineInfo.pViewportState      = &viewportState;
+            pipelineInfo.pRasterizationState = &rasterization;
+            pipelineInfo.pMultisampleState   = &multisample;
+            pipelineInfo.pColorBlendState    = &colorBlend;
+            pipelineInfo.layout              = mPipelineLayout;
+            pipelineInfo.renderPass          = mRenderPass;
+            pipelineInfo.subpass             = 0;
+
+            const VkResult result = vkCreateGraphicsPipelines(mDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &mPipeline);
+            vkDestroyShaderModule(mDevice, shaderModule, nullptr);
+
+            check(result, "create graphics pipeline");
+        }
+
+        void createResources()
+        {
+            // 一个缓冲区同时充当顶点、索引和常量缓冲区；内容不会被读取
+            VkBufferCreateInfo bufferInfo{};
+            bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufferInfo.size        = BufferSize;
+            bufferInfo.usage       = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+            bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            check(vkCreateBuffer(mDevice, &bufferInfo, nullptr, &mBuffer), "create buffer");
+
+            VkMemoryRequirements requirements{};
+            vkGetBufferMemoryRequirements(mDevice, mBuffer, &requirements);
+
+            uint32_t memoryType = 0;
+            while (memoryType < 32 && !(requirements.memoryTypeBits & (1u << memoryType)))
+            {
+                ++memoryType;
+            }
+
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize  = requirements.size;
+            allocInfo.memoryTypeIndex = memoryType;
+
+            check(vkAllocateMemory(mDevice, &allocInfo, nullptr, &mMemory), "allocate buffer memory");
+            check(vkBindBufferMemory(mDevice, mBuffer, mMemory, 0), "bind buffer memory");
+
+            VkDescriptorPoolSize poolSizes[2]{};
+            poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            poolSizes[0].descriptorCount = 1;
+            poolSizes[1].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            poolSizes[1].descriptorCount = 1;
+
+            VkDescriptorPoolCreateInfo poolInfo{};
+            poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            poolInfo.maxSets       = 1;
+            poolInfo.poolSizeCount = 2;
+            poolInfo.pPoolSizes    = poolSizes;
+
+            check(vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &mDescriptorPool), "create descriptor pool");
+
+            VkDescriptorSetAllocateInfo setInfo{};
+            setInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            setInfo.descriptorPool     = mDescriptorPool;
+            setInfo.descriptorSetCount = 1;
+            setInfo.pSetLayouts        = &mSetLayout;
+
+            check(vkAllocateDescriptorSets(mDevice, &setInfo, &mDescriptorSet), "allocate descriptor set");
+
+            VkDescriptorBufferInfo bufferInfos[2]{};
+            bufferInfos[0] = { mBuffer, 0, UniformStride };
+            bufferInfos[1] = { mBuffer, 0, UniformStride };
+
+            VkWriteDescriptorSet writes[2]{};
+
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                writes[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet          = mDescriptorSet;
+                writes[i].dstBinding      = i;
+                writes[i].descriptorCount = 1;
+                writes[i].descriptorType  = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                writes[i].pBufferInfo     = &bufferInfos[i];
+            }
+
+            vkUpdateDescriptorSets(mDevice, 2, writes, 0, nullptr);
+        }
+
+        VkInstance       mInstance{ VK_NULL_HANDLE };
+        VkPhysicalDevice mPhysicalDevice{ VK_NULL_HANDLE };
+        VkDevice         mDevice{ VK_NULL_HANDLE };
+        uint32_t         mQueueFamily{ 0 };
+        char             mDeviceName[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE]{};
+
+        VkRenderPass          mRenderPass{ VK_NULL_HANDLE };
+        VkFramebuffer         mFramebuffer{ VK_NULL_HANDLE };
+        VkDescriptorSetLayout mSetLayout{ VK_NULL_HANDLE };
+        VkPipelineLayout      mPipelineLayout{ VK_NULL_HANDLE };
+        VkPipeline            mPipeline{ VK_NULL_HANDLE };
+
+        VkBuffer         mBuffer{ VK_NULL_HANDLE };
+        VkDeviceMemory   mMemory{ VK_NULL_HANDLE };
+        VkDescriptorPool mDescriptorPool{ VK_NULL_HANDLE };
+        VkDescriptorSet  mDescriptorSet{ VK_NULL_HANDLE };
+    };
+
+    // 返回每帧的 { 最佳, 平均 } 秒数
+    std::pair<double, double> measure(const Context& context, const StrategyCase& strategy, uint32_t drawCount, int frames)
+    {
+        const VkDevice device = context.getDevice();
+        const VkCommandPool pool = context.createPool(strategy.mPoolFlags);
+
+        VkCommandBuffer commandBuffer = strategy.mStrategy == Strategy::FreeAndAllocate ? VK_NULL_HANDLE : context.allocate(pool);
+
+        double best  = 1e30;
+        double total = 0.0;
+
+        // 先录一帧预热，让池和驱动的命令内存增长到稳定大小
+        for (int frame = -1; frame < frames; ++frame)
+        {
+            const auto start = Clock::now();
+
+            switch (strategy.mStrategy)
+            {
+            case Strategy::FreeAndAllocate:
+                commandBuffer = context.allocate(pool);
+                context.record(commandBuffer, drawCount);
+                vkFreeCommandBuffers(device, pool, 1, &commandBuffer);
+                break;
+
+            case Strategy::ResetBuffer:
+                check(vkResetCommandBuffer(commandBuffer, 0), "reset command buffer");
+                context.record(commandBuffer, drawCount);
+                break;
+
+            case Strategy::ResetPool:
+                check(vkResetCommandPool(device, pool, 0), "reset command pool");
+                context.record(commandBuffer, drawCount);
+                break;
+            }
+
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (frame >= 0)
+            {
+                best   = std::min(best, seconds);
+                total += seconds;
+            }
+        }
+
+        // 销毁池时其中的命令缓冲区一并释放
+        vkDestroyCommandPool(device, pool, nullptr);
+
+        return { best, total / frames };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int         frames     = 200;
+    std::string shaderPath = "shaders/depth.spv";
+    std::vector<uint32_t> drawCounts{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--draws" && i + 1 < argc)
+        {
+            drawCounts.push_back(static_cast<uint32_t>(std::max(1, std::stoi(argv[++i]))));
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            frames = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--shader" && i + 1 < argc)
+        {
+            shaderPath = argv[++i];
+        }
+    }
+
+    if (drawCounts.empty())
+    {
+        drawCounts = { 100, 1000, 10000 };
+    }
+
+    const StrategyCase cases[] =
+    {
+        { "free + allocate", Strategy::FreeAndAllocate, 0 },
+        { "reset buffer   ", Strategy::ResetBuffer,     VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT },
+        { "reset pool     ", Strategy::ResetPool,       VK_COMMAND_POOL_CREATE_TRANSIENT_BIT },
+    };
+
+    try
+    {
+        Context context(shaderPath);
+
+        std::cout << context.getDeviceName() << " (" << frames << " frames per case)\n"
+                  << "  strategy          draws    best us    mean us   us/1k draws" << std::endl;
+
+        for (uint32_t drawCount : drawCounts)
+        {
+            for (const auto& strategy : cases)
+            {
+                const auto [best, mean] = measure(context, strategy, drawCount, frames);
+
+                char line[160];
+                std::snprintf(line, sizeof(line), "  %s  %7u  %9.1f  %9.1f  %12.2f",
+                              strategy.mName, drawCount, best * 1e6, mean * 1e6, best * 1e6 * 1000.0 / drawCount);
+                std::cout << line << std::endl;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+﻿// LOD 链生成与屏幕空间误差选择
+//
+// 用法：lodBenchmark [--threshold <像素>] [--height <像素>] [file.obj ...]
+// 不指定文件时使用 assets 下的 african_head 和 boggie。按与 Model 相同的参数生成 LOD 链，
+// 报告每级的三角形数、几何误差和简化耗时，再列出 60 度视场下不同距离实际选中的级别和三角形数。
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../objParser.h"
+#include "../meshSimplifier.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <tuple>
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    // 与 Model::generateLods 相同的参数
+    constexpr uint32_t MaxLodCount     = 5;
+    constexpr float    LodReduction    = 0.5f;
+    constexpr float    MinLodReduction = 0.9f;
+    constexpr float    MaxRelativeLodError = 0.05f;
+
+    struct Mesh
+    {
+        std::vector<uint32_t> mIndices{};
+        std::vector<float>    mPositions{};
+    };
+
+    // 与 Model 相同的 (位置, UV, 法线) 去重
+    Mesh loadMesh(const std::string& path)
+    {
+        tinyobj::attrib_t             attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::string                   err;
+
+        if (!LearnVulkan::ObjParser::parse(path, attrib, shapes, err))
+        {
+            throw std::runtime_error(err);
+        }
+
+        std::map<std::tuple<int, int, int>, uint32_t> unique{};
+        Mesh mesh{};
+
+        for (const auto& shape : shapes)
+        {
+            for (const auto& index : shape.mesh.indices)
+            {
+                auto key = std::make_tuple(index.vertex_index, index.texcoord_index, index.normal_index);
+                auto [it, inserted] = unique.try_emplace(key, static_cast<uint32_t>(unique.size()));
+
+                if (inserted)
+                {
+                    mesh.mPositions.push_back(attrib.vertices[3 * index.vertex_index + 0]);
+                    mesh.mPositions.push_back(attrib.vertices[3 * index.vertex_index + 1]);
+                    mesh.mPositions.push_back(attrib.vertices[3 * index.vertex_index + 2]);
+                }
+
+                mesh.mIndices.push_back(it->second);
+            }
+        }
+
+        return mesh;
+    }
+
+    float boundingRadius(const std::vector<float>& positions)
+    {
+        glm::vec3 minPosition(std::numeric_limits<float>::max());
+        glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+
+        for (size_t i = 0; i + 2 < positions.size(); i += 3)
+        {
+            minPosition = glm::min(minPosition, glm::vec3(positions[i], positions[i + 1], positions[i + 2]));
+            maxPosition = glm::max(maxPosition, glm::vec3(positions[i], positions[i + 1], positions[i + 2]));
+        }
+
+        return glm::length(maxPosition - minPosition) * 0.5f;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    float threshold = 1.0f;
+    float height    = 1080.0f;
+    std::vector<std::string> paths{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--threshold" && i + 1 < argc)
+        {
+            threshold = std::stof(argv[++i]);
+        }
+        else if (arg == "--height" && i + 1 < argc)
+        {
+            height = std::stof(argv[++i]);
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.empty())
+    {
+        paths.push_back("assets/models/african_head/african_head.obj");
+        paths.push_back("assets/models/boggie/body.obj");
+    }
+
+    for (const auto& path : paths)
+    {
+        const Mesh  mesh   = loadMesh(path);
+        const float radius = boundingRadius(mesh.mPositions);
+
+        std::vector<LearnVulkan::LodLevel> levels(1);
+        levels[0].mIndexCount = static_cast<uint32_t>(mesh.mIndices.size());
+
+        std::cout << path << " (radius " << radius << ")\n"
+                  << "  lod   triangles   error      error/radius   ms" << std::endl;
+
+        char line[160];
+        std::snprintf(line, sizeof(line), "  %3d  %10zu  %9.6f  %12.5f  %6.1f", 0, mesh.mIndices.size() / 3, 0.0, 0.0, 0.0);
+        std::cout << line << std::endl;
+
+        float targetRatio = 1.0f;
+
+        while (levels.size() < MaxLodCount)
+        {
+            targetRatio *= LodReduction;
+
+            float error = 0.0f;
+
+            auto start = Clock::now();
+            auto lod   = LearnVulkan::MeshSimplifier::simplify(mesh.mIndices, mesh.mPositions,
+                                                               size_t(mesh.mIndices.size() * targetRatio) / 3 * 3,
+                                                               radius * MaxRelativeLodError, error);
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            if (lod.empty() || lod.size() > levels.back().mIndexCount * MinLodReduction)
+            {
+                break;
+            }
+
+            LearnVulkan::LodLevel level{};
+            level.mIndexCount = static_cast<uint32_t>(lod.size());
+            level.mError      = std::max(error, levels.back().mError);
+            levels.push_back(level);
+
+            std::snprintf(line, sizeof(line), "  %3zu  %10zu  %9.6f  %12.5f  %6.1f",
+                          levels.size() - 1, lod.size() / 3, level.mError, level.mError / radius, ms);
+            std::cout << line << std::endl;
+        }
+
+        // 与 Model::selectLod 相同：单位长度在距离 d 处的像素数 = 投影 [1][1] * 高度 / 2 / d
+        const float projectionScale = 1.0f / std::tan(glm::radians(60.0f) * 0.5f);
+
+        std::cout << "  distance/radius   lod   triangles   (threshold " << threshold << " px, height " << height << ")" << std::endl;
+
+        for (float distance : { 2.0f, 5.0f, 10.0f, 20.0f, 50.0f, 100.0f, 200.0f })
+        {
+            const float    pixelsPerUnit = projectionScale * height * 0.5f / (distance * radius);
+            const uint32_t level         = LearnVulkan::MeshSimplifier::selectLod(levels, pixelsPerUnit, threshold);
+
+            std::snprintf(line, sizeof(line), "  %15.0f  %4u  %10u", distance, level, levels[level].mIndexCount / 3);
+            std::cout << line << std::endl;
+        }
+    }
+
+    return 0;
+}
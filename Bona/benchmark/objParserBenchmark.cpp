@@ -0,0 +1,243 @@
+﻿// OBJ 解析吞吐量对比：tinyobj::LoadObj vs ObjParser
+//
+// 用法：objParserBenchmark [--size <MB>] [--iterations <N>] [file.obj ...]
+// 不指定文件时先生成一个约 <MB> 大小的合成网格（三角形 + 四边形 + 负索引 + 分组），
+// 每个文件都会校验两条路径输出一致，再报告各自的最佳耗时和 MB/s。
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../objParser.h"
+#include "../mappedFile.h"
+
+#include <cstdio>
+#include <random>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    void writeSyntheticObj(const std::string& path, size_t targetBytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw std::runtime_error("Error: cannot write " + path);
+        }
+
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> jitter(-0.001f, 0.001f);
+
+        // 每个网格块约 64x64 个顶点，不断追加直到达到目标大小
+        constexpr int gridSize = 64;
+        size_t written = 0;
+        size_t vertexBase = 0;
+        char line[256];
+
+        for (int block = 0; written < targetBytes; ++block)
+        {
+            file << "g block" << block << "\n";
+
+            for (int y = 0; y < gridSize; ++y)
+            {
+                for (int x = 0; x < gridSize; ++x)
+                {
+                    const float px = x / float(gridSize - 1) + block + jitter(random);
+                    const float py = y / float(gridSize - 1) + jitter(random);
+                    const float pz = std::sin(px * 3.0f) * std::cos(py * 5.0f) * 1.0e-2f;
+
+                    std::snprintf(line, sizeof(line), "v %.6f %.6f %.6e\nvt %.6f %.6f\nvn 0 0 1\n",
+                                  px, py, pz, x / float(gridSize - 1), y / float(gridSize - 1));
+                    file << line;
+                }
+            }
+
+            // 偶数块用绝对索引 + 四边形，奇数块用负（相对）索引 + 三角形
+            const bool relative = block % 2 == 1;
+            const size_t blockVertices = gridSize * gridSize;
+
+            for (int y = 0; y + 1 < gridSize; ++y)
+            {
+                for (int x = 0; x + 1 < gridSize; ++x)
+                {
+                    size_t corners[4] =
+                    {
+                        vertexBase + y * gridSize + x + 1,
+                        vertexBase + y * gridSize + x + 2,
+                        vertexBase + (y + 1) * gridSize + x + 2,
+                        vertexBase + (y + 1) * gridSize + x + 1,
+                    };
+
+                    if (relative)
+                    {
+                        long long r[4];
+                        for (int k = 0; k < 4; ++k)
+                        {
+                            r[k] = static_cast<long long>(corners[k]) - static_cast<long long>(vertexBase + blockVertices) - 1;
+                        }
+
+                        std::snprintf(line, sizeof(line), "f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\nf %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n",
+                                      r[0], r[0], r[0], r[1], r[1], r[1], r[2], r[2], r[2],
+                                      r[0], r[0], r[0], r[2], r[2], r[2], r[3], r[3], r[3]);
+                    }
+                    else
+                    {
+                        std::snprintf(line, sizeof(line), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n",
+                                      corners[0], corners[0], corners[0], corners[1], corners[1], corners[1],
+                                      corners[2], corners[2], corners[2], corners[3], corners[3], corners[3]);
+                    }
+                    file << line;
+                }
+            }
+
+            vertexBase += blockVertices;
+            written = static_cast<size_t>(file.tellp());
+        }
+    }
+
+    std::vector<tinyobj::index_t> flattenIndices(const std::vector<tinyobj::shape_t>& shapes)
+    {
+        std::vector<tinyobj::index_t> indices{};
+        for (const auto& shape : shapes)
+        {
+            indices.insert(indices.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+        }
+        return indices;
+    }
+
+    template<typename T>
+    bool sameBits(const std::vector<T>& lhs, const std::vector<T>& rhs)
+    {
+        return lhs.size() == rhs.size() && (lhs.empty() || memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0);
+    }
+
+    bool sameOutput(const tinyobj::attrib_t& lhsAttrib, const std::vector<tinyobj::shape_t>& lhsShapes,
+                    const tinyobj::attrib_t& rhsAttrib, const std::vector<tinyobj::shape_t>& rhsShapes)
+    {
+        if (!sameBits(lhsAttrib.vertices, rhsAttrib.vertices))
+        {
+            std::cout << "  mismatch: vertices" << std::endl;
+            return false;
+        }
+
+        if (!sameBits(lhsAttrib.texcoords, rhsAttrib.texcoords))
+        {
+            std::cout << "  mismatch: texcoords" << std::endl;
+            return false;
+        }
+
+        if (!sameBits(lhsAttrib.normals, rhsAttrib.normals))
+        {
+            std::cout << "  mismatch: normals" << std::endl;
+            return false;
+        }
+
+        if (!sameBits(flattenIndices(lhsShapes), flattenIndices(rhsShapes)))
+        {
+            std::cout << "  mismatch: face indices" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename Function>
+    double bestSeconds(int iterations, Function&& function)
+    {
+        double best = 1e30;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = Clock::now();
+            function();
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t sizeMB     = 256;
+    int    iterations = 3;
+    std::vector<std::string> paths{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--size" && i + 1 < argc)
+        {
+            sizeMB = std::stoul(argv[++i]);
+        }
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            iterations = std::max(1, std::stoi(argv[++i]));
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.empty())
+    {
+        const std::string syntheticPath = "objParserBenchmark_synthetic.obj";
+        std::cout << "Generating " << sizeMB << " MB synthetic mesh: " << syntheticPath << std::endl;
+
+        writeSyntheticObj(syntheticPath, sizeMB << 20);
+        paths.push_back(syntheticPath);
+    }
+
+    bool allMatch = true;
+
+    for (const auto& path : paths)
+    {
+        auto file = LearnVulkan::MappedFile::open(path);
+        if (!file)
+        {
+            std::cout << path << ": cannot open" << std::endl;
+            allMatch = false;
+            continue;
+        }
+
+        const double megabytes = static_cast<double>(file->getSize()) / (1 << 20);
+        file.reset();
+
+        tinyobj::attrib_t                tinyAttrib;
+        std::vector<tinyobj::shape_t>    tinyShapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string                      warn;
+        std::string                      err;
+
+        const double tinySeconds = bestSeconds(iterations, [&]()
+        {
+            if (!tinyobj::LoadObj(&tinyAttrib, &tinyShapes, &materials, &warn, &err, path.c_str()))
+            {
+                throw std::runtime_error(err);
+            }
+        });
+
+        tinyobj::attrib_t             attrib;
+        std::vector<tinyobj::shape_t> shapes;
+
+        const double parserSeconds = bestSeconds(iterations, [&]()
+        {
+            if (!LearnVulkan::ObjParser::parse(path, attrib, shapes, err))
+            {
+                throw std::runtime_error(err);
+            }
+        });
+
+        const bool match = sameOutput(tinyAttrib, tinyShapes, attrib, shapes);
+        allMatch = allMatch && match;
+
+        std::cout << path << " (" << megabytes << " MB, " << std::thread::hardware_concurrency() << " threads)\n"
+                  << "  tinyobj   : " << tinySeconds * 1000.0 << " ms, " << megabytes / tinySeconds << " MB/s\n"
+                  << "  ObjParser : " << parserSeconds * 1000.0 << " ms, " << megabytes / parserSeconds << " MB/s"
+                  << " (x" << tinySeconds / parserSeconds << ")\n"
+                  << "  output    : " << (match ? "identical" : "DIFFERENT") << std::endl;
+    }
+
+    return allMatch ? 0 : 1;
+}
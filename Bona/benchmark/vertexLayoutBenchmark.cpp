@@ -0,0 +1,220 @@
+﻿// 顶点流布局对比：分离（位置流 + 属性流）vs 交错
+//
+// 用法：vertexLayoutBenchmark [--quantized] [--iterations <N>] [file.obj ...]
+// 不指定文件时使用 assets 下的 diablo3_pose。对每种布局分别模拟完整绘制和只取位置的 Pass（深度 / 阴影）：
+//   - fetch：按索引顺序经过 32 项的后变换缓存，未命中的顶点才取数据，取数据经过 16KB 直接映射的
+//            64 字节缓存行，统计实际从显存读入的字节数（近似 GPU 顶点获取带宽）
+//   - gather：CPU 按索引顺序读取同样的属性，报告最佳耗时，作为真实内存访问的参考
+// --quantized 使用 Snorm16 的步长（位置 8 字节，UV 4 字节），否则为 32 位浮点（12 / 8 字节）。
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../objParser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <tuple>
+
+namespace
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    constexpr uint32_t CacheLineSize   = 64;
+    constexpr uint32_t FetchCacheLines = 256;   // 16KB
+    constexpr uint32_t VertexCacheSize = 32;
+
+    // 一条绑定的顶点流：每个顶点读取 [offset, offset + readBytes)，相邻顶点间隔 stride
+    struct StreamAccess
+    {
+        const uint8_t* mData{ nullptr };
+        uint32_t       mStride{ 0 };
+        uint32_t       mOffset{ 0 };
+        uint32_t       mReadBytes{ 0 };
+    };
+
+    struct LayoutCase
+    {
+        const char*               mName{ nullptr };
+        std::vector<StreamAccess> mStreams{};
+    };
+
+    struct Mesh
+    {
+        std::vector<uint32_t> mIndices{};
+        size_t                mVertexCount{ 0 };
+    };
+
+    // 与 Model 相同的 (位置, UV, 法线) 去重，只需要索引和顶点数
+    Mesh loadMesh(const std::string& path)
+    {
+        tinyobj::attrib_t             attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::string                   err;
+
+        if (!LearnVulkan::ObjParser::parse(path, attrib, shapes, err))
+        {
+            throw std::runtime_error(err);
+        }
+
+        std::map<std::tuple<int, int, int>, uint32_t> unique{};
+        Mesh mesh{};
+
+        for (const auto& shape : shapes)
+        {
+            for (const auto& index : shape.mesh.indices)
+            {
+                auto key = std::make_tuple(index.vertex_index, index.texcoord_index, index.normal_index);
+                auto [it, inserted] = unique.try_emplace(key, static_cast<uint32_t>(unique.size()));
+                mesh.mIndices.push_back(it->second);
+            }
+        }
+
+        mesh.mVertexCount = unique.size();
+        return mesh;
+    }
+
+    uint64_t simulateFetchBytes(const Mesh& mesh, const LayoutCase& layout)
+    {
+        std::vector<uint32_t> vertexCache(VertexCacheSize, UINT32_MAX);
+        std::vector<uint64_t> lineTags(FetchCacheLines, UINT64_MAX);
+        size_t   vertexCacheHead = 0;
+        uint64_t missedLines     = 0;
+
+        for (uint32_t index : mesh.mIndices)
+        {
+            if (std::find(vertexCache.begin(), vertexCache.end(), index) != vertexCache.end())
+            {
+                continue;
+            }
+
+            vertexCache[vertexCacheHead] = index;
+            vertexCacheHead = (vertexCacheHead + 1) % VertexCacheSize;
+
+            for (size_t s = 0; s < layout.mStreams.size(); ++s)
+            {
+                const auto&    stream = layout.mStreams[s];
+                const uint64_t begin  = uint64_t(index) * stream.mStride + stream.mOffset;
+                const uint64_t end    = begin + stream.mReadBytes;
+
+                for (uint64_t line = begin / CacheLineSize; line * CacheLineSize < end; ++line)
+                {
+                    // 流编号放在标记高位，不同缓冲区的缓存行互不混淆
+                    const uint64_t tag  = (uint64_t(s) << 56) | line;
+                    const uint64_t slot = (line + s * 97) % FetchCacheLines;
+
+                    if (lineTags[slot] != tag)
+                    {
+                        lineTags[slot] = tag;
+                        ++missedLines;
+                    }
+                }
+            }
+        }
+
+        return missedLines * CacheLineSize;
+    }
+
+    double bestGatherSeconds(const Mesh& mesh, const LayoutCase& layout, int iterations, uint64_t& checksum)
+    {
+        double best = 1e30;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            uint64_t sum = 0;
+            auto start = Clock::now();
+
+            for (uint32_t index : mesh.mIndices)
+            {
+                for (const auto& stream : layout.mStreams)
+                {
+                    const uint8_t* vertex = stream.mData + size_t(index) * stream.mStride + stream.mOffset;
+
+                    for (uint32_t b = 0; b < stream.mReadBytes; b += sizeof(uint32_t))
+                    {
+                        uint32_t word;
+                        memcpy(&word, vertex + b, sizeof(word));
+                        sum += word;
+                    }
+                }
+            }
+
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+            checksum += sum;
+        }
+
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool quantized  = false;
+    int  iterations = 20;
+    std::vector<std::string> paths{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--quantized")
+        {
+            quantized = true;
+        }
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            iterations = std::max(1, std::stoi(argv[++i]));
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.empty())
+    {
+        paths.push_back("assets/models/diablo3_pose/diablo3_pose.obj");
+    }
+
+    const uint32_t positionStride = quantized ? 8 : 12;
+    const uint32_t uvStride       = quantized ? 4 : 8;
+    const uint32_t vertexStride   = positionStride + uvStride;
+
+    uint64_t checksum = 0;
+
+    for (const auto& path : paths)
+    {
+        const Mesh mesh = loadMesh(path);
+
+        // 内容无关紧要，只需要和真实布局相同的地址分布
+        std::vector<uint8_t> positions(mesh.mVertexCount * positionStride, 1);
+        std::vector<uint8_t> uvs(mesh.mVertexCount * uvStride, 2);
+        std::vector<uint8_t> interleaved(mesh.mVertexCount * vertexStride, 3);
+
+        const LayoutCase cases[] =
+        {
+            { "split        full    ", { { positions.data(), positionStride, 0, positionStride }, { uvs.data(), uvStride, 0, uvStride } } },
+            { "interleaved  full    ", { { interleaved.data(), vertexStride, 0, vertexStride } } },
+            { "split        position", { { positions.data(), positionStride, 0, positionStride } } },
+            { "interleaved  position", { { interleaved.data(), vertexStride, 0, positionStride } } },
+        };
+
+        std::cout << path << " (" << mesh.mVertexCount << " vertices, " << mesh.mIndices.size() / 3 << " triangles, "
+                  << (quantized ? "snorm16" : "float") << " strides " << positionStride << "/" << uvStride << ")\n"
+                  << "  layout       pass       fetched KB   B/vertex   gather ms" << std::endl;
+
+        for (const auto& layout : cases)
+        {
+            const uint64_t fetched = simulateFetchBytes(mesh, layout);
+            const double   seconds = bestGatherSeconds(mesh, layout, iterations, checksum);
+
+            char line[160];
+            std::snprintf(line, sizeof(line), "  %s  %10.1f  %9.2f  %10.3f",
+                          layout.mName, fetched / 1024.0, double(fetched) / mesh.mVertexCount, seconds * 1000.0);
+            std::cout << line << std::endl;
+        }
+    }
+
+    // 防止读取循环被优化掉
+    std::cout << "checksum " << (checksum & 0xFFFF) << std::endl;
+
+    return 0;
+}
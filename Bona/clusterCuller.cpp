@@ -0,0 +1,175 @@
+﻿#include "clusterCuller.h"
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        constexpr uint32_t BindingMeshlets      = 0;
+        constexpr uint32_t BindingSourceIndices = 1;
+        constexpr uint32_t BindingCulledIndices = 2;
+        constexpr uint32_t BindingDrawCommand   = 3;
+        constexpr uint32_t BindingCullUniform   = 4;
+
+        Wrapper::UniformParameter::Ptr makeStorageParameter(uint32_t binding, const Wrapper::Buffer::Ptr& buffer, int frameCount)
+        {
+            auto param             = Wrapper::UniformParameter::create();
+            param->mBinding        = binding;
+            param->mCount          = 1;
+            param->mDescriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            param->mStage          = VK_SHADER_STAGE_COMPUTE_BIT;
+
+            // 存储缓冲区各帧共用同一个，剔除前的屏障保证上一帧的绘制已经读完
+            param->mBuffers.assign(frameCount, buffer);
+
+            return param;
+        }
+    }
+
+    ClusterCuller::ClusterCuller(const Wrapper::Device::Ptr& device, const Model::Ptr& model, int frameCount)
+    {
+        mDevice = device;
+        mModel  = model;
+
+        if (mModel->getMeshletCount() == 0)
+        {
+            throw std::runtime_error("Error: ClusterCuller requires a model loaded with setBuildMeshlets(true)!");
+        }
+
+        // 输出缓冲区按最大的一级 LOD 分配，任何级别全部可见时都放得下
+        uint32_t maxIndexCount = 0;
+
+        for (uint32_t level = 0; level < mModel->getLodCount(); ++level)
+        {
+            maxIndexCount = std::max(maxIndexCount, mModel->getLod(level).mIndexCount);
+        }
+
+        mCulledIndexBuffer = Wrapper::Buffer::createStorageBuffer(device,
+                                                                  VkDeviceSize(maxIndexCount) * sizeof(uint32_t),
+                                                                  nullptr,
+                                                                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+
+        mDrawCommandBuffer = Wrapper::Buffer::createStorageBuffer(device,
+                                                                  sizeof(VkDrawIndexedIndirectCommand),
+                                                                  nullptr,
+                                                                  VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+
+        mParams.push_back(makeStorageParameter(BindingMeshlets,      mModel->getMeshletBuffer(), frameCount));
+        mParams.push_back(makeStorageParameter(BindingSourceIndices, mModel->getIndexBuffer(),   frameCount));
+        mParams.push_back(makeStorageParameter(BindingCulledIndices, mCulledIndexBuffer,         frameCount));
+        mParams.push_back(makeStorageParameter(BindingDrawCommand,   mDrawCommandBuffer,         frameCount));
+
+        auto cullParam             = Wrapper::UniformParameter::create();
+        cullParam->mBinding        = BindingCullUniform;
+        cullParam->mCount          = 1;
+        cullParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        cullParam->mSize           = sizeof(CullUniform);
+        cullParam->mStage          = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        for (int i = 0; i < frameCount; ++i)
+        {
+            cullParam->mBuffers.push_back(Wrapper::Buffer::createUniformBuffer(device, cullParam->mSize, nullptr));
+        }
+        mParams.push_back(cullParam);
+
+        mCullUniforms.resize(frameCount);
+
+        mDescriptorSetLayout = Wrapper::DescriptorSetLayout::create(device);
+        mDescriptorSetLayout->build(mParams);
+
+        mDescriptorPool = Wrapper::DescriptorPool::create(device);
+        mDescriptorPool->build(mParams, frameCount);
+
+        mDescriptorSet = Wrapper::DescriptorSet::create(device, mParams, mDescriptorSetLayout, mDescriptorPool, frameCount);
+
+        mPipeline = Wrapper::ComputePipeline::create(device);
+        mPipeline->setShader(Wrapper::Shader::create(device, "shaders/cull.spv", VK_SHADER_STAGE_COMPUTE_BIT, "main"));
+
+        auto layout = mDescriptorSetLayout->getLayout();
+        mPipeline->mLayoutState.setLayoutCount = 1;
+        mPipeline->mLayoutState.pSetLayouts    = &layout;
+
+        mPipeline->build();
+    }
+
+    void ClusterCuller::update(const VPMatrices& vpMatrices, const ObjectUniform& objectUniform, int frame)
+    {
+        auto& uniform = mCullUniforms[frame];
+
+        // 从 clip = P * V * M 的行向量提取模型空间的视锥平面（Gribb-Hartmann），深度范围为 [0, w]
+        const glm::mat4 modelView = vpMatrices.mViewMatrix * objectUniform.mModelMatrix;
+        const glm::mat4 clip      = vpMatrices.mProjectionMatrix * modelView;
+
+        auto row = [&](int i) { return glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]); };
+
+        const glm::vec4 planes[6] =
+        {
+            row(3) + row(0),   // 左
+            row(3) - row(0),   // 右
+            row(3) + row(1),   // 下
+            row(3) - row(1),   // 上
+            row(2),            // 近
+            row(3) - row(2),   // 远
+        };
+
+        for (int i = 0; i < 6; ++i)
+        {
+            uniform.mFrustumPlanes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+        }
+
+        uniform.mCameraPosition = glm::inverse(modelView) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        const auto& lod = mModel->getLod(mModel->getCurrentLod());
+
+        uniform.mParams = glm::uvec4(lod.mMeshletCount, mModel->getIndexType() == VK_INDEX_TYPE_UINT16 ? 1u : 0u, lod.mFirstMeshlet, 0u);
+
+        mParams[BindingCullUniform]->mBuffers[frame]->updateBufferByMap(&uniform, sizeof(CullUniform));
+    }
+
+    void ClusterCuller::recordCull(const Wrapper::CommandBuffer::Ptr& commandBuffer, int frame)
+    {
+        // 步骤1：等上一次绘制读完间接命令和索引（队列内按提交顺序，执行依赖即可覆盖读后写）
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer              = mDrawCommandBuffer->getBuffer();
+        barrier.offset              = 0;
+        barrier.size                = VK_WHOLE_SIZE;
+        barrier.srcAccessMask       = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        commandBuffer->bufferBarrier(barrier,
+                                     VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                     VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        // 步骤2：重置间接命令，indexCount 由剔除着色器原子累加
+        VkDrawIndexedIndirectCommand drawCommand{};
+        drawCommand.indexCount    = 0;
+        drawCommand.instanceCount = 1;
+
+        commandBuffer->updateBuffer(mDrawCommandBuffer->getBuffer(), 0, sizeof(drawCommand), &drawCommand);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        commandBuffer->bufferBarrier(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        // 步骤3：每个工作组处理一个网格簇；命令缓冲区每帧在 update 之后录制，只分发当前 LOD 的簇数
+        commandBuffer->bindComputePipeline(mPipeline->getPipeline());
+        commandBuffer->bindDescriptorSet(mPipeline->getLayout(), mDescriptorSet->getDescriptorSet(frame), VK_PIPELINE_BIND_POINT_COMPUTE);
+        commandBuffer->dispatch(std::max(1u, mCullUniforms[frame].mParams.x));
+
+        // 步骤4：剔除结果对间接绘制和索引读取可见
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        commandBuffer->bufferBarrier(barrier, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+
+        barrier.buffer        = mCulledIndexBuffer->getBuffer();
+        barrier.dstAccessMask = VK_ACCESS_INDEX_READ_BIT;
+        commandBuffer->bufferBarrier(barrier, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+    }
+
+    void ClusterCuller::recordDraw(const Wrapper::CommandBuffer::Ptr& commandBuffer)
+    {
+        commandBuffer->bindIndexBuffer(mCulledIndexBuffer->getBuffer(), VK_INDEX_TYPE_UINT32);
+        commandBuffer->drawIndexIndirect(mDrawCommandBuffer->getBuffer());
+    }
+}
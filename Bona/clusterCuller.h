@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "vulkanWrapper/buffer.h"
+#include "vulkanWrapper/commandBuffer.h"
+#include "vulkanWrapper/computePipeline.h"
+#include "vulkanWrapper/descriptorSetLayout.h"
+#include "vulkanWrapper/descriptorPool.h"
+#include "vulkanWrapper/descriptorSet.h"
+#include "vulkanWrapper/description.h"
+#include "vulkanWrapper/device.h"
+#include "model.h"
+
+namespace LearnVulkan
+{
+    // GPU 网格簇剔除：每帧在绘制前用计算着色器对 Model 当前 LOD 级别的网格簇做视锥和法线锥（背面）剔除，
+    // 把可见簇的索引紧凑写入一个 32 位索引缓冲区，并累加到一条间接绘制命令的 indexCount 上。
+    //
+    // 用法：loadModel 之前 setBuildMeshlets(true)；录制时在渲染通道之前调用 recordCull，
+    // 在渲染通道内用 recordDraw 代替 bindIndexBuffer + drawIndex
+    class ClusterCuller
+    {
+    public:
+        using Ptr = std::shared_ptr<ClusterCuller>;
+
+        static Ptr create(const Wrapper::Device::Ptr& device, const Model::Ptr& model, int frameCount)
+        {
+            return std::make_shared<ClusterCuller>(device, model, frameCount);
+        }
+
+        ClusterCuller(const Wrapper::Device::Ptr& device, const Model::Ptr& model, int frameCount);
+
+        ~ClusterCuller() = default;
+
+        /// 根据视图投影和模型矩阵更新第 frame 帧的剔除参数（视锥平面和相机位置都换算到模型空间），
+        /// 剔除范围取 Model 当前选择的 LOD 级别
+        void update(const VPMatrices& vpMatrices, const ObjectUniform& objectUniform, int frame);
+
+        /// 录制剔除：重置间接命令 -> 分发剔除 -> 屏障，须在渲染通道之外
+        void recordCull(const Wrapper::CommandBuffer::Ptr& commandBuffer, int frame);
+
+        /// 录制绘制：绑定剔除后的索引缓冲区并执行间接绘制，顶点缓冲区仍由调用方绑定
+        void recordDraw(const Wrapper::CommandBuffer::Ptr& commandBuffer);
+
+    private:
+        // 与 MeshletCull.comp 中的 CullUniform 一致
+        struct CullUniform
+        {
+            glm::vec4  mFrustumPlanes[6];    // 模型空间平面 (n, d)，n 已归一化，点在平面内侧时 dot(n, p) + d >= 0
+            glm::vec4  mCameraPosition;      // 模型空间相机位置
+            glm::uvec4 mParams;              // x 网格簇数量，y 源索引是否为 16 位，z 首个网格簇
+        };
+
+    private:
+        Wrapper::Device::Ptr mDevice{ nullptr };
+        Model::Ptr           mModel{ nullptr };
+
+        Wrapper::Buffer::Ptr mCulledIndexBuffer{ nullptr };   // 剔除后紧凑排列的 32 位索引
+        Wrapper::Buffer::Ptr mDrawCommandBuffer{ nullptr };   // 单条 VkDrawIndexedIndirectCommand
+
+        std::vector<Wrapper::UniformParameter::Ptr> mParams{};
+        std::vector<CullUniform>                    mCullUniforms{};
+
+        Wrapper::DescriptorSetLayout::Ptr mDescriptorSetLayout{ nullptr };
+        Wrapper::DescriptorPool::Ptr      mDescriptorPool{ nullptr };
+        Wrapper::DescriptorSet::Ptr       mDescriptorSet{ nullptr };
+        Wrapper::ComputePipeline::Ptr     mPipeline{ nullptr };
+    };
+}
@@ -0,0 +1,34 @@
+﻿#include "frameContext.h"
+
+namespace LearnVulkan
+{
+    FrameContext::FrameContext(const Wrapper::Device::Ptr& device, uint32_t index)
+    {
+        mDevice = device;
+        mIndex  = index;
+
+        mCommandPool             = Wrapper::CommandPool::create(device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        mCommandBuffer           = Wrapper::CommandBuffer::create(device, mCommandPool);
+        mImageAvailableSemaphore = Wrapper::Semaphore::create(device);
+
+        // 初始为已触发，第一次 wait 不会阻塞
+        mFence = Wrapper::Fence::create(device);
+    }
+
+    FrameContext::~FrameContext()
+    {
+        // 命令缓冲区先于所属的命令池释放
+        mCommandBuffer.reset();
+        mCommandPool.reset();
+    }
+
+    void FrameContext::wait()
+    {
+        mFence->block();
+    }
+
+    void FrameContext::resetCommands()
+    {
+        mCommandPool->reset();
+    }
+}
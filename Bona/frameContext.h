@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "vulkanWrapper/device.h"
+#include "vulkanWrapper/commandPool.h"
+#include "vulkanWrapper/commandBuffer.h"
+#include "vulkanWrapper/semaphore.h"
+#include "vulkanWrapper/fence.h"
+
+namespace LearnVulkan
+{
+    // 一帧在途（frame in flight）期间归这一帧独占的资源。Application 持有 N 个，按环形轮流使用，
+    // 帧 i 的 CPU 工作只需等待 N 帧之前使用同一个上下文的 GPU 工作完成，因此 CPU 准备第 i+1 帧时 GPU 可以仍在执行第 i 帧。
+    //   - 命令池和命令缓冲区：每帧在 wait 之后重置命令池、重新录制唯一的主命令缓冲区，可见性、LOD 等随时变化而无需重建；
+    //     命令池带 TRANSIENT 标志（缓冲区寿命只有一帧），整池重置，不逐个释放 / 分配，也不需要 RESET_COMMAND_BUFFER 标志
+    //   - 常量 / 描述符：mIndex 即 UniformRingBuffer 的分段、动态偏移、UniformManager 和 ClusterCuller 描述符集的下标；
+    //     流送贴图的替换在 wait 之后只改写本帧的描述符集，不需要等待其他帧
+    //   - 同步对象：获取交换链图像的信号量和提交时的栅栏；渲染完成信号量跟随交换链图像，由 Application 持有
+    class FrameContext
+    {
+    public:
+        using Ptr = std::shared_ptr<FrameContext>;
+
+        static Ptr create(const Wrapper::Device::Ptr& device, uint32_t index)
+        {
+            return std::make_shared<FrameContext>(device, index);
+        }
+
+        FrameContext(const Wrapper::Device::Ptr& device, uint32_t index);
+
+        ~FrameContext();
+
+        /// 等待本上下文上一次提交的 GPU 工作完成，之后才能改写本帧的常量、间接参数和命令缓冲区
+        void wait();
+
+        /// 重置命令池，命令缓冲区回到初始状态等待本帧重新录制；必须在 wait 之后调用
+        void resetCommands();
+
+        [[nodiscard]] auto getIndex()                  const { return mIndex; }
+        [[nodiscard]] auto getCommandPool()            const { return mCommandPool; }
+        [[nodiscard]] auto getCommandBuffer()          const { return mCommandBuffer; }
+        [[nodiscard]] auto getImageAvailableSemaphore() const { return mImageAvailableSemaphore; }
+        [[nodiscard]] auto getFence()                  const { return mFence; }
+
+    private:
+        Wrapper::Device::Ptr mDevice{ nullptr };
+        uint32_t             mIndex{ 0 };
+
+        Wrapper::CommandPool::Ptr   mCommandPool{ nullptr };
+        Wrapper::CommandBuffer::Ptr mCommandBuffer{ nullptr };
+
+        Wrapper::Semaphore::Ptr mImageAvailableSemaphore{ nullptr };
+        Wrapper::Fence::Ptr     mFence{ nullptr };
+    };
+}
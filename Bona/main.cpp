@@ -1,10 +1,46 @@
 ﻿#include <iostream>
+#include <cstring>
+#include <cstdlib>
 #include "application.h"
 
-int main()
+int main(int argc, char** argv)
 {
     LearnVulkan::Application app;
 
+    for (int i = 1; i < argc; ++i)
+    {
+        // 串行解码贴图，与默认的并行解码对比首帧耗时
+        if (std::strcmp(argv[i], "--serial-texture-decode") == 0)
+        {
+            app.setTextureDecodeThreads(1);
+        }
+        // 在途帧数，默认 2
+        else if (std::strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+        {
+            app.setFramesInFlight(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        }
+        // 深度预渲染 + EQUAL 深度测试的颜色 Pass
+        else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+        {
+            app.setDepthPrepass(true);
+        }
+        // 绘制的物体数（模型副本排成网格），默认 1
+        else if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+        {
+            app.setObjectCount(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        }
+        // 录制绘制的线程数，0 为按硬件线程数，1 为主线程内联录制
+        else if (std::strcmp(argv[i], "--record-threads") == 0 && i + 1 < argc)
+        {
+            app.setRecordThreads(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        }
+        // 流送贴图的显存预算（MB），0 为不流送
+        else if (std::strcmp(argv[i], "--texture-budget-mb") == 0 && i + 1 < argc)
+        {
+            app.setTextureBudget(static_cast<VkDeviceSize>(std::strtoull(argv[++i], nullptr, 10)) * 1024 * 1024);
+        }
+    }
+
     try
     {
         app.run();
@@ -0,0 +1,129 @@
+﻿#include "mappedFile.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LearnVulkan
+{
+    MappedFile::Ptr MappedFile::open(const std::string& path)
+    {
+        auto file = std::make_shared<MappedFile>();
+
+#ifdef _WIN32
+        HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+        file->mFileHandle = fileHandle;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+        {
+            return nullptr;
+        }
+
+        HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr)
+        {
+            return nullptr;
+        }
+        file->mMappingHandle = mappingHandle;
+
+        void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            return nullptr;
+        }
+
+        file->mData = static_cast<const uint8_t*>(data);
+        file->mSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+
+        struct stat fileStat {};
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            ::close(fd);
+            return nullptr;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // 映射建立后文件描述符即可关闭
+
+        if (data == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        file->mData = static_cast<const uint8_t*>(data);
+        file->mSize = static_cast<size_t>(fileStat.st_size);
+#endif
+
+        return file;
+    }
+
+    MappedFile::~MappedFile()
+    {
+#ifdef _WIN32
+        if (mData != nullptr)
+        {
+            UnmapViewOfFile(mData);
+        }
+
+        if (mMappingHandle != nullptr)
+        {
+            CloseHandle(static_cast<HANDLE>(mMappingHandle));
+        }
+
+        if (mFileHandle != nullptr)
+        {
+            CloseHandle(static_cast<HANDLE>(mFileHandle));
+        }
+#else
+        if (mData != nullptr)
+        {
+            munmap(const_cast<uint8_t*>(mData), mSize);
+        }
+#endif
+    }
+
+    uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+    {
+        constexpr uint64_t prime = 0x100000001b3ull;
+
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t    hash  = seed;
+
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof(word));
+
+            hash = (hash ^ word) * prime;
+            hash ^= hash >> 29;
+        }
+
+        for (; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * prime;
+        }
+
+        return hash ^ (hash >> 32);
+    }
+}
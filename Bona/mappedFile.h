@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // 只读内存映射文件（Windows: CreateFileMapping / POSIX: mmap），析构时自动解除映射
+    class MappedFile
+    {
+    public:
+        using Ptr = std::shared_ptr<MappedFile>;
+
+        /// 映射失败（文件不存在、为空等）时返回 nullptr，不抛异常，方便作为缓存探测使用
+        static Ptr open(const std::string& path);
+
+        MappedFile() = default;
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] const uint8_t* getData() const { return mData; }
+        [[nodiscard]] size_t         getSize() const { return mSize; }
+
+    private:
+        const uint8_t* mData{ nullptr };
+        size_t         mSize{ 0 };
+
+#ifdef _WIN32
+        void* mFileHandle{ nullptr };
+        void* mMappingHandle{ nullptr };
+#endif
+    };
+
+    /// 64 位非加密哈希（按 8 字节分块的 FNV-1a 变体），用于内容变化检测
+    uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+}
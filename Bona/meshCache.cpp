@@ -0,0 +1,171 @@
+﻿#include "meshCache.h"
+
+#include <filesystem>
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        constexpr uint64_t alignOffset(uint64_t offset)
+        {
+            return (offset + 15) & ~uint64_t(15);
+        }
+
+        const MeshCacheSectionEntry* getSectionEntries(const MappedFile::Ptr& file)
+        {
+            return reinterpret_cast<const MeshCacheSectionEntry*>(file->getData() + sizeof(MeshCacheHeader));
+        }
+    }
+
+    std::string MeshCache::getCachePath(const std::string& sourcePath)
+    {
+        return sourcePath + ".meshcache";
+    }
+
+    bool MeshCache::makeKey(const std::string& sourcePath, uint32_t flags, MeshCacheKey& key)
+    {
+        auto source = MappedFile::open(sourcePath);
+        if (!source)
+        {
+            return false;
+        }
+
+        key.mPathHash    = hashBytes(sourcePath.data(), sourcePath.size());
+        key.mContentHash = hashBytes(source->getData(), source->getSize());
+        key.mFlags       = flags;
+
+        return true;
+    }
+
+    MeshCache::Ptr MeshCache::open(const std::string& cachePath, const MeshCacheKey& key)
+    {
+        auto file = MappedFile::open(cachePath);
+        if (!file || file->getSize() < sizeof(MeshCacheHeader))
+        {
+            return nullptr;
+        }
+
+        const auto* header = reinterpret_cast<const MeshCacheHeader*>(file->getData());
+
+        if (header->mMagic       != Magic            ||
+            header->mVersion     != Version          ||
+            header->mPathHash    != key.mPathHash    ||
+            header->mContentHash != key.mContentHash ||
+            header->mFlags       != key.mFlags)
+        {
+            return nullptr;
+        }
+
+        // 段表和各数据段必须完整落在文件内（防止截断的缓存文件导致越界读取）
+        const uint64_t fileSize = file->getSize();
+        auto inRange = [fileSize](uint64_t offset, uint64_t size)
+        {
+            return offset <= fileSize && size <= fileSize - offset;
+        };
+
+        if (!inRange(sizeof(MeshCacheHeader), uint64_t(header->mSectionCount) * sizeof(MeshCacheSectionEntry)))
+        {
+            return nullptr;
+        }
+
+        const auto* entries = getSectionEntries(file);
+
+        for (uint32_t i = 0; i < header->mSectionCount; ++i)
+        {
+            if (entries[i].mOffset % 16 != 0 || !inRange(entries[i].mOffset, entries[i].mSize))
+            {
+                return nullptr;
+            }
+        }
+
+        return std::make_shared<MeshCache>(file);
+    }
+
+    bool MeshCache::write(const std::string& cachePath, const MeshCacheKey& key, const std::vector<MeshCacheSection>& sections)
+    {
+        MeshCacheHeader header{};
+        header.mMagic        = Magic;
+        header.mVersion      = Version;
+        header.mPathHash     = key.mPathHash;
+        header.mContentHash  = key.mContentHash;
+        header.mFlags        = key.mFlags;
+        header.mSectionCount = static_cast<uint32_t>(sections.size());
+
+        std::vector<MeshCacheSectionEntry> entries(sections.size());
+        uint64_t offset = sizeof(MeshCacheHeader) + entries.size() * sizeof(MeshCacheSectionEntry);
+
+        for (size_t i = 0; i < sections.size(); ++i)
+        {
+            offset = alignOffset(offset);
+
+            entries[i].mId     = sections[i].mId;
+            entries[i].mOffset = offset;
+            entries[i].mSize   = sections[i].mSize;
+
+            offset += sections[i].mSize;
+        }
+
+        const std::string tempPath = cachePath + ".tmp";
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                std::cout << "Warning: cannot write mesh cache " << cachePath << std::endl;
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(MeshCacheSectionEntry)));
+
+            for (size_t i = 0; i < sections.size(); ++i)
+            {
+                static const char padding[16]{};
+
+                const uint64_t position = static_cast<uint64_t>(file.tellp());
+                file.write(padding, static_cast<std::streamsize>(entries[i].mOffset - position));
+                file.write(static_cast<const char*>(sections[i].mData), static_cast<std::streamsize>(sections[i].mSize));
+            }
+
+            if (!file)
+            {
+                std::cout << "Warning: cannot write mesh cache " << cachePath << std::endl;
+                return false;
+            }
+        }
+
+        // 写完整后再替换，避免另一个进程映射到写了一半的文件
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+
+        if (error)
+        {
+            std::cout << "Warning: cannot write mesh cache " << cachePath << ": " << error.message() << std::endl;
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    MeshCache::MeshCache(const MappedFile::Ptr& file)
+    {
+        mFile = file;
+    }
+
+    MeshCacheSection MeshCache::getSection(uint32_t id) const
+    {
+        const auto* header  = reinterpret_cast<const MeshCacheHeader*>(mFile->getData());
+        const auto* entries = getSectionEntries(mFile);
+
+        for (uint32_t i = 0; i < header->mSectionCount; ++i)
+        {
+            if (entries[i].mId == id)
+            {
+                return { id, mFile->getData() + entries[i].mOffset, entries[i].mSize };
+            }
+        }
+
+        return { id, nullptr, 0 };
+    }
+}
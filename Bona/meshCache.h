@@ -0,0 +1,75 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "mappedFile.h"
+
+namespace LearnVulkan
+{
+    // 缓存文件头：小端存储，后面紧跟 mSectionCount 个 MeshCacheSectionEntry；
+    // 各数据段相对文件起始偏移且按 16 字节对齐，映射后可直接按指针读取
+    struct MeshCacheHeader
+    {
+        uint32_t mMagic{ 0 };
+        uint32_t mVersion{ 0 };
+        uint64_t mPathHash{ 0 };      // 源文件路径哈希
+        uint64_t mContentHash{ 0 };   // 源文件内容哈希
+        uint32_t mFlags{ 0 };         // 导入选项（由使用方定义）
+        uint32_t mSectionCount{ 0 };
+    };
+
+    struct MeshCacheSectionEntry
+    {
+        uint32_t mId{ 0 };
+        uint32_t mReserved{ 0 };
+        uint64_t mOffset{ 0 };
+        uint64_t mSize{ 0 };
+    };
+
+    // 缓存键：路径 + 内容 + 导入选项，任一不同即视为失效
+    struct MeshCacheKey
+    {
+        uint64_t mPathHash{ 0 };
+        uint64_t mContentHash{ 0 };
+        uint32_t mFlags{ 0 };
+    };
+
+    // 一段待写入或已映射的数据
+    struct MeshCacheSection
+    {
+        uint32_t    mId{ 0 };
+        const void* mData{ nullptr };
+        uint64_t    mSize{ 0 };
+    };
+
+    // 与 .obj 同目录的二进制网格缓存（<源文件>.meshcache），命中时以只读映射方式访问。
+    // 文件本身只是按 id 存放的若干数据段，具体段的含义由使用方定义（Model；Texture 也用同样的格式存放块压缩结果）
+    class MeshCache
+    {
+    public:
+        using Ptr = std::shared_ptr<MeshCache>;
+
+        static constexpr uint32_t Magic   = 0x48534D42;  // "BMSH"
+        static constexpr uint32_t Version = 2;           // 文件格式或导入流程变化时递增，旧缓存自动失效
+
+        static std::string getCachePath(const std::string& sourcePath);
+
+        /// 映射并哈希源文件生成缓存键，源文件不可读时返回 false
+        static bool makeKey(const std::string& sourcePath, uint32_t flags, MeshCacheKey& key);
+
+        /// 映射缓存文件并校验版本、键和数据段范围，未命中或已失效时返回 nullptr
+        static Ptr open(const std::string& cachePath, const MeshCacheKey& key);
+
+        /// 写入缓存（先写临时文件再替换），失败只打印警告，不影响正常加载
+        static bool write(const std::string& cachePath, const MeshCacheKey& key, const std::vector<MeshCacheSection>& sections);
+
+        MeshCache(const MappedFile::Ptr& file);
+
+        ~MeshCache() = default;
+
+        /// 按 id 查找数据段，不存在时 mData 为 nullptr
+        [[nodiscard]] MeshCacheSection getSection(uint32_t id) const;
+
+    private:
+        MappedFile::Ptr mFile{ nullptr };
+    };
+}
@@ -0,0 +1,383 @@
+﻿#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace LearnVulkan
+{
+    VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices,
+                                                       size_t vertexCount,
+                                                       uint32_t cacheSize)
+    {
+        VertexCacheStats stats{};
+
+        if (indices.empty() || vertexCount == 0)
+        {
+            return stats;
+        }
+
+        // 每个顶点记录最近一次进入缓存的时间戳，时间差小于缓存大小即命中
+        std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+        uint32_t timestamp = cacheSize + 1;
+        size_t   misses    = 0;
+
+        for (auto index : indices)
+        {
+            if (timestamp - cacheTimestamps[index] > cacheSize)
+            {
+                cacheTimestamps[index] = timestamp++;
+                ++misses;
+            }
+        }
+
+        stats.mACMR = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+        stats.mATVR = static_cast<float>(misses) / static_cast<float>(vertexCount);
+
+        return stats;
+    }
+
+    void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices,
+                                            size_t vertexCount,
+                                            uint32_t cacheSize,
+                                            std::vector<uint32_t>& clusters)
+    {
+        clusters.clear();
+
+        const size_t triangleCount = indices.size() / 3;
+
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        // 步骤1：建立 顶点 -> 三角形 的邻接表（CSR 形式）
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (auto index : indices)
+        {
+            ++liveTriangles[index];
+        }
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+        }
+
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        // 步骤2：Tipsify 主循环
+        std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+        std::vector<bool>     emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds{};
+        std::vector<uint32_t> candidates{};
+        std::vector<uint32_t> output{};
+        output.reserve(indices.size());
+
+        uint32_t timestamp   = cacheSize + 1;
+        size_t   inputCursor = 0;
+
+        // 死胡同时的回退策略：先找最近输出过、还有未输出三角形的顶点，否则按输入顺序找下一个
+        auto skipDeadEnd = [&](bool& hardBoundary) -> int64_t
+        {
+            while (!deadEnds.empty())
+            {
+                uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+
+                if (liveTriangles[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+
+            hardBoundary = true;
+
+            while (inputCursor < vertexCount)
+            {
+                if (liveTriangles[inputCursor] > 0)
+                {
+                    return static_cast<int64_t>(inputCursor);
+                }
+
+                ++inputCursor;
+            }
+
+            return -1;
+        };
+
+        bool    hardBoundary = true;
+        int64_t fanVertex    = skipDeadEnd(hardBoundary);
+
+        while (fanVertex >= 0)
+        {
+            if (hardBoundary)
+            {
+                clusters.push_back(static_cast<uint32_t>(output.size() / 3));
+                hardBoundary = false;
+            }
+
+            candidates.clear();
+
+            // 输出 fanVertex 周围所有尚未输出的三角形
+            for (uint32_t a = adjacencyOffsets[fanVertex]; a < adjacencyOffsets[fanVertex + 1]; ++a)
+            {
+                uint32_t triangle = adjacency[a];
+
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    uint32_t vertex = indices[triangle * 3 + k];
+
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+
+                    --liveTriangles[vertex];
+
+                    if (timestamp - cacheTimestamps[vertex] > cacheSize)
+                    {
+                        cacheTimestamps[vertex] = timestamp++;
+                    }
+                }
+
+                emitted[triangle] = true;
+            }
+
+            // 选下一个扇心：优先选择扇出后仍在缓存中、且在缓存中最久的顶点；都不满足时走死胡同回退
+            int64_t  nextVertex = -1;
+            uint32_t bestScore  = 0;
+
+            for (auto vertex : candidates)
+            {
+                if (liveTriangles[vertex] == 0)
+                {
+                    continue;
+                }
+
+                uint32_t score = 0;
+                if (timestamp - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+                {
+                    score = timestamp - cacheTimestamps[vertex];
+                }
+
+                if (score > bestScore)
+                {
+                    bestScore  = score;
+                    nextVertex = vertex;
+                }
+            }
+
+            if (nextVertex < 0)
+            {
+                nextVertex = skipDeadEnd(hardBoundary);
+            }
+
+            fanVertex = nextVertex;
+        }
+
+        indices.swap(output);
+    }
+
+    std::vector<uint32_t> MeshOptimizer::splitSoftBoundaries(const std::vector<uint32_t>& indices,
+                                                             size_t vertexCount,
+                                                             const std::vector<uint32_t>& hardClusters,
+                                                             uint32_t cacheSize,
+                                                             float threshold)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        std::vector<uint32_t> clusters{};
+        std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+        uint32_t timestamp = cacheSize + 1;
+
+        for (size_t c = 0; c < hardClusters.size(); ++c)
+        {
+            size_t begin = hardClusters[c];
+            size_t end   = (c + 1 < hardClusters.size()) ? hardClusters[c + 1] : triangleCount;
+
+            // 步骤1：整个硬边界簇的 ACMR
+            timestamp += cacheSize + 1;
+            size_t clusterMisses = 0;
+            for (size_t i = begin * 3; i < end * 3; ++i)
+            {
+                if (timestamp - cacheTimestamps[indices[i]] > cacheSize)
+                {
+                    cacheTimestamps[indices[i]] = timestamp++;
+                    ++clusterMisses;
+                }
+            }
+
+            const float clusterACMR = static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+            // 步骤2：从冷缓存重新模拟，局部 ACMR 回落到阈值以内时即可切出一个软边界（切分后缓存代价几乎不变）
+            clusters.push_back(static_cast<uint32_t>(begin));
+
+            timestamp += cacheSize + 1;
+            size_t subBegin  = begin;
+            size_t subMisses = 0;
+
+            for (size_t t = begin; t < end; ++t)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    uint32_t vertex = indices[t * 3 + k];
+                    if (timestamp - cacheTimestamps[vertex] > cacheSize)
+                    {
+                        cacheTimestamps[vertex] = timestamp++;
+                        ++subMisses;
+                    }
+                }
+
+                const size_t subTriangles = t + 1 - subBegin;
+
+                if (t + 1 < end && subTriangles >= cacheSize &&
+                    static_cast<float>(subMisses) / static_cast<float>(subTriangles) <= threshold * clusterACMR)
+                {
+                    clusters.push_back(static_cast<uint32_t>(t + 1));
+
+                    timestamp += cacheSize + 1;
+                    subBegin  = t + 1;
+                    subMisses = 0;
+                }
+            }
+        }
+
+        return clusters;
+    }
+
+    void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices,
+                                         const std::vector<float>& positions,
+                                         const std::vector<uint32_t>& clusters)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        if (clusters.size() <= 1 || triangleCount == 0)
+        {
+            return;
+        }
+
+        auto position = [&](uint32_t vertex)
+        {
+            return glm::vec3(positions[vertex * 3 + 0], positions[vertex * 3 + 1], positions[vertex * 3 + 2]);
+        };
+
+        // 步骤1：网格整体（面积加权）质心
+        glm::vec3 meshCentroid(0.0f);
+        float     meshArea = 0.0f;
+
+        std::vector<glm::vec3> clusterCentroids(clusters.size(), glm::vec3(0.0f));
+        std::vector<glm::vec3> clusterNormals(clusters.size(), glm::vec3(0.0f));
+        std::vector<float>     clusterAreas(clusters.size(), 0.0f);
+
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            size_t begin = clusters[c];
+            size_t end   = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+
+            for (size_t t = begin; t < end; ++t)
+            {
+                glm::vec3 p0 = position(indices[t * 3 + 0]);
+                glm::vec3 p1 = position(indices[t * 3 + 1]);
+                glm::vec3 p2 = position(indices[t * 3 + 2]);
+
+                glm::vec3 normal   = glm::cross(p1 - p0, p2 - p0);  // 长度 = 2 * 面积
+                float     area     = glm::length(normal) * 0.5f;
+                glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+                clusterCentroids[c] += centroid * area;
+                clusterNormals[c]   += normal;
+                clusterAreas[c]     += area;
+            }
+
+            meshCentroid += clusterCentroids[c];
+            meshArea     += clusterAreas[c];
+        }
+
+        if (meshArea > 0.0f)
+        {
+            meshCentroid /= meshArea;
+        }
+
+        // 步骤2：排序键 = dot(簇质心 - 网格质心, 簇法线)，越大说明越"朝外"，应先绘制以遮挡内侧
+        std::vector<float> sortKeys(clusters.size(), 0.0f);
+        for (size_t c = 0; c < clusters.size(); ++c)
+        {
+            glm::vec3 centroid = clusterAreas[c] > 0.0f ? clusterCentroids[c] / clusterAreas[c] : meshCentroid;
+            glm::vec3 normal   = glm::length(clusterNormals[c]) > 0.0f ? glm::normalize(clusterNormals[c]) : glm::vec3(0.0f);
+
+            sortKeys[c] = glm::dot(centroid - meshCentroid, normal);
+        }
+
+        std::vector<uint32_t> order(clusters.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+        // 步骤3：按簇顺序重新拼接索引
+        std::vector<uint32_t> output{};
+        output.reserve(indices.size());
+
+        for (auto c : order)
+        {
+            size_t begin = clusters[c];
+            size_t end   = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+
+            output.insert(output.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+        }
+
+        indices.swap(output);
+    }
+
+    size_t MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices,
+                                              size_t vertexCount,
+                                              std::vector<uint32_t>& remap)
+    {
+        constexpr uint32_t unused = ~0u;
+
+        remap.assign(vertexCount, unused);
+        uint32_t nextVertex = 0;
+
+        for (auto& index : indices)
+        {
+            if (remap[index] == unused)
+            {
+                remap[index] = nextVertex++;
+            }
+
+            index = remap[index];
+        }
+
+        return nextVertex;
+    }
+
+    void MeshOptimizer::remapVertexStream(std::vector<float>& stream,
+                                          size_t components,
+                                          const std::vector<uint32_t>& remap,
+                                          size_t newVertexCount)
+    {
+        std::vector<float> output(newVertexCount * components);
+
+        for (size_t v = 0; v < remap.size(); ++v)
+        {
+            if (remap[v] == ~0u)
+            {
+                continue;  // 未被任何三角形引用的顶点直接丢弃
+            }
+
+            std::copy_n(stream.begin() + v * components, components, output.begin() + remap[v] * components);
+        }
+
+        stream.swap(output);
+    }
+}
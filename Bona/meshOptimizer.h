@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // 顶点后变换缓存（post-transform vertex cache）统计
+    struct VertexCacheStats
+    {
+        float mACMR{ 0.0f };  // 每个三角形平均变换的顶点数（最优约 0.5，最差 3.0）
+        float mATVR{ 0.0f };  // 变换次数 / 唯一顶点数（最优 1.0）
+    };
+
+    // 离线网格优化：顶点缓存重排（Tipsify）-> 过度绘制排序 -> 顶点获取顺序重映射
+    class MeshOptimizer
+    {
+    public:
+        // 模拟 FIFO 顶点缓存，统计 ACMR / ATVR
+        static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices,
+                                                   size_t vertexCount,
+                                                   uint32_t cacheSize = 16);
+
+        // Tipsify 顶点缓存优化（Sander et al. 2007），原地重排三角形顺序；
+        // clusters 输出每个硬边界簇的起始三角形序号，供过度绘制排序使用
+        static void optimizeVertexCache(std::vector<uint32_t>& indices,
+                                        size_t vertexCount,
+                                        uint32_t cacheSize,
+                                        std::vector<uint32_t>& clusters);
+
+        // 在硬边界簇内部继续切分软边界：局部 ACMR 不超过 threshold * 簇 ACMR 的位置都可以切开，
+        // 簇越小过度绘制排序越有效，而顶点缓存效率基本不受影响
+        static std::vector<uint32_t> splitSoftBoundaries(const std::vector<uint32_t>& indices,
+                                                         size_t vertexCount,
+                                                         const std::vector<uint32_t>& hardClusters,
+                                                         uint32_t cacheSize,
+                                                         float threshold = 1.05f);
+
+        // 按簇朝外程度排序（越靠外、越朝外的簇越先画），以减少过度绘制；簇内顺序保持不变
+        static void optimizeOverdraw(std::vector<uint32_t>& indices,
+                                     const std::vector<float>& positions,
+                                     const std::vector<uint32_t>& clusters);
+
+        // 按索引首次出现顺序生成顶点重映射表 remap[旧顶点] = 新顶点，并原地改写索引；
+        // 返回实际被引用的顶点数量
+        static size_t optimizeVertexFetch(std::vector<uint32_t>& indices,
+                                          size_t vertexCount,
+                                          std::vector<uint32_t>& remap);
+
+        // 按重映射表重排一个顶点属性数组（components 为每个顶点的分量数）
+        static void remapVertexStream(std::vector<float>& stream,
+                                      size_t components,
+                                      const std::vector<uint32_t>& remap,
+                                      size_t newVertexCount);
+    };
+}
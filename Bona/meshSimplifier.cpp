@@ -0,0 +1,378 @@
+﻿#include "meshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        // 对称 4x4 二次型的 10 个分量，按面积加权累加；mWeight 用来把误差归一化成距离平方
+        struct Quadric
+        {
+            double a00{ 0 }, a01{ 0 }, a02{ 0 }, a11{ 0 }, a12{ 0 }, a22{ 0 };
+            double b0{ 0 }, b1{ 0 }, b2{ 0 }, c{ 0 };
+            double mWeight{ 0 };
+
+            void addPlane(const glm::dvec3& n, double d, double weight)
+            {
+                a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+                a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+                b0  += weight * n.x * d;   b1  += weight * n.y * d;   b2  += weight * n.z * d;
+                c   += weight * d * d;
+                mWeight += weight;
+            }
+
+            void add(const Quadric& q)
+            {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+                b0  += q.b0;  b1  += q.b1;  b2  += q.b2;  c   += q.c;
+                mWeight += q.mWeight;
+            }
+
+            // 点到各平面距离平方的加权平均
+            double evaluate(const glm::dvec3& p) const
+            {
+                const double error = a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z
+                                   + a11 * p.y * p.y + 2.0 * a12 * p.y * p.z + a22 * p.z * p.z
+                                   + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+
+                return mWeight > 0.0 ? std::max(error, 0.0) / mWeight : 0.0;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t mFrom{ 0 };
+            uint32_t mTo{ 0 };
+            double   mError{ 0 };
+        };
+
+        uint64_t edgeKey(uint32_t a, uint32_t b)
+        {
+            return (uint64_t(a) << 32) | b;
+        }
+    }
+
+    std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<uint32_t>& indices,
+                                                   const std::vector<float>& positions,
+                                                   size_t targetIndexCount,
+                                                   float maxError,
+                                                   float& outError)
+    {
+        outError = 0.0f;
+
+        std::vector<uint32_t> result(indices.begin(), indices.end() - indices.size() % 3);
+
+        const size_t vertexCount = positions.size() / 3;
+
+        if (result.size() <= targetIndexCount || vertexCount == 0)
+        {
+            return result;
+        }
+
+        auto position = [&](uint32_t v)
+        {
+            return glm::dvec3(positions[v * 3 + 0], positions[v * 3 + 1], positions[v * 3 + 2]);
+        };
+
+        // 步骤1：按位置合并顶点（UV 不同的顶点在导入时被拆开），合并后多于一个顶点的位置就是接缝
+        std::vector<uint32_t> positionId(vertexCount, 0);
+        std::vector<uint32_t> positionUsers{};
+        {
+            struct PositionHash
+            {
+                size_t operator()(const glm::uvec3& p) const
+                {
+                    return (size_t(p.x) * 73856093u) ^ (size_t(p.y) * 19349663u) ^ (size_t(p.z) * 83492791u);
+                }
+            };
+
+            std::unordered_map<glm::uvec3, uint32_t, PositionHash> unique{};
+            unique.reserve(vertexCount);
+
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                glm::uvec3 bits;
+                memcpy(&bits, &positions[v * 3], sizeof(bits));
+
+                auto [it, inserted] = unique.try_emplace(bits, static_cast<uint32_t>(positionUsers.size()));
+                if (inserted)
+                {
+                    positionUsers.push_back(0);
+                }
+
+                positionId[v] = it->second;
+                ++positionUsers[it->second];
+            }
+        }
+
+        std::vector<uint8_t> locked(vertexCount, 0);
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            locked[v] = positionUsers[positionId[v]] > 1 ? 1 : 0;
+        }
+
+        // 步骤2：在合并后的位置上找开放边界（有向边没有反向边），边界顶点同样锁定
+        {
+            std::unordered_map<uint64_t, uint32_t> edges{};
+            edges.reserve(result.size());
+
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    ++edges[edgeKey(positionId[result[i + k]], positionId[result[i + (k + 1) % 3]])];
+                }
+            }
+
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32_t a = result[i + k];
+                    const uint32_t b = result[i + (k + 1) % 3];
+
+                    if (edges.find(edgeKey(positionId[b], positionId[a])) == edges.end())
+                    {
+                        locked[a] = locked[b] = 1;
+                    }
+                }
+            }
+        }
+
+        // 步骤3：每个顶点累加相邻三角形平面的二次型（按面积加权）
+        std::vector<Quadric> quadrics(vertexCount);
+
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const glm::dvec3 a = position(result[i + 0]);
+            const glm::dvec3 b = position(result[i + 1]);
+            const glm::dvec3 c = position(result[i + 2]);
+
+            glm::dvec3   normal = glm::cross(b - a, c - a);
+            const double area   = glm::length(normal);
+
+            if (area <= 0.0)
+            {
+                continue;
+            }
+
+            normal /= area;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                quadrics[result[i + k]].addPlane(normal, -glm::dot(normal, a), area * 0.5);
+            }
+        }
+
+        const double maxErrorSquared = double(maxError) * double(maxError);
+        double       resultError     = 0.0;
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        std::vector<uint32_t> adjacency{};
+        std::vector<uint8_t>  touched(vertexCount, 0);
+        std::vector<uint8_t>  deadTriangles{};
+        std::vector<Collapse> collapses{};
+
+        // 步骤4：分轮折叠。每轮按误差从小到大执行互不影响的折叠（被改动三角形涉及的顶点本轮不再参与），
+        // 轮末统一改写索引并删除退化三角形，直到达到目标或误差超限
+        while (result.size() > targetIndexCount)
+        {
+            const size_t triangleCount = result.size() / 3;
+
+            // 顶点 -> 三角形 邻接表（CSR）
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+            for (auto index : result)
+            {
+                ++adjacencyOffsets[index + 1];
+            }
+            std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+            adjacency.resize(result.size());
+            {
+                std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (size_t i = 0; i < result.size(); ++i)
+                {
+                    adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            // 候选折叠：每条边的两个方向，起点未锁定即可
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    const uint32_t a = result[i + k];
+                    const uint32_t b = result[i + (k + 1) % 3];
+
+                    for (int direction = 0; direction < 2; ++direction)
+                    {
+                        const uint32_t from = direction == 0 ? a : b;
+                        const uint32_t to   = direction == 0 ? b : a;
+
+                        if (locked[from] || from == to)
+                        {
+                            continue;
+                        }
+
+                        Quadric q = quadrics[from];
+                        q.add(quadrics[to]);
+
+                        collapses.push_back({ from, to, q.evaluate(position(to)) });
+                    }
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.mError < r.mError; });
+
+            if (collapses.empty())
+            {
+                break;
+            }
+
+            // 本轮误差上限：每次折叠约删除 2 个三角形，每条内部边在候选中出现 4 次（两个方向 x 两个三角形）。
+            // 只放行大约够用的最便宜那一批，剩下的留到下一轮用更新后的二次型重新评估，
+            // 否则被跳过的廉价折叠会让同一轮一路执行到全局误差上限
+            const size_t collapseGoal = (triangleCount - targetIndexCount / 3) / 2 + 1;
+            const double passLimit    = collapses[std::min(collapses.size() - 1, collapseGoal * 4)].mError;
+
+            std::fill(touched.begin(), touched.end(), 0);
+            deadTriangles.assign(triangleCount, 0);
+
+            size_t remainingTriangles = triangleCount;
+            size_t collapsed          = 0;
+            bool   errorLimitReached  = false;
+
+            for (const auto& collapse : collapses)
+            {
+                if (remainingTriangles * 3 <= targetIndexCount)
+                {
+                    break;
+                }
+
+                if (collapse.mError > maxErrorSquared)
+                {
+                    errorLimitReached = true;
+                    break;
+                }
+
+                if (collapse.mError > passLimit)
+                {
+                    break;
+                }
+
+                if (touched[collapse.mFrom] || touched[collapse.mTo])
+                {
+                    continue;
+                }
+
+                // 拒绝会让相邻三角形翻面或严重变形的折叠
+                const glm::dvec3 target = position(collapse.mTo);
+                bool             flips  = false;
+                size_t           removes = 0;
+
+                for (uint32_t t = adjacencyOffsets[collapse.mFrom]; t < adjacencyOffsets[collapse.mFrom + 1] && !flips; ++t)
+                {
+                    const uint32_t* triangle = &result[adjacency[t] * 3];
+
+                    if (triangle[0] == collapse.mTo || triangle[1] == collapse.mTo || triangle[2] == collapse.mTo)
+                    {
+                        ++removes;
+                        continue;
+                    }
+
+                    glm::dvec3 before[3];
+                    glm::dvec3 after[3];
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        before[k] = position(triangle[k]);
+                        after[k]  = triangle[k] == collapse.mFrom ? target : before[k];
+                    }
+
+                    const glm::dvec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    const glm::dvec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+                    flips = glm::dot(n0, n1) < 0.25 * glm::length(n0) * glm::length(n1);
+                }
+
+                if (flips)
+                {
+                    continue;
+                }
+
+                // 执行折叠：相邻三角形涉及的顶点本轮都不再参与，保证上面的翻面检查仍然有效
+                for (uint32_t t = adjacencyOffsets[collapse.mFrom]; t < adjacencyOffsets[collapse.mFrom + 1]; ++t)
+                {
+                    uint32_t* triangle = &result[adjacency[t] * 3];
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        touched[triangle[k]] = 1;
+                    }
+
+                    if (triangle[0] == collapse.mTo || triangle[1] == collapse.mTo || triangle[2] == collapse.mTo)
+                    {
+                        deadTriangles[adjacency[t]] = 1;
+                    }
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        triangle[k] = triangle[k] == collapse.mFrom ? collapse.mTo : triangle[k];
+                    }
+                }
+
+                quadrics[collapse.mTo].add(quadrics[collapse.mFrom]);
+
+                remainingTriangles -= removes;
+                resultError = std::max(resultError, collapse.mError);
+                ++collapsed;
+            }
+
+            // 删除退化三角形
+            size_t write = 0;
+            for (size_t t = 0; t < triangleCount; ++t)
+            {
+                if (!deadTriangles[t])
+                {
+                    result[write++] = result[t * 3 + 0];
+                    result[write++] = result[t * 3 + 1];
+                    result[write++] = result[t * 3 + 2];
+                }
+            }
+            result.resize(write);
+
+            if (collapsed == 0 || errorLimitReached)
+            {
+                break;
+            }
+        }
+
+        outError = static_cast<float>(std::sqrt(resultError));
+
+        return result;
+    }
+
+    uint32_t MeshSimplifier::selectLod(const std::vector<LodLevel>& levels, float pixelsPerUnit, float pixelThreshold)
+    {
+        uint32_t selected = 0;
+
+        // 误差随级别单调增加，找到第一个超出阈值的级别即可停止
+        for (uint32_t level = 1; level < levels.size(); ++level)
+        {
+            if (levels[level].mError * pixelsPerUnit > pixelThreshold)
+            {
+                break;
+            }
+
+            selected = level;
+        }
+
+        return selected;
+    }
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // 一级 LOD：合并后的索引缓冲区中的一段，以及生成它时的几何误差；同时作为网格缓存中的一个数据段
+    struct LodLevel
+    {
+        uint32_t mFirstIndex{ 0 };
+        uint32_t mIndexCount{ 0 };
+        uint32_t mFirstMeshlet{ 0 };     // 该级网格簇在网格簇数组中的区间，未启用网格簇时为 0
+        uint32_t mMeshletCount{ 0 };
+        float    mError{ 0.0f };         // 相对原始网格的最大几何误差（模型空间距离），LOD0 为 0
+    };
+
+    // 二次误差度量（QEM，Garland & Heckbert 1997）网格简化。
+    // 只做半边折叠（顶点折叠到相邻的已有顶点上），顶点缓冲区保持不变，简化结果只是一份新的索引列表，
+    // 因此多级 LOD 可以共用同一组顶点流
+    class MeshSimplifier
+    {
+    public:
+        // 把索引列表简化到 targetIndexCount 附近；下一次折叠的误差超过 maxError 时提前停止。
+        // 边界顶点和 UV 接缝上的顶点（同一位置对应多个顶点）保持不动，避免产生裂缝。
+        // outError 返回所有已执行折叠的最大误差（模型空间距离），供按屏幕空间误差选择 LOD
+        static std::vector<uint32_t> simplify(const std::vector<uint32_t>& indices,
+                                              const std::vector<float>& positions,
+                                              size_t targetIndexCount,
+                                              float maxError,
+                                              float& outError);
+
+        // 选择投影误差不超过 pixelThreshold 像素的最粗一级。
+        // pixelsPerUnit 为物体所在距离上单位模型空间长度对应的屏幕像素数（已包含模型缩放）
+        static uint32_t selectLod(const std::vector<LodLevel>& levels, float pixelsPerUnit, float pixelThreshold);
+    };
+}
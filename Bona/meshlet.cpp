@@ -0,0 +1,156 @@
+﻿#include "meshlet.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace LearnVulkan
+{
+    std::vector<Meshlet> MeshletBuilder::build(const std::vector<uint32_t>& indices,
+                                               const std::vector<float>& positions,
+                                               uint32_t maxVertices,
+                                               uint32_t maxTriangles)
+    {
+        std::vector<Meshlet> meshlets{};
+
+        const size_t vertexCount   = positions.size() / 3;
+        const size_t triangleCount = indices.size() / 3;
+
+        if (triangleCount == 0)
+        {
+            return meshlets;
+        }
+
+        // 每个顶点记录最后一次被加入的簇编号，用来判断顶点是否已在当前簇中
+        std::vector<uint32_t> vertexMeshlet(vertexCount, std::numeric_limits<uint32_t>::max());
+
+        Meshlet current{};
+
+        auto flush = [&]()
+        {
+            const uint32_t nextFirstIndex = current.mFirstIndex + current.mIndexCount;
+
+            if (current.mIndexCount > 0)
+            {
+                computeBounds(current, indices, positions);
+                meshlets.push_back(current);
+            }
+
+            current = Meshlet{};
+            current.mFirstIndex = nextFirstIndex;
+        };
+
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            const uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+            const uint32_t* corners  = &indices[triangle * 3];
+
+            uint32_t newVertices = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                // 同一三角形内重复的顶点只算一次
+                const bool repeated = (k > 0 && corners[k] == corners[0]) || (k > 1 && corners[k] == corners[1]);
+                newVertices += (vertexMeshlet[corners[k]] != meshletId && !repeated) ? 1 : 0;
+            }
+
+            if (current.mVertexCount + newVertices > maxVertices || current.mIndexCount / 3 + 1 > maxTriangles)
+            {
+                flush();
+            }
+
+            const uint32_t currentId = static_cast<uint32_t>(meshlets.size());
+
+            for (int k = 0; k < 3; ++k)
+            {
+                if (vertexMeshlet[corners[k]] != currentId)
+                {
+                    vertexMeshlet[corners[k]] = currentId;
+                    ++current.mVertexCount;
+                }
+            }
+
+            current.mIndexCount += 3;
+        }
+
+        flush();
+
+        return meshlets;
+    }
+
+    void MeshletBuilder::computeBounds(Meshlet& meshlet,
+                                       const std::vector<uint32_t>& indices,
+                                       const std::vector<float>& positions)
+    {
+        auto position = [&](uint32_t index)
+        {
+            return glm::vec3(positions[index * 3 + 0], positions[index * 3 + 1], positions[index * 3 + 2]);
+        };
+
+        const uint32_t first = meshlet.mFirstIndex;
+        const uint32_t last  = meshlet.mFirstIndex + meshlet.mIndexCount;
+
+        // 步骤1：包围球，球心取包围盒中心，半径取到最远顶点的距离
+        glm::vec3 minPosition(std::numeric_limits<float>::max());
+        glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+
+        for (uint32_t i = first; i < last; ++i)
+        {
+            minPosition = glm::min(minPosition, position(indices[i]));
+            maxPosition = glm::max(maxPosition, position(indices[i]));
+        }
+
+        const glm::vec3 center = (minPosition + maxPosition) * 0.5f;
+        float radius = 0.0f;
+
+        for (uint32_t i = first; i < last; ++i)
+        {
+            radius = std::max(radius, glm::length(position(indices[i]) - center));
+        }
+
+        meshlet.mSphere = glm::vec4(center, radius);
+
+        // 步骤2：法线锥，轴取各三角形单位法线的平均方向，cutoff = sin(最大偏离角)。
+        // 剔除条件（着色器中）：dot(center - camera, axis) >= cutoff * |center - camera| + radius
+        std::vector<glm::vec3> normals{};
+        normals.reserve(meshlet.mIndexCount / 3);
+
+        glm::vec3 axis(0.0f);
+
+        for (uint32_t i = first; i + 2 < last; i += 3)
+        {
+            const glm::vec3 a = position(indices[i + 0]);
+            const glm::vec3 b = position(indices[i + 1]);
+            const glm::vec3 c = position(indices[i + 2]);
+
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float     area   = glm::length(normal);
+
+            // 退化三角形没有朝向，不参与
+            if (area > 0.0f)
+            {
+                normals.push_back(normal / area);
+                axis += normals.back();
+            }
+        }
+
+        const float axisLength = glm::length(axis);
+
+        if (normals.empty() || axisLength <= 0.0f)
+        {
+            meshlet.mCone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            return;
+        }
+
+        axis /= axisLength;
+
+        float minDot = 1.0f;
+        for (const auto& normal : normals)
+        {
+            minDot = std::min(minDot, glm::dot(normal, axis));
+        }
+
+        // 法线散布超过约 84 度时锥体几乎不可能整体背向相机，直接关闭该簇的背面剔除
+        const float cutoff = minDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+
+        meshlet.mCone = glm::vec4(axis, cutoff);
+    }
+}
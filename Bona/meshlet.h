@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+
+namespace LearnVulkan
+{
+    // 一个网格簇（meshlet）：索引缓冲区中连续的一段三角形，布局与 MeshletCull.comp 中的 std430 结构一致
+    struct Meshlet
+    {
+        glm::vec4 mSphere{ 0.0f };      // xyz 包围球球心，w 半径（模型空间）
+        glm::vec4 mCone{ 0.0f };        // xyz 法线锥轴，w 锥体 cutoff；cutoff 为 1 时不做背面剔除
+        uint32_t  mFirstIndex{ 0 };
+        uint32_t  mIndexCount{ 0 };
+        uint32_t  mVertexCount{ 0 };    // 簇内唯一顶点数，仅用于统计
+        uint32_t  mReserved{ 0 };
+    };
+
+    // 把索引缓冲区切分成网格簇，并计算簇的包围球和法线锥，供 GPU 做簇级视锥 / 背面剔除
+    class MeshletBuilder
+    {
+    public:
+        static constexpr uint32_t DefaultMaxVertices  = 64;
+        static constexpr uint32_t DefaultMaxTriangles = 124;
+
+        // 按现有三角形顺序贪心切分：加入下一个三角形会超出顶点或三角形上限时开始新簇。
+        // 索引顺序不变，每个簇对应索引缓冲区中连续的一段，因此应在顶点缓存优化之后调用
+        static std::vector<Meshlet> build(const std::vector<uint32_t>& indices,
+                                          const std::vector<float>& positions,
+                                          uint32_t maxVertices  = DefaultMaxVertices,
+                                          uint32_t maxTriangles = DefaultMaxTriangles);
+
+        // 计算一段三角形的包围球和法线锥（写入 mSphere / mCone）
+        static void computeBounds(Meshlet& meshlet,
+                                  const std::vector<uint32_t>& indices,
+                                  const std::vector<float>& positions);
+    };
+}
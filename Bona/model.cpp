@@ -1,40 +1,704 @@
-#include "model.h"
+﻿#include "model.h"
+#include "objParser.h"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
+#include <future>
+#include <limits>
+#include <thread>
+
+#include <glm/gtc/packing.hpp>
 
 namespace LearnVulkan
 {
-    void Model::loadModel(const std::string& path, const Wrapper::Device::Ptr& device)
+    namespace
+    {
+        // OBJ 的一个面顶点由 (位置, UV, 法线) 三元组索引确定，三元组相同即为同一个顶点
+        struct ObjIndexHash
+        {
+            size_t operator()(const tinyobj::index_t& index) const
+            {
+                size_t seed = std::hash<int>()(index.vertex_index);
+                seed ^= std::hash<int>()(index.texcoord_index) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                seed ^= std::hash<int>()(index.normal_index)   + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                return seed;
+            }
+        };
+
+        struct ObjIndexEqual
+        {
+            bool operator()(const tinyobj::index_t& lhs, const tinyobj::index_t& rhs) const
+            {
+                return lhs.vertex_index   == rhs.vertex_index   &&
+                       lhs.texcoord_index == rhs.texcoord_index &&
+                       lhs.normal_index   == rhs.normal_index;
+            }
+        };
+
+        using ObjIndexMap = std::unordered_map<tinyobj::index_t, uint32_t, ObjIndexHash, ObjIndexEqual>;
+
+        // 网格缓存中的数据段
+        enum MeshSection : uint32_t
+        {
+            SectionMeshInfo  = 0,
+            SectionPositions = 1,
+            SectionUVs       = 2,
+            SectionIndices   = 3,
+            SectionMeshlets  = 4,
+            SectionLods      = 5,
+        };
+
+        // 单个 shape 的局部去重结果：首次出现顺序的唯一三元组 + 指向它们的局部索引
+        struct ShapeVertices
+        {
+            std::vector<tinyobj::index_t> mUniqueIndices{};
+            std::vector<uint32_t>         mLocalIndices{};
+        };
+
+        ShapeVertices dedupShape(const tinyobj::shape_t& shape)
+        {
+            ShapeVertices result{};
+            result.mLocalIndices.reserve(shape.mesh.indices.size());
+
+            ObjIndexMap uniqueMap{};
+            uniqueMap.reserve(shape.mesh.indices.size());
+
+            for (const auto& index : shape.mesh.indices)
+            {
+                auto [it, inserted] = uniqueMap.try_emplace(index, static_cast<uint32_t>(result.mUniqueIndices.size()));
+
+                if (inserted)
+                {
+                    result.mUniqueIndices.push_back(index);
+                }
+
+                result.mLocalIndices.push_back(it->second);
+            }
+
+            return result;
+        }
+    }
+
+    void Model::loadModel(const std::string& path, const Wrapper::Device::Ptr& device, const Wrapper::UploadContext::Ptr& uploadContext)
+    {
+        const VertexQuantization quantization = resolveQuantization(device);
+
+        // 没有外部上传上下文时用一个临时的，离开作用域析构时统一提交并等待
+        const auto uploader = uploadContext != nullptr ? uploadContext : Wrapper::UploadContext::create(device);
+
+        // 缓存键包含导入选项，开关网格优化、量化、布局、网格簇或 LOD 都会生成不同的缓存内容
+        uint32_t cacheFlags = (static_cast<uint32_t>(quantization) << 1) | (static_cast<uint32_t>(mStreamLayout) << 3);
+        if (mOptimizeMesh)
+        {
+            cacheFlags |= 1u;
+        }
+        if (mBuildMeshlets)
+        {
+            cacheFlags |= 1u << 4;
+        }
+        if (mGenerateLods)
+        {
+            cacheFlags |= 1u << 5;
+        }
+
+        const std::string cachePath = MeshCache::getCachePath(path);
+
+        MeshCacheKey cacheKey{};
+        const bool   hasCacheKey = MeshCache::makeKey(path, cacheFlags, cacheKey);
+
+        if (hasCacheKey)
+        {
+            if (auto cache = MeshCache::open(cachePath, cacheKey))
+            {
+                if (loadFromCache(cache, device, uploader))
+                {
+                    std::cout << "Model: " << path << " loaded from cache " << cachePath
+                              << " (vertices " << mMeshInfo.mVertexCount << ", indices " << mMeshInfo.mIndexCount << ")" << std::endl;
+                    return;
+                }
+            }
+        }
+
+        importObj(path);
+
+        if (mOptimizeMesh)
+        {
+            optimizeMesh();
+        }
+
+        // LOD0 就是原始网格，生成的更粗级别依次拼接在 mIndexDatas 之后
+        mLods.assign(1, LodLevel{ 0, static_cast<uint32_t>(mIndexDatas.size()) });
+
+        if (mGenerateLods)
+        {
+            generateLods();
+        }
+
+        // 网格簇只记录索引区间，必须在所有改变三角形顺序的步骤之后切分
+        if (mBuildMeshlets)
+        {
+            buildMeshlets();
+        }
+
+        // 按目标格式打包成最终上传的字节流，缓存里存的也是这份数据
+        std::vector<uint8_t> positionStream{};
+        std::vector<uint8_t> uvStream{};
+        std::vector<uint8_t> indexStream{};
+        packStreams(quantization, positionStream, uvStream, indexStream);
+
+        if (hasCacheKey)
+        {
+            MeshCache::write(cachePath, cacheKey,
+            {
+                { SectionMeshInfo,  &mMeshInfo,            sizeof(mMeshInfo) },
+                { SectionPositions, positionStream.data(), positionStream.size() },
+                { SectionUVs,       uvStream.data(),       uvStream.size() },
+                { SectionIndices,   indexStream.data(),    indexStream.size() },
+                { SectionMeshlets,  mMeshlets.data(),      mMeshlets.size() * sizeof(Meshlet) },
+                { SectionLods,      mLods.data(),          mLods.size() * sizeof(LodLevel) },
+            });
+        }
+
+        createBuffers(device, uploader, positionStream.data(), uvStream.data(), indexStream.data(), mMeshlets.data(), static_cast<uint32_t>(mMeshlets.size()));
+    }
+
+    Model::VertexQuantization Model::resolveQuantization(const Wrapper::Device::Ptr& device) const
+    {
+        if (mVertexQuantization == VertexQuantization::None)
+        {
+            return VertexQuantization::None;
+        }
+
+        // 这几种格式规范要求必须支持作为顶点属性，这里仍然查询一次，不支持时退回 32 位浮点
+        const VkFormat positionFormat = mVertexQuantization == VertexQuantization::Snorm16 ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R16G16B16A16_SFLOAT;
+
+        for (auto format : { positionFormat, VK_FORMAT_R16G16_UNORM })
+        {
+            VkFormatProperties properties{};
+            vkGetPhysicalDeviceFormatProperties(device->getPhysicalDevice(), format, &properties);
+
+            if (!(properties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT))
+            {
+                std::cout << "Model: quantized vertex format " << format << " not supported, falling back to float" << std::endl;
+                return VertexQuantization::None;
+            }
+        }
+
+        return mVertexQuantization;
+    }
+
+    bool Model::loadFromCache(const MeshCache::Ptr& cache, const Wrapper::Device::Ptr& device, const Wrapper::UploadContext::Ptr& uploadContext)
+    {
+        auto info      = cache->getSection(SectionMeshInfo);
+        auto positions = cache->getSection(SectionPositions);
+        auto uvs       = cache->getSection(SectionUVs);
+        auto indices   = cache->getSection(SectionIndices);
+        auto meshlets  = cache->getSection(SectionMeshlets);
+        auto lods      = cache->getSection(SectionLods);
+
+        if (info.mSize != sizeof(MeshInfo))
+        {
+            return false;
+        }
+
+        MeshInfo meshInfo{};
+        memcpy(&meshInfo, info.mData, sizeof(MeshInfo));
+
+        const bool interleaved = meshInfo.mStreamLayout == StreamLayout::Interleaved;
+
+        // 交错布局时所有属性都在位置段里，UV 段为空
+        const uint64_t positionBytes = uint64_t(meshInfo.mVertexCount) * (meshInfo.mPositionStride + (interleaved ? meshInfo.mUVStride : 0));
+        const uint64_t uvBytes       = interleaved ? 0 : uint64_t(meshInfo.mVertexCount) * meshInfo.mUVStride;
+
+        if (positions.mSize != positionBytes ||
+            uvs.mSize       != uvBytes       ||
+            indices.mSize   != getIndexStreamSize(meshInfo) ||
+            meshlets.mSize  % sizeof(Meshlet) != 0 ||
+            lods.mSize == 0 || lods.mSize % sizeof(LodLevel) != 0)
+        {
+            return false;
+        }
+
+        std::vector<LodLevel> lodLevels(lods.mSize / sizeof(LodLevel));
+        memcpy(lodLevels.data(), lods.mData, lods.mSize);
+
+        const uint64_t meshletCount = meshlets.mSize / sizeof(Meshlet);
+
+        for (const auto& level : lodLevels)
+        {
+            if (uint64_t(level.mFirstIndex) + level.mIndexCount > meshInfo.mIndexCount ||
+                uint64_t(level.mFirstMeshlet) + level.mMeshletCount > meshletCount)
+            {
+                return false;
+            }
+        }
+
+        // 命中：直接从映射内存拷贝到暂存缓冲，不经过文本解析和中间数组
+        mMeshInfo = meshInfo;
+        mLods     = std::move(lodLevels);
+        createBuffers(device, uploadContext, positions.mData, uvs.mData, indices.mData,
+                      static_cast<const Meshlet*>(meshlets.mData), static_cast<uint32_t>(meshlets.mSize / sizeof(Meshlet)));
+
+        return true;
+    }
+
+    void Model::importObj(const std::string& path)
     {
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
         std::string err;
-        std::string warn;
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str()))
+        // 多线程分块解析，输出与 tinyobj::LoadObj 相同
+        if (!ObjParser::parse(path, attrib, shapes, err))
         {
             throw std::runtime_error(err);
         }
 
-        for (const auto& shape : shapes)
+        // 步骤1：各 shape 并行做局部去重（按硬件线程数分组，避免 shape 很多时线程爆炸）
+        std::vector<ShapeVertices> shapeVertices(shapes.size());
+
+        const size_t workerCount = std::max<size_t>(1, std::min<size_t>(shapes.size(), std::thread::hardware_concurrency()));
+        std::vector<std::future<void>> workers{};
+
+        for (size_t worker = 0; worker < workerCount; ++worker)
         {
-            for (const auto& index : shape.mesh.indices)
+            workers.push_back(std::async(std::launch::async, [&, worker]()
+            {
+                for (size_t i = worker; i < shapes.size(); i += workerCount)
+                {
+                    shapeVertices[i] = dedupShape(shapes[i]);
+                }
+            }));
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.get();
+        }
+
+        // 步骤2：串行合并，跨 shape 共享的顶点同样只保留一份（只遍历唯一顶点，开销很小）
+        size_t objIndexCount = 0;
+        ObjIndexMap globalMap{};
+
+        for (const auto& shape : shapeVertices)
+        {
+            objIndexCount += shape.mLocalIndices.size();
+
+            std::vector<uint32_t> remap(shape.mUniqueIndices.size());
+
+            for (size_t i = 0; i < shape.mUniqueIndices.size(); ++i)
+            {
+                const auto& index = shape.mUniqueIndices[i];
+
+                auto [it, inserted] = globalMap.try_emplace(index, static_cast<uint32_t>(mPositions.size() / 3));
+
+                if (inserted)
+                {
+                    mPositions.push_back(attrib.vertices[3 * index.vertex_index + 0]);
+                    mPositions.push_back(attrib.vertices[3 * index.vertex_index + 1]);
+                    mPositions.push_back(attrib.vertices[3 * index.vertex_index + 2]);
+
+                    if (index.texcoord_index >= 0)
+                    {
+                        mUVs.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
+                        mUVs.push_back(1.0f - attrib.texcoords[2 * index.texcoord_index + 1]);
+                    }
+                    else
+                    {
+                        mUVs.push_back(0.0f);
+                        mUVs.push_back(0.0f);
+                    }
+                }
+
+                remap[i] = it->second;
+            }
+
+            for (auto localIndex : shape.mLocalIndices)
+            {
+                mIndexDatas.push_back(remap[localIndex]);
+            }
+        }
+
+        const size_t vertexCount = mPositions.size() / 3;
+
+        std::cout << "Model: " << path << " vertices " << objIndexCount << " -> " << vertexCount
+                  << " (x" << (vertexCount ? static_cast<float>(objIndexCount) / vertexCount : 0.0f) << " reduction)" << std::endl;
+    }
+
+    void Model::optimizeMesh()
+    {
+        constexpr uint32_t cacheSize = 16;
+
+        size_t vertexCount = mPositions.size() / 3;
+        auto before = MeshOptimizer::analyzeVertexCache(mIndexDatas, vertexCount, cacheSize);
+
+        // 步骤1：顶点缓存优化，同时得到硬边界簇
+        std::vector<uint32_t> hardClusters{};
+        MeshOptimizer::optimizeVertexCache(mIndexDatas, vertexCount, cacheSize, hardClusters);
+
+        // 步骤2：软边界细分后按簇做过度绘制排序
+        auto clusters = MeshOptimizer::splitSoftBoundaries(mIndexDatas, vertexCount, hardClusters, cacheSize);
+        MeshOptimizer::optimizeOverdraw(mIndexDatas, mPositions, clusters);
+
+        // 步骤3：顶点按首次被引用的顺序重排，让顶点获取尽量顺序访问
+        std::vector<uint32_t> remap{};
+        vertexCount = MeshOptimizer::optimizeVertexFetch(mIndexDatas, vertexCount, remap);
+        MeshOptimizer::remapVertexStream(mPositions, 3, remap, vertexCount);
+        MeshOptimizer::remapVertexStream(mUVs, 2, remap, vertexCount);
+
+        auto after = MeshOptimizer::analyzeVertexCache(mIndexDatas, vertexCount, cacheSize);
+
+        std::cout << "Model: optimized " << clusters.size() << " clusters, ACMR " << before.mACMR << " -> " << after.mACMR
+                  << ", ATVR " << before.mATVR << " -> " << after.mATVR << std::endl;
+    }
+
+    void Model::generateLods()
+    {
+        constexpr float LodReduction        = 0.5f;    // 每级目标索引数为原始网格的 0.5^level
+        constexpr float MinLodReduction     = 0.9f;    // 比上一级减少不到 10% 时停止（剩下的多是锁定的边界 / 接缝）
+        constexpr float MaxRelativeLodError = 0.05f;   // 误差上限为包围球半径的 5%
+
+        const std::vector<uint32_t> baseIndices(mIndexDatas.begin(), mIndexDatas.end());
+        const size_t vertexCount = mPositions.size() / 3;
+
+        glm::vec3 minPosition(std::numeric_limits<float>::max());
+        glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            const glm::vec3 position(mPositions[v * 3 + 0], mPositions[v * 3 + 1], mPositions[v * 3 + 2]);
+
+            minPosition = glm::min(minPosition, position);
+            maxPosition = glm::max(maxPosition, position);
+        }
+
+        const float radius = vertexCount ? glm::length(maxPosition - minPosition) * 0.5f : 0.0f;
+        float targetRatio = 1.0f;
+
+        // 每级都从原始网格简化，记录的误差直接相对原始网格，不会逐级累积
+        while (mLods.size() < MaxLodCount)
+        {
+            targetRatio *= LodReduction;
+
+            float error = 0.0f;
+            auto  indices = MeshSimplifier::simplify(baseIndices, mPositions,
+                                                     size_t(baseIndices.size() * targetRatio) / 3 * 3,
+                                                     radius * MaxRelativeLodError, error);
+
+            if (indices.empty() || indices.size() > mLods.back().mIndexCount * MinLodReduction)
+            {
+                break;
+            }
+
+            // 简化后三角形顺序被打乱，按需重新做顶点缓存优化（顶点已经共享 LOD0 的顺序，不再重排）
+            if (mOptimizeMesh)
+            {
+                std::vector<uint32_t> clusters{};
+                MeshOptimizer::optimizeVertexCache(indices, vertexCount, 16, clusters);
+            }
+
+            LodLevel level{};
+            level.mFirstIndex = static_cast<uint32_t>(mIndexDatas.size());
+            level.mIndexCount = static_cast<uint32_t>(indices.size());
+            level.mError      = std::max(error, mLods.back().mError);
+
+            mIndexDatas.insert(mIndexDatas.end(), indices.begin(), indices.end());
+            mLods.push_back(level);
+        }
+
+        std::cout << "Model: " << mLods.size() << " LOD levels, triangles";
+        for (const auto& level : mLods)
+        {
+            std::cout << " " << level.mIndexCount / 3 << " (error " << level.mError << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    void Model::buildMeshlets()
+    {
+        // 每级 LOD 单独切分，簇的索引区间换算成合并后索引缓冲区中的绝对位置
+        for (auto& level : mLods)
+        {
+            const std::vector<uint32_t> indices(mIndexDatas.begin() + level.mFirstIndex,
+                                                mIndexDatas.begin() + level.mFirstIndex + level.mIndexCount);
+
+            auto meshlets = MeshletBuilder::build(indices, mPositions);
+
+            level.mFirstMeshlet = static_cast<uint32_t>(mMeshlets.size());
+            level.mMeshletCount = static_cast<uint32_t>(meshlets.size());
+
+            for (auto& meshlet : meshlets)
+            {
+                meshlet.mFirstIndex += level.mFirstIndex;
+                mMeshlets.push_back(meshlet);
+            }
+        }
+
+        std::cout << "Model: " << mMeshlets.size() << " meshlets (" << MeshletBuilder::DefaultMaxVertices << " vertices / "
+                  << MeshletBuilder::DefaultMaxTriangles << " triangles max)" << std::endl;
+    }
+
+    uint32_t Model::selectLod(const VPMatrices& vpMatrices, unsigned int viewportHeight)
+    {
+        mCurrentLod = selectLod(vpMatrices, mUniform.mModelMatrix, viewportHeight);
+
+        return mCurrentLod;
+    }
+
+    uint32_t Model::selectLod(const VPMatrices& vpMatrices, const glm::mat4& modelMatrix, unsigned int viewportHeight) const
+    {
+        if (mLods.size() <= 1)
+        {
+            return 0;
+        }
+
+        const float pixelsPerUnit = getPixelsPerUnit(vpMatrices, modelMatrix, viewportHeight);
+
+        // 相机在包围球内时总是用最精细的一级
+        if (pixelsPerUnit == std::numeric_limits<float>::max())
+        {
+            return 0;
+        }
+
+        return MeshSimplifier::selectLod(mLods, pixelsPerUnit, mLodErrorThreshold);
+    }
+
+    float Model::getProjectedSize(const VPMatrices& vpMatrices, unsigned int viewportHeight) const
+    {
+        const float pixelsPerUnit = getPixelsPerUnit(vpMatrices, mUniform.mModelMatrix, viewportHeight);
+
+        if (pixelsPerUnit == std::numeric_limits<float>::max())
+        {
+            return pixelsPerUnit;
+        }
+
+        return pixelsPerUnit * mMeshInfo.mBoundingSphere.w * 2.0f;
+    }
+
+    float Model::getPixelsPerUnit(const VPMatrices& vpMatrices, const glm::mat4& modelMatrix, unsigned int viewportHeight) const
+    {
+        // 按模型矩阵最大的轴向缩放把模型空间误差换算到世界空间
+        const float scale = std::max(glm::length(glm::vec3(modelMatrix[0])),
+                                     std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+
+        const glm::vec3 center = modelMatrix * glm::vec4(glm::vec3(mMeshInfo.mBoundingSphere), 1.0f);
+        const glm::vec3 camera = glm::inverse(vpMatrices.mViewMatrix)[3];
+
+        // 取包围球上离相机最近的点的距离
+        const float distance = glm::length(center - camera) - mMeshInfo.mBoundingSphere.w * scale;
+
+        if (distance <= 0.0f)
+        {
+            return std::numeric_limits<float>::max();
+        }
+
+        // 透视投影下距离 d 处单位长度占 proj[1][1] * 高度 / 2 / d 个像素
+        return scale * std::abs(vpMatrices.mProjectionMatrix[1][1]) * viewportHeight * 0.5f / distance;
+    }
+
+    VkDeviceSize Model::getIndexStreamSize(const MeshInfo& meshInfo)
+    {
+        const VkDeviceSize indexSize = meshInfo.mIndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        return (VkDeviceSize(meshInfo.mIndexCount) * indexSize + 3) & ~VkDeviceSize(3);
+    }
+
+    void Model::packStreams(VertexQuantization quantization,
+                            std::vector<uint8_t>& positionStream,
+                            std::vector<uint8_t>& uvStream,
+                            std::vector<uint8_t>& indexStream)
+    {
+        const size_t vertexCount = mPositions.size() / 3;
+
+        mMeshInfo = MeshInfo{};
+        mMeshInfo.mVertexCount = static_cast<uint32_t>(vertexCount);
+        mMeshInfo.mIndexCount  = static_cast<uint32_t>(mIndexDatas.size());
+
+        // 步骤0：包围球（包围盒中心 + 最远顶点距离），LOD 选择用
+        {
+            glm::vec3 minPosition(std::numeric_limits<float>::max());
+            glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                const glm::vec3 position(mPositions[v * 3 + 0], mPositions[v * 3 + 1], mPositions[v * 3 + 2]);
+
+                minPosition = glm::min(minPosition, position);
+                maxPosition = glm::max(maxPosition, position);
+            }
+
+            const glm::vec3 center = vertexCount ? (minPosition + maxPosition) * 0.5f : glm::vec3(0.0f);
+            float radius = 0.0f;
+
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                radius = std::max(radius, glm::length(glm::vec3(mPositions[v * 3 + 0], mPositions[v * 3 + 1], mPositions[v * 3 + 2]) - center));
+            }
+
+            mMeshInfo.mBoundingSphere = glm::vec4(center, radius);
+        }
+
+        if (quantization == VertexQuantization::None)
+        {
+            positionStream.resize(mPositions.size() * sizeof(float));
+            memcpy(positionStream.data(), mPositions.data(), positionStream.size());
+
+            uvStream.resize(mUVs.size() * sizeof(float));
+            memcpy(uvStream.data(), mUVs.data(), uvStream.size());
+        }
+        else
+        {
+            // 步骤1：位置按包围盒归一化到 [-1, 1]，着色器中 position = encoded * scale + offset
+            glm::vec3 minPosition(std::numeric_limits<float>::max());
+            glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+            glm::vec2 minUV(std::numeric_limits<float>::max());
+            glm::vec2 maxUV(std::numeric_limits<float>::lowest());
+
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                const glm::vec3 position(mPositions[v * 3 + 0], mPositions[v * 3 + 1], mPositions[v * 3 + 2]);
+                const glm::vec2 uv(mUVs[v * 2 + 0], mUVs[v * 2 + 1]);
+
+                minPosition = glm::min(minPosition, position);
+                maxPosition = glm::max(maxPosition, position);
+                minUV       = glm::min(minUV, uv);
+                maxUV       = glm::max(maxUV, uv);
+            }
+
+            if (vertexCount == 0)
+            {
+                minPosition = maxPosition = glm::vec3(0.0f);
+                minUV       = maxUV       = glm::vec2(0.0f);
+            }
+
+            glm::vec3 positionScale = (maxPosition - minPosition) * 0.5f;
+            glm::vec2 uvScale       = maxUV - minUV;
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                positionScale[axis] = positionScale[axis] > 0.0f ? positionScale[axis] : 1.0f;
+            }
+
+            for (int axis = 0; axis < 2; ++axis)
+            {
+                uvScale[axis] = uvScale[axis] > 0.0f ? uvScale[axis] : 1.0f;
+            }
+
+            const glm::vec3 positionOffset = (maxPosition + minPosition) * 0.5f;
+
+            mMeshInfo.mPositionFormat = quantization == VertexQuantization::Snorm16 ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R16G16B16A16_SFLOAT;
+            mMeshInfo.mUVFormat       = VK_FORMAT_R16G16_UNORM;
+            mMeshInfo.mPositionStride = sizeof(uint16_t) * 4;  // 3 分量 16 位格式不保证可作顶点属性，补一个 w
+            mMeshInfo.mUVStride       = sizeof(uint16_t) * 2;
+            mMeshInfo.mPositionScale  = glm::vec4(positionScale, 0.0f);
+            mMeshInfo.mPositionOffset = glm::vec4(positionOffset, 0.0f);
+            mMeshInfo.mUVTransform    = glm::vec4(uvScale, minUV);
+
+            // 步骤2：逐顶点编码
+            std::vector<uint16_t> positions(vertexCount * 4, 0);
+            std::vector<uint16_t> uvs(vertexCount * 2, 0);
+
+            for (size_t v = 0; v < vertexCount; ++v)
             {
-                mPositions.push_back(attrib.vertices[3 * index.vertex_index + 0]);
-                mPositions.push_back(attrib.vertices[3 * index.vertex_index + 1]);
-                mPositions.push_back(attrib.vertices[3 * index.vertex_index + 2]);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float normalized = (mPositions[v * 3 + axis] - positionOffset[axis]) / positionScale[axis];
 
-                mUVs.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
-                mUVs.push_back(1.0f - attrib.texcoords[2 * index.texcoord_index + 1]);
+                    positions[v * 4 + axis] = quantization == VertexQuantization::Snorm16 ? glm::packSnorm1x16(normalized)
+                                                                                          : glm::packHalf1x16(normalized);
+                }
 
-                mIndexDatas.push_back(mIndexDatas.size());
+                for (int axis = 0; axis < 2; ++axis)
+                {
+                    uvs[v * 2 + axis] = glm::packUnorm1x16((mUVs[v * 2 + axis] - minUV[axis]) / uvScale[axis]);
+                }
             }
+
+            positionStream.resize(positions.size() * sizeof(uint16_t));
+            memcpy(positionStream.data(), positions.data(), positionStream.size());
+
+            uvStream.resize(uvs.size() * sizeof(uint16_t));
+            memcpy(uvStream.data(), uvs.data(), uvStream.size());
+        }
+
+        // 步骤3：交错布局时把两条流按顶点拼接成一条
+        mMeshInfo.mStreamLayout = mStreamLayout;
+
+        if (mStreamLayout == StreamLayout::Interleaved)
+        {
+            const size_t positionStride = mMeshInfo.mPositionStride;
+            const size_t uvStride       = mMeshInfo.mUVStride;
+
+            std::vector<uint8_t> interleaved(vertexCount * (positionStride + uvStride));
+
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                uint8_t* vertex = interleaved.data() + v * (positionStride + uvStride);
+
+                memcpy(vertex, positionStream.data() + v * positionStride, positionStride);
+                memcpy(vertex + positionStride, uvStream.data() + v * uvStride, uvStride);
+            }
+
+            positionStream.swap(interleaved);
+            uvStream.clear();
+        }
+
+        // 步骤4：顶点数不超过 65536 时索引自动使用 16 位（与是否量化无关）
+        if (vertexCount <= 65536)
+        {
+            std::vector<uint16_t> indices(mIndexDatas.begin(), mIndexDatas.end());
+
+            mMeshInfo.mIndexType = VK_INDEX_TYPE_UINT16;
+            indexStream.resize(indices.size() * sizeof(uint16_t));
+            memcpy(indexStream.data(), indices.data(), indexStream.size());
         }
+        else
+        {
+            mMeshInfo.mIndexType = VK_INDEX_TYPE_UINT32;
+            indexStream.resize(mIndexDatas.size() * sizeof(uint32_t));
+            memcpy(indexStream.data(), mIndexDatas.data(), indexStream.size());
+        }
+
+        // 剔除着色器按 uint 数组读取索引（16 位索引两个一组），索引流补齐到 4 字节；
+        // 缓存里存的也是补齐后的数据，命中时直接从映射上传
+        indexStream.resize(getIndexStreamSize(mMeshInfo), 0);
+    }
+
+    void Model::createBuffers(const Wrapper::Device::Ptr& device,
+                              const Wrapper::UploadContext::Ptr& uploadContext,
+                              const void* positions,
+                              const void* uvs,
+                              const void* indices,
+                              const Meshlet* meshlets,
+                              uint32_t meshletCount)
+    {
+        if (mMeshInfo.mStreamLayout == StreamLayout::Interleaved)
+        {
+            const VkDeviceSize vertexStride = mMeshInfo.mPositionStride + mMeshInfo.mUVStride;
+            mVertexBuffer = Wrapper::Buffer::createVertexBuffer(device, VkDeviceSize(mMeshInfo.mVertexCount) * vertexStride, positions, uploadContext);
+        }
+        else
+        {
+            mPositionBuffer = Wrapper::Buffer::createVertexBuffer(device, VkDeviceSize(mMeshInfo.mVertexCount) * mMeshInfo.mPositionStride, positions, uploadContext);
+            mUVBuffer = Wrapper::Buffer::createVertexBuffer(device, VkDeviceSize(mMeshInfo.mVertexCount) * mMeshInfo.mUVStride, uvs, uploadContext);
+        }
+
+        // indices 已补齐到 4 字节（见 packStreams），剔除着色器可以按 uint 数组读取
+        const VkDeviceSize indexBytes = getIndexStreamSize(mMeshInfo);
+
+        if (meshletCount == 0)
+        {
+            mIndexBuffer = Wrapper::Buffer::createIndexBuffer(device, indexBytes, indices, 0, uploadContext);
+        }
+        else
+        {
+            mIndexBuffer   = Wrapper::Buffer::createIndexBuffer(device, indexBytes, indices, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, uploadContext);
+            mMeshletBuffer = Wrapper::Buffer::createStorageBuffer(device, VkDeviceSize(meshletCount) * sizeof(Meshlet), meshlets, 0, uploadContext);
+        }
+
+        mMeshletCount = meshletCount;
 
-        mPositionBuffer = Wrapper::Buffer::createVertexBuffer(device, mPositions.size() * sizeof(float), mPositions.data());
-        mUVBuffer = Wrapper::Buffer::createVertexBuffer(device, mUVs.size() * sizeof(float), mUVs.data());
-        mIndexBuffer = Wrapper::Buffer::createIndexBuffer(device, mIndexDatas.size() * sizeof(float), mIndexDatas.data());
+        // 反量化参数随模型统一变量传给顶点着色器
+        mUniform.mPositionScale  = mMeshInfo.mPositionScale;
+        mUniform.mPositionOffset = mMeshInfo.mPositionOffset;
+        mUniform.mUVTransform    = mMeshInfo.mUVTransform;
     }
 }
@@ -4,7 +4,12 @@
 #include "vulkanWrapper/buffer.h"
 #include "vulkanWrapper/device.h"
 #include "vulkanWrapper/descriptorSet.h"
+#include "vulkanWrapper/uploadContext.h"
 #include "vulkanWrapper/description.h"
+#include "meshOptimizer.h"
+#include "meshlet.h"
+#include "meshSimplifier.h"
+#include "meshCache.h"
 
 namespace LearnVulkan
 {
@@ -13,6 +18,41 @@ namespace LearnVulkan
     public:
         using Ptr = std::shared_ptr<Model>;
 
+        // 顶点流的存储格式（索引格式与此无关，顶点数允许时总是使用 16 位索引）
+        enum class VertexQuantization : uint32_t
+        {
+            None    = 0,  // 位置 R32G32B32_SFLOAT，UV R32G32_SFLOAT
+            Snorm16 = 1,  // 位置 R16G16B16A16_SNORM，UV R16G16_UNORM
+            Half    = 2,  // 位置 R16G16B16A16_SFLOAT，UV R16G16_UNORM
+        };
+
+        // 顶点流布局
+        enum class StreamLayout : uint32_t
+        {
+            Split       = 0,  // 绑定点0 只有位置，绑定点1 放其余属性；只取位置的 Pass 只读位置流
+            Interleaved = 1,  // 所有属性交错在绑定点0，完整绘制时每个顶点只需一次连续读取
+        };
+
+        // 实际上传到 GPU 的网格布局和反量化参数，同时作为网格缓存中的一个数据段
+        struct MeshInfo
+        {
+            uint32_t     mVertexCount{ 0 };
+            uint32_t     mIndexCount{ 0 };
+            VkIndexType  mIndexType{ VK_INDEX_TYPE_UINT32 };
+            VkFormat     mPositionFormat{ VK_FORMAT_R32G32B32_SFLOAT };
+            VkFormat     mUVFormat{ VK_FORMAT_R32G32_SFLOAT };
+            uint32_t     mPositionStride{ sizeof(float) * 3 };
+            uint32_t     mUVStride{ sizeof(float) * 2 };
+            StreamLayout mStreamLayout{ StreamLayout::Split };
+            glm::vec4    mPositionScale{ 1.0f, 1.0f, 1.0f, 0.0f };   // position = encoded * scale + offset
+            glm::vec4    mPositionOffset{ 0.0f };
+            glm::vec4    mUVTransform{ 1.0f, 1.0f, 0.0f, 0.0f };     // uv = encoded * xy + zw
+            glm::vec4    mBoundingSphere{ 0.0f };                     // xyz 球心，w 半径（模型空间），用于 LOD 选择
+        };
+
+        // 自动生成的 LOD 级数上限（含原始网格），每级目标三角形数为上一级的一半
+        static constexpr uint32_t MaxLodCount = 5;
+
         static Ptr create(const Wrapper::Device::Ptr& device)
         {
             return std::make_shared<Model>(device);
@@ -22,7 +62,36 @@ namespace LearnVulkan
         {
         }
 
-        void loadModel(const std::string& path, const Wrapper::Device::Ptr& device);
+        /// 加载 OBJ 模型；同目录下存在匹配的 .meshcache 时直接映射缓存，否则导入后写入缓存。
+        /// 传入 uploadContext 时缓冲区上传只记录在其中，由调用方和其他资源一起 flush；否则本次加载的所有缓冲区一次提交
+        void loadModel(const std::string& path, const Wrapper::Device::Ptr& device, const Wrapper::UploadContext::Ptr& uploadContext = nullptr);
+
+        /// 导入后是否执行网格优化（顶点缓存 -> 过度绘制 -> 顶点获取顺序），需在 loadModel 之前设置
+        void setOptimizeMesh(bool optimize) { mOptimizeMesh = optimize; }
+
+        /// 顶点流量化方式，需在 loadModel 之前设置；设备不支持对应格式时自动退回浮点
+        void setVertexQuantization(VertexQuantization quantization) { mVertexQuantization = quantization; }
+
+        /// 顶点流布局，需在 loadModel 之前设置
+        void setStreamLayout(StreamLayout layout) { mStreamLayout = layout; }
+
+        /// 导入后是否把索引缓冲区切分成网格簇（约 64 顶点 / 124 三角形），供 ClusterCuller 做 GPU 簇剔除；需在 loadModel 之前设置
+        void setBuildMeshlets(bool build) { mBuildMeshlets = build; }
+
+        /// 导入后是否用 QEM 简化生成 LOD 链（所有级别共用顶点缓冲区，索引依次拼接在同一个索引缓冲区中）；需在 loadModel 之前设置
+        void setGenerateLods(bool generate) { mGenerateLods = generate; }
+
+        /// LOD 选择的屏幕空间误差阈值（像素），选择投影误差不超过该值的最粗一级
+        void setLodErrorThreshold(float pixels) { mLodErrorThreshold = pixels; }
+
+        /// 按当前模型矩阵和视图投影矩阵选择 LOD，结果可由 getCurrentLod 取得
+        uint32_t selectLod(const VPMatrices& vpMatrices, unsigned int viewportHeight);
+
+        /// 按给定的模型矩阵选择 LOD，不改变 getCurrentLod；同一模型的多个副本各自按自己的位置选择
+        [[nodiscard]] uint32_t selectLod(const VPMatrices& vpMatrices, const glm::mat4& modelMatrix, unsigned int viewportHeight) const;
+
+        /// 包围球直径投影到屏幕上的像素数，用于纹理流送的级别选择；相机在包围球内时返回 float 最大值
+        [[nodiscard]] float getProjectedSize(const VPMatrices& vpMatrices, unsigned int viewportHeight) const;
 
         ~Model() {}
 
@@ -30,55 +99,66 @@ namespace LearnVulkan
         // 顶点输入状态描述
         // ==================================================================
 
-        std::vector<VkVertexInputBindingDescription> getVertexInputBindingDescriptions()
+        /// positionOnly 为 true 时只描述位置属性，供深度 / 阴影等只需要位置的 Pass 使用
+        std::vector<VkVertexInputBindingDescription> getVertexInputBindingDescriptions(bool positionOnly = false) const
         {
             std::vector<VkVertexInputBindingDescription> bindingDes{};
-            bindingDes.resize(2);
+
+            if (mMeshInfo.mStreamLayout == StreamLayout::Interleaved)
+            {
+                // 交错布局：位置和 UV 在同一个绑定点，只取位置时仍按完整步长读取
+                bindingDes.resize(1);
+
+                bindingDes[0].binding   = 0;
+                bindingDes[0].stride    = mMeshInfo.mPositionStride + mMeshInfo.mUVStride;
+                bindingDes[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+                return bindingDes;
+            }
+
+            bindingDes.resize(positionOnly ? 1 : 2);
 
             // 位置属性绑定 (绑定点0)
             bindingDes[0].binding = 0;
-            bindingDes[0].stride = sizeof(float) * 3;
+            bindingDes[0].stride = mMeshInfo.mPositionStride;
             bindingDes[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-            // 颜色属性绑定 (绑定点1)
-            //bindingDes[1].binding = 1;
-            //bindingDes[1].stride = sizeof(float) * 3;
-            //bindingDes[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            if (positionOnly)
+            {
+                return bindingDes;
+            }
 
-            // UV属性绑定 (绑定点2)
+            // 其余属性绑定 (绑定点1，目前只有 UV)
             bindingDes[1].binding = 1;
-            bindingDes[1].stride = sizeof(float) * 2;
+            bindingDes[1].stride = mMeshInfo.mUVStride;
             bindingDes[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
             return bindingDes;
         }
 
-        std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions()
+        std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(bool positionOnly = false) const
         {
             std::vector<VkVertexInputAttributeDescription> attributeDes{};
-            attributeDes.resize(2);
+            attributeDes.resize(positionOnly ? 1 : 2);
 
             // 位置属性 (绑定点0, 位置索引0)
             attributeDes[0].binding  = 0;
             attributeDes[0].location = 0;                           // 对应shader的layout(location = 0)
-            attributeDes[0].format   = VK_FORMAT_R32G32B32_SFLOAT;  // XYZ
-            //attributeDes[0].offset = offsetof(Vertex, mPosition);
+            attributeDes[0].format   = mMeshInfo.mPositionFormat;   // XYZ（量化格式的 w 分量不使用）
             attributeDes[0].offset   = 0;                           // 在缓冲区起始位置
 
-            // 颜色属性 (绑定点1, 位置索引1)
-            // attributeDes[1].binding = 0;
-            //attributeDes[1].binding  = 1;
-            //attributeDes[1].location = 1;                           // 对应shader的layout(location = 1)
-            //attributeDes[1].format   = VK_FORMAT_R32G32B32_SFLOAT;  // RGB
-            //attributeDes[1].offset = offsetof(Vertex, mColor);
-            //attributeDes[1].offset   = 0;                           // 在缓冲区起始位置
-
-            // UV属性 (绑定点2, 位置索引2)
-            attributeDes[1].binding  = 1;
-            attributeDes[1].location = 1;                           // 对应shader的layout(location = 2)
-            attributeDes[1].format   = VK_FORMAT_R32G32_SFLOAT;     // UV
-            //attributeDes[0].offset = offsetof(Vertex, mPosition);
-            attributeDes[1].offset   = 0;                           // 在缓冲区起始位置
+            if (positionOnly)
+            {
+                return attributeDes;
+            }
+
+            // UV属性 (位置索引1)：分离布局在绑定点1的起始位置，交错布局紧跟在位置之后
+            const bool interleaved = mMeshInfo.mStreamLayout == StreamLayout::Interleaved;
+
+            attributeDes[1].binding  = interleaved ? 0 : 1;
+            attributeDes[1].location = 1;                           // 对应shader的layout(location = 1)
+            attributeDes[1].format   = mMeshInfo.mUVFormat;         // UV
+            attributeDes[1].offset   = interleaved ? mMeshInfo.mPositionStride : 0;
 
             return attributeDes;
         }
@@ -87,17 +167,23 @@ namespace LearnVulkan
         // 模型数据访问接口
         // ==================================================================
 
-        //[[nodiscard]] auto getVertexBuffer() const { return mVertexBuffer; }
-
-        /// 获取所有顶点缓冲区数组 (位置/颜色/UV)
-        [[nodiscard]] auto getVertexBuffers() const
+        /// 获取顶点缓冲区数组，与 getVertexInputBindingDescriptions(positionOnly) 的绑定点一一对应
+        [[nodiscard]] auto getVertexBuffers(bool positionOnly = false) const
         {
-            std::vector<VkBuffer> buffers
+            std::vector<VkBuffer> buffers{};
+
+            if (mMeshInfo.mStreamLayout == StreamLayout::Interleaved)
+            {
+                buffers.push_back(mVertexBuffer->getBuffer());
+                return buffers;
+            }
+
+            buffers.push_back(mPositionBuffer->getBuffer());
+
+            if (!positionOnly)
             {
-                mPositionBuffer->getBuffer(),
-                //mColorBuffer->getBuffer(),
-                mUVBuffer->getBuffer()
-            };
+                buffers.push_back(mUVBuffer->getBuffer());
+            }
 
             return buffers;
         }
@@ -108,10 +194,52 @@ namespace LearnVulkan
             return mIndexBuffer;
         }
 
-        /// 获取索引数量
+        /// 获取索引缓冲区中的索引总数（包含所有 LOD 级别，绘制时应使用 getLod 的区间）
         [[nodiscard]] auto getIndexCount() const
         {
-            return mIndexDatas.size();
+            return mMeshInfo.mIndexCount;
+        }
+
+        /// 获取索引类型（16/32 位）
+        [[nodiscard]] auto getIndexType() const
+        {
+            return mMeshInfo.mIndexType;
+        }
+
+        /// 获取包围球（xyz 球心，w 半径，模型空间）
+        [[nodiscard]] auto getBoundingSphere() const
+        {
+            return mMeshInfo.mBoundingSphere;
+        }
+
+        /// 获取网格簇缓冲区（std430 的 Meshlet 数组），未启用网格簇时为空
+        [[nodiscard]] auto getMeshletBuffer() const
+        {
+            return mMeshletBuffer;
+        }
+
+        /// 获取网格簇数量
+        [[nodiscard]] auto getMeshletCount() const
+        {
+            return mMeshletCount;
+        }
+
+        /// 获取 LOD 级数，未生成 LOD 时为 1
+        [[nodiscard]] auto getLodCount() const
+        {
+            return static_cast<uint32_t>(mLods.size());
+        }
+
+        /// 获取第 level 级 LOD 的索引区间、网格簇区间和几何误差
+        [[nodiscard]] const LodLevel& getLod(uint32_t level) const
+        {
+            return mLods[level];
+        }
+
+        /// 获取最近一次 selectLod 选择的级别
+        [[nodiscard]] auto getCurrentLod() const
+        {
+            return mCurrentLod;
         }
 
         /// 获取模型统一变量
@@ -143,23 +271,69 @@ namespace LearnVulkan
             mVPUniform.mProjectionMatrix = glm::perspective(glm::radians(60.0f), width / (float)height, 0.1f, 1000.0f);
 
             mVPUniform.mViewMatrix = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+            selectLod(mVPUniform, height);
         }
+    private:
+        void importObj(const std::string& path);
+
+        /// 模型空间单位长度在包围球最近点处投影到屏幕上的像素数；相机在包围球内时返回 float 最大值
+        float getPixelsPerUnit(const VPMatrices& vpMatrices, const glm::mat4& modelMatrix, unsigned int viewportHeight) const;
+
+        void optimizeMesh();
+
+        void generateLods();
+
+        void buildMeshlets();
+
+        VertexQuantization resolveQuantization(const Wrapper::Device::Ptr& device) const;
+
+        bool loadFromCache(const MeshCache::Ptr& cache, const Wrapper::Device::Ptr& device, const Wrapper::UploadContext::Ptr& uploadContext);
+
+        /// 索引流的字节数：索引数据补齐到 4 字节
+        static VkDeviceSize getIndexStreamSize(const MeshInfo& meshInfo);
+
+        void packStreams(VertexQuantization quantization,
+                         std::vector<uint8_t>& positionStream,
+                         std::vector<uint8_t>& uvStream,
+                         std::vector<uint8_t>& indexStream);
+
+        void createBuffers(const Wrapper::Device::Ptr& device,
+                           const Wrapper::UploadContext::Ptr& uploadContext,
+                           const void* positions,
+                           const void* uvs,
+                           const void* indices,
+                           const Meshlet* meshlets,
+                           uint32_t meshletCount);
+
     private:
         // 原始模型数据
         std::vector<float>        mPositions{};          // 顶点位置数据 (XYZ)
         std::vector<float>        mColors{};             // 顶点颜色数据 (RGB)
         std::vector<unsigned int> mIndexDatas{};         // 索引数据 (uint32_t)
         std::vector<float>        mUVs{};                // 纹理UV坐标 (UV)
+        std::vector<Meshlet>      mMeshlets{};           // 网格簇（每个簇对应索引缓冲区中连续的一段）
+        std::vector<LodLevel>     mLods{};               // LOD 链，至少包含原始网格一级
+        MeshInfo                  mMeshInfo{};           // 已上传的网格布局（缓存命中时上面的数组为空）
         
         // GPU缓冲区对象
-        Wrapper::Buffer::Ptr mVertexBuffer{ nullptr };
+        Wrapper::Buffer::Ptr mVertexBuffer{ nullptr };    // 交错布局的顶点缓冲区
         Wrapper::Buffer::Ptr mPositionBuffer{ nullptr };  // 位置数据缓冲区
         Wrapper::Buffer::Ptr mColorBuffer{ nullptr };     // 颜色数据缓冲区
         Wrapper::Buffer::Ptr mUVBuffer{ nullptr };        // UV数据缓冲区
         Wrapper::Buffer::Ptr mIndexBuffer{ nullptr };     // 索引数据缓冲区
+        Wrapper::Buffer::Ptr mMeshletBuffer{ nullptr };   // 网格簇缓冲区
+        uint32_t             mMeshletCount{ 0 };
 
         ObjectUniform        mUniform;                    // 模型统一变量
         VPMatrices           mVPUniform;                  // 视图投影矩阵统一变量
         float                mAngle{ 0.0f };              // 当前旋转角度（度）
+        bool                 mOptimizeMesh{ false };      // 导入后是否执行网格优化
+        VertexQuantization   mVertexQuantization{ VertexQuantization::None };
+        StreamLayout         mStreamLayout{ StreamLayout::Split };
+        bool                 mBuildMeshlets{ false };     // 导入后是否切分网格簇
+        bool                 mGenerateLods{ false };      // 导入后是否生成 LOD 链
+        float                mLodErrorThreshold{ 1.0f };  // LOD 选择的屏幕空间误差阈值（像素）
+        uint32_t             mCurrentLod{ 0 };
     };
 }
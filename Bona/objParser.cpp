@@ -0,0 +1,702 @@
+﻿#include "objParser.h"
+#include "mappedFile.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <thread>
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        constexpr size_t MinChunkSize = 1 << 20;  // 小于 1MB 的块不值得再开线程
+
+        struct ShapeBreak
+        {
+            size_t      mFace{ 0 };      // 块内第几个多边形之前
+            size_t      mTriangle{ 0 };  // 三角化后对应的块内三角形序号
+            std::string mName{};
+        };
+
+        struct ObjChunk
+        {
+            const char* mBegin{ nullptr };
+            const char* mEnd{ nullptr };
+
+            size_t mVertexCount{ 0 };
+            size_t mTexcoordCount{ 0 };
+            size_t mNormalCount{ 0 };
+
+            size_t mVertexBase{ 0 };
+            size_t mTexcoordBase{ 0 };
+            size_t mNormalBase{ 0 };
+
+            std::vector<tinyobj::index_t> mFaceIndices{};  // 多边形顶点（已转为从 0 开始的绝对索引）
+            std::vector<uint32_t>         mFaceSizes{};
+            std::vector<tinyobj::index_t> mTriangles{};
+            std::vector<ShapeBreak>       mShapeBreaks{};
+
+            std::string mError{};
+        };
+
+        template<typename Function>
+        void parallelFor(size_t count, size_t workerCount, Function&& function)
+        {
+            if (workerCount <= 1 || count <= 1)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    function(i);
+                }
+                return;
+            }
+
+            std::vector<std::future<void>> workers{};
+
+            for (size_t worker = 0; worker < workerCount; ++worker)
+            {
+                workers.push_back(std::async(std::launch::async, [&, worker]()
+                {
+                    for (size_t i = worker; i < count; i += workerCount)
+                    {
+                        function(i);
+                    }
+                }));
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.get();
+            }
+        }
+
+        inline bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t';
+        }
+
+        inline bool isDigit(char c)
+        {
+            return static_cast<unsigned char>(c - '0') < 10;
+        }
+
+        inline const char* skipSpaces(const char* p, const char* end)
+        {
+            while (p < end && isSpace(*p))
+            {
+                ++p;
+            }
+            return p;
+        }
+
+        inline const char* findLineEnd(const char* p, const char* end)
+        {
+            auto lineEnd = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            return lineEnd ? lineEnd : end;
+        }
+
+        // SWAR：一次判断 / 转换 8 个 ASCII 数字（小端），小数部分通常 6 位以上，可省掉大部分逐字符循环
+        inline bool isEightDigits(uint64_t value)
+        {
+            return (((value & 0xF0F0F0F0F0F0F0F0ull) | (((value + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull);
+        }
+
+        inline uint32_t parseEightDigits(uint64_t value)
+        {
+            constexpr uint64_t mask = 0x000000FF000000FFull;
+            constexpr uint64_t mul1 = 0x000F424000000064ull;  // 100 + (1000000 << 32)
+            constexpr uint64_t mul2 = 0x0000271000000001ull;  // 1 + (10000 << 32)
+
+            value -= 0x3030303030303030ull;
+            value = (value * 10) + (value >> 8);
+            value = (((value & mask) * mul1) + (((value >> 16) & mask) * mul2)) >> 32;
+
+            return static_cast<uint32_t>(value);
+        }
+
+        // 解析一个浮点数：尾数按整数累加（最多 19 位有效数字），再乘 / 除一次 10 的幂；
+        // 尾数不超过 2^53 且指数在 ±22 以内时结果是正确舍入的，否则退回 strtod
+        bool parseFloat(const char*& p, const char* end, float& out)
+        {
+            static const double powersOf10[] =
+            {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+
+            const char* start = p;
+
+            bool negative = false;
+            if (p < end && (*p == '+' || *p == '-'))
+            {
+                negative = *p == '-';
+                ++p;
+            }
+
+            uint64_t mantissa    = 0;
+            int      digits      = 0;  // 已计入尾数的有效数字
+            int      exponent    = 0;
+            bool     anyDigit    = false;
+            bool     truncated   = false;
+
+            while (p < end && isDigit(*p))
+            {
+                anyDigit = true;
+
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                    digits += mantissa != 0;
+                }
+                else
+                {
+                    ++exponent;
+                    truncated = true;
+                }
+                ++p;
+            }
+
+            if (p < end && *p == '.')
+            {
+                ++p;
+
+                while (digits + 8 <= 19 && end - p >= 8)
+                {
+                    uint64_t word;
+                    memcpy(&word, p, sizeof(word));
+
+                    if (!isEightDigits(word))
+                    {
+                        break;
+                    }
+
+                    mantissa = mantissa * 100000000 + parseEightDigits(word);
+                    digits   += mantissa != 0 ? 8 : 0;
+                    exponent -= 8;
+                    anyDigit = true;
+                    p        += 8;
+                }
+
+                while (p < end && isDigit(*p))
+                {
+                    anyDigit = true;
+
+                    if (digits < 19)
+                    {
+                        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                        digits += mantissa != 0;
+                        --exponent;
+                    }
+                    else
+                    {
+                        truncated = true;
+                    }
+                    ++p;
+                }
+            }
+
+            if (!anyDigit)
+            {
+                p = start;
+                return false;
+            }
+
+            if (p < end && (*p == 'e' || *p == 'E'))
+            {
+                const char* exponentStart = p;
+                ++p;
+
+                bool exponentNegative = false;
+                if (p < end && (*p == '+' || *p == '-'))
+                {
+                    exponentNegative = *p == '-';
+                    ++p;
+                }
+
+                if (p < end && isDigit(*p))
+                {
+                    int value = 0;
+                    while (p < end && isDigit(*p))
+                    {
+                        if (value < 100000)
+                        {
+                            value = value * 10 + (*p - '0');
+                        }
+                        ++p;
+                    }
+                    exponent += exponentNegative ? -value : value;
+                }
+                else
+                {
+                    p = exponentStart;  // 空指数，按 tinyobj 的约定只取前面的部分
+                }
+            }
+
+            double value;
+
+            if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+            {
+                value = exponent < 0 ? static_cast<double>(mantissa) / powersOf10[-exponent]
+                                     : static_cast<double>(mantissa) * powersOf10[exponent];
+            }
+            else
+            {
+                // 罕见的长尾数 / 大指数：复制到以 '\0' 结尾的缓冲再交给 strtod
+                char buffer[128];
+                const size_t length = std::min<size_t>(static_cast<size_t>(p - start), sizeof(buffer) - 1);
+                memcpy(buffer, start, length);
+                buffer[length] = '\0';
+
+                out = static_cast<float>(std::strtod(buffer, nullptr));
+                return true;
+            }
+
+            out = static_cast<float>(negative ? -value : value);
+            return true;
+        }
+
+        inline bool parseInt(const char*& p, const char* end, int& out)
+        {
+            bool negative = false;
+            if (p < end && (*p == '+' || *p == '-'))
+            {
+                negative = *p == '-';
+                ++p;
+            }
+
+            if (p >= end || !isDigit(*p))
+            {
+                return false;
+            }
+
+            int64_t value = 0;
+            while (p < end && isDigit(*p))
+            {
+                value = value * 10 + (*p - '0');
+                if (value > INT32_MAX)
+                {
+                    return false;
+                }
+                ++p;
+            }
+
+            out = static_cast<int>(negative ? -value : value);
+            return true;
+        }
+
+        // 解析 count 个空白分隔的浮点数，缺失的分量保持 0（与 tinyobj 一致）
+        inline void parseFloats(const char* p, const char* end, float* out, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                p = skipSpaces(p, end);
+
+                float value = 0.0f;
+                if (parseFloat(p, end, value))
+                {
+                    out[i] = value;
+                }
+                else
+                {
+                    out[i] = 0.0f;
+                }
+            }
+        }
+
+        // OBJ 索引从 1 开始，负数表示相对当前已定义数量
+        inline bool resolveIndex(int index, size_t definedCount, size_t totalCount, int& out)
+        {
+            int64_t resolved;
+
+            if (index > 0)
+            {
+                resolved = static_cast<int64_t>(index) - 1;
+            }
+            else if (index < 0)
+            {
+                resolved = static_cast<int64_t>(definedCount) + index;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (resolved < 0 || resolved >= static_cast<int64_t>(totalCount))
+            {
+                return false;
+            }
+
+            out = static_cast<int>(resolved);
+            return true;
+        }
+
+        // 步骤1：只看行首，统计块内 v / vt / vn 的数量
+        void countChunk(ObjChunk& chunk)
+        {
+            const char* p   = chunk.mBegin;
+            const char* end = chunk.mEnd;
+
+            while (p < end)
+            {
+                const char* lineEnd = findLineEnd(p, end);
+                const char* token   = skipSpaces(p, lineEnd);
+
+                if (lineEnd - token >= 2 && token[0] == 'v')
+                {
+                    if (isSpace(token[1]))
+                    {
+                        ++chunk.mVertexCount;
+                    }
+                    else if (lineEnd - token >= 3 && isSpace(token[2]))
+                    {
+                        chunk.mTexcoordCount += token[1] == 't';
+                        chunk.mNormalCount   += token[1] == 'n';
+                    }
+                }
+
+                p = lineEnd < end ? lineEnd + 1 : end;
+            }
+        }
+
+        // 步骤2：完整解析，顶点属性写入 attrib 中本块对应的区间
+        void parseChunk(ObjChunk& chunk, tinyobj::attrib_t& attrib)
+        {
+            const char* p   = chunk.mBegin;
+            const char* end = chunk.mEnd;
+
+            const size_t totalVertices  = attrib.vertices.size() / 3;
+            const size_t totalTexcoords = attrib.texcoords.size() / 2;
+            const size_t totalNormals   = attrib.normals.size() / 3;
+
+            size_t vertex   = chunk.mVertexBase;
+            size_t texcoord = chunk.mTexcoordBase;
+            size_t normal   = chunk.mNormalBase;
+
+            // 按平均每行约 30 字节粗略预留，避免解析过程中反复扩容
+            chunk.mFaceIndices.reserve(static_cast<size_t>(end - p) / 10);
+            chunk.mFaceSizes.reserve(static_cast<size_t>(end - p) / 30);
+
+            while (p < end)
+            {
+                const char* lineEnd = findLineEnd(p, end);
+                const char* token   = skipSpaces(p, lineEnd);
+                const size_t length = static_cast<size_t>(lineEnd - token);
+
+                if (length >= 2 && token[0] == 'v' && isSpace(token[1]))
+                {
+                    parseFloats(token + 2, lineEnd, &attrib.vertices[vertex * 3], 3);
+                    ++vertex;
+                }
+                else if (length >= 3 && token[0] == 'v' && token[1] == 't' && isSpace(token[2]))
+                {
+                    parseFloats(token + 3, lineEnd, &attrib.texcoords[texcoord * 2], 2);
+                    ++texcoord;
+                }
+                else if (length >= 3 && token[0] == 'v' && token[1] == 'n' && isSpace(token[2]))
+                {
+                    parseFloats(token + 3, lineEnd, &attrib.normals[normal * 3], 3);
+                    ++normal;
+                }
+                else if (length >= 2 && token[0] == 'f' && isSpace(token[1]))
+                {
+                    const char* q         = token + 2;
+                    uint32_t    faceSize  = 0;
+
+                    while (true)
+                    {
+                        q = skipSpaces(q, lineEnd);
+
+                        int value = 0;
+                        if (!parseInt(q, lineEnd, value))
+                        {
+                            break;
+                        }
+
+                        tinyobj::index_t index{ -1, -1, -1 };
+
+                        if (!resolveIndex(value, vertex, totalVertices, index.vertex_index))
+                        {
+                            chunk.mError = "Error: invalid vertex index in face";
+                            return;
+                        }
+
+                        if (q < lineEnd && *q == '/')
+                        {
+                            ++q;
+
+                            if (q < lineEnd && *q != '/')
+                            {
+                                if (!parseInt(q, lineEnd, value) || !resolveIndex(value, texcoord, totalTexcoords, index.texcoord_index))
+                                {
+                                    chunk.mError = "Error: invalid texcoord index in face";
+                                    return;
+                                }
+                            }
+
+                            if (q < lineEnd && *q == '/')
+                            {
+                                ++q;
+
+                                if (!parseInt(q, lineEnd, value) || !resolveIndex(value, normal, totalNormals, index.normal_index))
+                                {
+                                    chunk.mError = "Error: invalid normal index in face";
+                                    return;
+                                }
+                            }
+                        }
+
+                        chunk.mFaceIndices.push_back(index);
+                        ++faceSize;
+                    }
+
+                    chunk.mFaceSizes.push_back(faceSize);
+                }
+                else if (length >= 2 && (token[0] == 'g' || token[0] == 'o') && isSpace(token[1]))
+                {
+                    const char* nameBegin = skipSpaces(token + 2, lineEnd);
+                    const char* nameEnd   = lineEnd;
+
+                    while (nameEnd > nameBegin && (isSpace(nameEnd[-1]) || nameEnd[-1] == '\r'))
+                    {
+                        --nameEnd;
+                    }
+
+                    chunk.mShapeBreaks.push_back({ chunk.mFaceSizes.size(), 0, std::string(nameBegin, nameEnd) });
+                }
+
+                p = lineEnd < end ? lineEnd + 1 : end;
+            }
+        }
+
+        // 步骤3：三角化。四边形与 tinyobj 一样沿较短的对角线切分，更多边的多边形按扇形切分
+        void triangulateChunk(ObjChunk& chunk, const tinyobj::attrib_t& attrib)
+        {
+            chunk.mTriangles.reserve(chunk.mFaceIndices.size());
+
+            const auto& v = attrib.vertices;
+
+            size_t cursor = 0;
+            size_t next   = 0;
+
+            for (size_t face = 0; face < chunk.mFaceSizes.size(); ++face)
+            {
+                while (next < chunk.mShapeBreaks.size() && chunk.mShapeBreaks[next].mFace == face)
+                {
+                    chunk.mShapeBreaks[next++].mTriangle = chunk.mTriangles.size() / 3;
+                }
+
+                const uint32_t          faceSize = chunk.mFaceSizes[face];
+                const tinyobj::index_t* indices  = chunk.mFaceIndices.data() + cursor;
+                cursor += faceSize;
+
+                if (faceSize < 3)
+                {
+                    continue;  // 退化面，tinyobj 同样跳过
+                }
+
+                if (faceSize == 4)
+                {
+                    const size_t i0 = static_cast<size_t>(indices[0].vertex_index) * 3;
+                    const size_t i1 = static_cast<size_t>(indices[1].vertex_index) * 3;
+                    const size_t i2 = static_cast<size_t>(indices[2].vertex_index) * 3;
+                    const size_t i3 = static_cast<size_t>(indices[3].vertex_index) * 3;
+
+                    const float e02x = v[i2 + 0] - v[i0 + 0];
+                    const float e02y = v[i2 + 1] - v[i0 + 1];
+                    const float e02z = v[i2 + 2] - v[i0 + 2];
+                    const float e13x = v[i3 + 0] - v[i1 + 0];
+                    const float e13y = v[i3 + 1] - v[i1 + 1];
+                    const float e13z = v[i3 + 2] - v[i1 + 2];
+
+                    const float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+                    const float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+                    if (sqr02 < sqr13)
+                    {
+                        chunk.mTriangles.insert(chunk.mTriangles.end(), { indices[0], indices[1], indices[2], indices[0], indices[2], indices[3] });
+                    }
+                    else
+                    {
+                        chunk.mTriangles.insert(chunk.mTriangles.end(), { indices[0], indices[1], indices[3], indices[1], indices[2], indices[3] });
+                    }
+                    continue;
+                }
+
+                for (uint32_t k = 1; k + 1 < faceSize; ++k)
+                {
+                    chunk.mTriangles.insert(chunk.mTriangles.end(), { indices[0], indices[k], indices[k + 1] });
+                }
+            }
+
+            while (next < chunk.mShapeBreaks.size())
+            {
+                chunk.mShapeBreaks[next++].mTriangle = chunk.mTriangles.size() / 3;
+            }
+
+            // 原始多边形数据已经用不到了
+            std::vector<tinyobj::index_t>().swap(chunk.mFaceIndices);
+            std::vector<uint32_t>().swap(chunk.mFaceSizes);
+        }
+
+        // 一段连续三角形（来自同一个块）拷贝到某个 shape 中的位置
+        struct ShapeSegment
+        {
+            size_t mChunk{ 0 };
+            size_t mBegin{ 0 };
+            size_t mEnd{ 0 };
+            size_t mShape{ 0 };
+            size_t mOffset{ 0 };
+        };
+    }
+
+    bool ObjParser::parse(const std::string& path,
+                          tinyobj::attrib_t& attrib,
+                          std::vector<tinyobj::shape_t>& shapes,
+                          std::string& err,
+                          uint32_t threadCount)
+    {
+        auto file = MappedFile::open(path);
+        if (!file)
+        {
+            err = "Error: cannot open obj file " + path;
+            return false;
+        }
+
+        return parse(reinterpret_cast<const char*>(file->getData()), file->getSize(), attrib, shapes, err, threadCount);
+    }
+
+    bool ObjParser::parse(const char* data,
+                          size_t size,
+                          tinyobj::attrib_t& attrib,
+                          std::vector<tinyobj::shape_t>& shapes,
+                          std::string& err,
+                          uint32_t threadCount)
+    {
+        attrib = tinyobj::attrib_t();
+        shapes.clear();
+
+        const size_t hardwareThreads = std::max<size_t>(1, threadCount ? threadCount : std::thread::hardware_concurrency());
+        const size_t chunkCount      = std::max<size_t>(1, std::min(hardwareThreads, size / MinChunkSize));
+
+        // 步骤1：按字节均分后把分界点推到下一行开头
+        std::vector<ObjChunk> chunks(chunkCount);
+        const char* end = data + size;
+
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            chunks[i].mBegin = i == 0 ? data : chunks[i - 1].mEnd;
+
+            if (i + 1 == chunkCount)
+            {
+                chunks[i].mEnd = end;
+            }
+            else
+            {
+                const char* split = std::max(chunks[i].mBegin, data + size * (i + 1) / chunkCount);
+                const char* lineEnd = findLineEnd(split, end);
+                chunks[i].mEnd = lineEnd < end ? lineEnd + 1 : end;
+            }
+        }
+
+        parallelFor(chunkCount, chunkCount, [&](size_t i) { countChunk(chunks[i]); });
+
+        // 步骤2：前缀和得到每块的全局起始编号，一次性分配最终数组
+        size_t vertexCount   = 0;
+        size_t texcoordCount = 0;
+        size_t normalCount   = 0;
+
+        for (auto& chunk : chunks)
+        {
+            chunk.mVertexBase   = vertexCount;
+            chunk.mTexcoordBase = texcoordCount;
+            chunk.mNormalBase   = normalCount;
+
+            vertexCount   += chunk.mVertexCount;
+            texcoordCount += chunk.mTexcoordCount;
+            normalCount   += chunk.mNormalCount;
+        }
+
+        attrib.vertices.resize(vertexCount * 3);
+        attrib.texcoords.resize(texcoordCount * 2);
+        attrib.normals.resize(normalCount * 3);
+
+        parallelFor(chunkCount, chunkCount, [&](size_t i) { parseChunk(chunks[i], attrib); });
+
+        for (const auto& chunk : chunks)
+        {
+            if (!chunk.mError.empty())
+            {
+                err = chunk.mError;
+                return false;
+            }
+        }
+
+        // 步骤3：三角化需要用到其它块的顶点位置，所以放在所有块解析完之后
+        parallelFor(chunkCount, chunkCount, [&](size_t i) { triangulateChunk(chunks[i], attrib); });
+
+        // 步骤4：按 g / o 切分 shape（空 shape 不输出），再把各段三角形并行拷贝到位
+        std::vector<ShapeSegment> segments{};
+        std::vector<size_t>       shapeTriangles{ 0 };
+        shapes.emplace_back();
+
+        for (size_t c = 0; c < chunkCount; ++c)
+        {
+            size_t begin = 0;
+
+            auto emitSegment = [&](size_t segmentEnd)
+            {
+                if (segmentEnd > begin)
+                {
+                    segments.push_back({ c, begin, segmentEnd, shapes.size() - 1, shapeTriangles.back() });
+                    shapeTriangles.back() += segmentEnd - begin;
+                }
+                begin = segmentEnd;
+            };
+
+            for (const auto& shapeBreak : chunks[c].mShapeBreaks)
+            {
+                emitSegment(shapeBreak.mTriangle);
+
+                if (shapeTriangles.back() > 0)
+                {
+                    shapes.emplace_back();
+                    shapeTriangles.push_back(0);
+                }
+
+                shapes.back().name = shapeBreak.mName;
+            }
+
+            emitSegment(chunks[c].mTriangles.size() / 3);
+        }
+
+        if (shapeTriangles.back() == 0)
+        {
+            shapes.pop_back();
+            shapeTriangles.pop_back();
+        }
+
+        for (size_t s = 0; s < shapes.size(); ++s)
+        {
+            auto& mesh = shapes[s].mesh;
+
+            mesh.indices.resize(shapeTriangles[s] * 3);
+            mesh.num_face_vertices.assign(shapeTriangles[s], 3);
+            mesh.material_ids.assign(shapeTriangles[s], -1);
+            mesh.smoothing_group_ids.assign(shapeTriangles[s], 0);
+        }
+
+        parallelFor(segments.size(), std::min(hardwareThreads, segments.size()), [&](size_t i)
+        {
+            const auto& segment = segments[i];
+            const auto& source  = chunks[segment.mChunk].mTriangles;
+
+            std::copy(source.begin() + segment.mBegin * 3,
+                      source.begin() + segment.mEnd * 3,
+                      shapes[segment.mShape].mesh.indices.begin() + segment.mOffset * 3);
+        });
+
+        return true;
+    }
+}
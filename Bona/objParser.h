@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "tiny_obj_loader.h"
+
+namespace LearnVulkan
+{
+    // 多线程分块 OBJ 解析器，输出与 tinyobj::LoadObj（默认参数，三角化）相同的 attrib / shapes，
+    // 供 Model 直接替换 tinyobj 的单线程路径。
+    //
+    // 流程：按行边界把文件切成若干块 -> 各块并行统计 v/vt/vn 数量 -> 前缀和得到各块的全局起始编号 ->
+    // 各块并行解析，顶点属性直接写入最终数组（无需合并拷贝），面索引就地解析相对索引 ->
+    // 各块并行三角化 -> 按 g/o 拼接成 shape。
+    //
+    // 只处理 Model 关心的几何数据：不读取 mtllib / usemtl（material_ids 全为 -1），不读取顶点色、
+    // 线段 / 点图元和平滑组；多于 4 个顶点的多边形按扇形三角化（tinyobj 会做耳切法）
+    class ObjParser
+    {
+    public:
+        /// 映射并解析 OBJ 文件；threadCount 为 0 时使用全部硬件线程。失败时返回 false 并写入 err
+        static bool parse(const std::string& path,
+                          tinyobj::attrib_t& attrib,
+                          std::vector<tinyobj::shape_t>& shapes,
+                          std::string& err,
+                          uint32_t threadCount = 0);
+
+        /// 解析内存中的 OBJ 文本（不要求以 '\0' 结尾）
+        static bool parse(const char* data,
+                          size_t size,
+                          tinyobj::attrib_t& attrib,
+                          std::vector<tinyobj::shape_t>& shapes,
+                          std::string& err,
+                          uint32_t threadCount = 0);
+    };
+}
@@ -0,0 +1,175 @@
+﻿#include "secondaryRecorder.h"
+
+namespace LearnVulkan
+{
+    SecondaryRecorder::SecondaryRecorder(const Wrapper::Device::Ptr& device, uint32_t threadCount, uint32_t frameCount)
+    {
+        mDevice = device;
+
+        const uint32_t threads = std::max(1u, threadCount);
+
+        mThreadFrames.resize(threads);
+
+        for (auto& frames : mThreadFrames)
+        {
+            frames.resize(std::max(1u, frameCount));
+
+            for (auto& frame : frames)
+            {
+                frame.mCommandPool = Wrapper::CommandPool::create(device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+            }
+        }
+
+        for (uint32_t i = 0; i < threads; ++i)
+        {
+            mWorkers.emplace_back(&SecondaryRecorder::workerLoop, this, i);
+        }
+    }
+
+    SecondaryRecorder::~SecondaryRecorder()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+
+        mWorkCondition.notify_all();
+
+        for (auto& worker : mWorkers)
+        {
+            worker.join();
+        }
+
+        // 命令缓冲区先于所属的命令池释放
+        for (auto& frames : mThreadFrames)
+        {
+            for (auto& frame : frames)
+            {
+                frame.mCommandBuffers.clear();
+                frame.mCommandPool.reset();
+            }
+        }
+    }
+
+    void SecondaryRecorder::beginFrame(uint32_t frame)
+    {
+        // 工作线程只在 record 期间访问命令池，此时都在等待，主线程可以直接重置
+        for (auto& frames : mThreadFrames)
+        {
+            frames[frame].mCommandPool->reset();
+            frames[frame].mUsed = 0;
+        }
+    }
+
+    std::vector<VkCommandBuffer> SecondaryRecorder::record(uint32_t frame,
+                                                           const VkCommandBufferInheritanceInfo& inheritance,
+                                                           uint32_t itemCount,
+                                                           const RecordRange& recordRange)
+    {
+        if (itemCount == 0)
+        {
+            return {};
+        }
+
+        // 按段数均分，段数不超过线程数，每段不少于 MinItemsPerSegment 个物体
+        const uint32_t segmentCount = std::min(getThreadCount(),
+                                               std::max(1u, itemCount / MinItemsPerSegment));
+
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mFrame        = frame;
+        mInheritance  = &inheritance;
+        mRecordRange  = &recordRange;
+        mItemCount    = itemCount;
+        mSegmentCount = segmentCount;
+        mResults.assign(segmentCount, VK_NULL_HANDLE);
+        mError        = nullptr;
+        mPending      = segmentCount;
+        ++mGeneration;
+
+        mWorkCondition.notify_all();
+        mDoneCondition.wait(lock, [this] { return mPending == 0; });
+
+        mInheritance = nullptr;
+        mRecordRange = nullptr;
+
+        if (mError)
+        {
+            std::rethrow_exception(mError);
+        }
+
+        return mResults;
+    }
+
+    void SecondaryRecorder::workerLoop(uint32_t thread)
+    {
+        uint64_t generation = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWorkCondition.wait(lock, [&] { return mStop || mGeneration != generation; });
+
+                if (mStop)
+                {
+                    return;
+                }
+
+                generation = mGeneration;
+
+                // 这一批的段数少于线程数时，多出的线程不参与
+                if (thread >= mSegmentCount)
+                {
+                    continue;
+                }
+            }
+
+            // 任务参数在 mPending 归零前不会改变，录制时不需要持锁
+            std::exception_ptr error{ nullptr };
+
+            try
+            {
+                recordSegment(thread);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (error && !mError)
+            {
+                mError = error;
+            }
+
+            if (--mPending == 0)
+            {
+                mDoneCondition.notify_one();
+            }
+        }
+    }
+
+    void SecondaryRecorder::recordSegment(uint32_t thread)
+    {
+        auto& frame = mThreadFrames[thread][mFrame];
+
+        // 命令池整池重置后命令缓冲区回到初始状态，直接复用；本帧用到的比以往多时才分配
+        if (frame.mUsed == frame.mCommandBuffers.size())
+        {
+            frame.mCommandBuffers.push_back(Wrapper::CommandBuffer::create(mDevice, frame.mCommandPool, true));
+        }
+
+        const auto& commandBuffer = frame.mCommandBuffers[frame.mUsed++];
+
+        const uint32_t begin = static_cast<uint32_t>(uint64_t(mItemCount) * thread / mSegmentCount);
+        const uint32_t end   = static_cast<uint32_t>(uint64_t(mItemCount) * (thread + 1) / mSegmentCount);
+
+        commandBuffer->begin(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, *mInheritance);
+        (*mRecordRange)(commandBuffer, begin, end);
+        commandBuffer->end();
+
+        mResults[thread] = commandBuffer->getCommandBuffer();
+    }
+}
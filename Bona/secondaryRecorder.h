@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include "vulkanWrapper/base.h"
+#include "vulkanWrapper/device.h"
+#include "vulkanWrapper/commandPool.h"
+#include "vulkanWrapper/commandBuffer.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <thread>
+
+namespace LearnVulkan
+{
+    // 多线程录制渲染通道内的绘制：把一段连续的物体切成若干段，每个工作线程把一段录进二级命令缓冲区，
+    // 主命令缓冲区以 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS 开始渲染通道，再用 vkCmdExecuteCommands 按段顺序执行。
+    //   - 命令池必须外部同步，所以每个线程、每个在途帧各有一个 TRANSIENT 命令池；帧开始时整池重置，二级命令缓冲区复用不释放
+    //   - 二级命令缓冲区不继承主命令缓冲区的状态，录制回调要自己绑定管线、顶点缓冲区和描述符集
+    //   - record 阻塞到所有段录完；同一帧内可以多次调用（如深度预渲染和颜色 Pass 分别切段，保证预渲染全部先执行）
+    class SecondaryRecorder
+    {
+    public:
+        using Ptr = std::shared_ptr<SecondaryRecorder>;
+
+        // 录制物体 [begin, end) 的回调，在工作线程上调用；命令缓冲区已按继承信息开始，返回后由录制器结束
+        using RecordRange = std::function<void(const Wrapper::CommandBuffer::Ptr& commandBuffer, uint32_t begin, uint32_t end)>;
+
+        // 每段至少的物体数：太短的段录制量抵不上线程唤醒和 vkCmdExecuteCommands 的开销
+        static constexpr uint32_t MinItemsPerSegment = 256;
+
+        static Ptr create(const Wrapper::Device::Ptr& device, uint32_t threadCount, uint32_t frameCount)
+        {
+            return std::make_shared<SecondaryRecorder>(device, threadCount, frameCount);
+        }
+
+        SecondaryRecorder(const Wrapper::Device::Ptr& device, uint32_t threadCount, uint32_t frameCount);
+
+        ~SecondaryRecorder();
+
+        /// 重置第 frame 帧所有线程的命令池；必须在该帧的栅栏等待之后、本帧第一次 record 之前调用
+        void beginFrame(uint32_t frame);
+
+        /// 把 itemCount 个物体切段并行录制，返回按段顺序排列的二级命令缓冲区；inheritance 需给出当前的渲染通道和帧缓冲
+        std::vector<VkCommandBuffer> record(uint32_t frame,
+                                            const VkCommandBufferInheritanceInfo& inheritance,
+                                            uint32_t itemCount,
+                                            const RecordRange& recordRange);
+
+        [[nodiscard]] auto getThreadCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+
+    private:
+        // 一个线程在一个在途帧内使用的命令池，mUsed 之前的命令缓冲区本帧已录制
+        struct ThreadFrame
+        {
+            Wrapper::CommandPool::Ptr                mCommandPool{ nullptr };
+            std::vector<Wrapper::CommandBuffer::Ptr> mCommandBuffers{};
+            size_t                                   mUsed{ 0 };
+        };
+
+        void workerLoop(uint32_t thread);
+
+        void recordSegment(uint32_t thread);
+
+    private:
+        Wrapper::Device::Ptr mDevice{ nullptr };
+
+        std::vector<std::vector<ThreadFrame>> mThreadFrames{};   // [线程][帧]，只由对应的工作线程录制
+
+        // 当前一批录制任务，record 期间只读；mGeneration 变化时工作线程开始录制自己那一段
+        uint32_t                              mFrame{ 0 };
+        const VkCommandBufferInheritanceInfo* mInheritance{ nullptr };
+        const RecordRange*                    mRecordRange{ nullptr };
+        uint32_t                              mItemCount{ 0 };
+        uint32_t                              mSegmentCount{ 0 };
+        std::vector<VkCommandBuffer>          mResults{};
+        std::exception_ptr                    mError{ nullptr };
+
+        std::vector<std::thread> mWorkers{};
+        std::mutex               mMutex{};
+        std::condition_variable  mWorkCondition{};
+        std::condition_variable  mDoneCondition{};
+        uint64_t                 mGeneration{ 0 };
+        uint32_t                 mPending{ 0 };
+        bool                     mStop{ false };
+    };
+}
@@ -0,0 +1,30 @@
+﻿// 深度预渲染：只读取位置流，写入深度，不输出颜色
+#version 450
+
+#extension GL_ARB_separate_shader_objects:enable
+
+layout(location = 0) in vec3 inPosition;  // 顶点位置（模型空间，量化格式时为归一化后的编码值）
+
+// 与 VertexShader.vert 的位置计算逐位一致，颜色 Pass 才能用 EQUAL 通过深度测试
+invariant gl_Position;
+
+layout(binding = 0) uniform VPMatrices
+{
+    mat4 mViewMatrix;
+    mat4 mProjectionMatrix;
+}vpUBO;
+
+layout(binding = 1) uniform ObjectUniform
+{
+    mat4 mModelMatrix;
+    vec4 mPositionScale;
+    vec4 mPositionOffset;
+    vec4 mUVTransform;
+}objectUBO;
+
+void main()
+{
+    vec3 position = inPosition * objectUBO.mPositionScale.xyz + objectUBO.mPositionOffset.xyz;
+
+    gl_Position = vpUBO.mProjectionMatrix * vpUBO.mViewMatrix * objectUBO.mModelMatrix * vec4(position, 1.0);
+}
@@ -5,14 +5,17 @@
 #extension GL_ARB_separate_shader_objects:enable
 
 // ---- 输入顶点属性 ----
-layout(location = 0) in vec3 inPosition;  // 顶点位置（模型空间）
+layout(location = 0) in vec3 inPosition;  // 顶点位置（模型空间，量化格式时为归一化后的编码值）
 //layout(location = 1) in vec3 inColor;     // 顶点颜色（RGB）
-layout(location = 1) in vec2 inUV;        // 纹理坐标（UV）
+layout(location = 1) in vec2 inUV;        // 纹理坐标（UV，量化格式时为 [0, 1] 编码值）
 
 // ---- 输出到片段着色器的数据 ----
 //layout(location = 0) out vec3 outColor;   // 传递顶点颜色
 layout(location = 1) out vec2 outUV;      // 传递纹理坐标
 
+// 深度预渲染（DepthPrepass.vert）之后颜色 Pass 以 EQUAL 做深度测试，两个着色器算出的位置必须逐位相同
+invariant gl_Position;
+
 // ---- 统一缓冲区（Uniform Buffers）----
 // 绑定点0：视图和投影矩阵（通常每帧更新一次）
 layout(binding = 0) uniform VPMatrices
@@ -25,18 +28,26 @@ layout(binding = 0) uniform VPMatrices
 layout(binding = 1) uniform ObjectUniform
 {
     mat4 mModelMatrix;                    // 模型空间 -> 世界空间变换
+    vec4 mPositionScale;                  // 反量化：position = inPosition * scale + offset
+    vec4 mPositionOffset;
+    vec4 mUVTransform;                    // 反量化：uv = inUV * xy + zw
 }objectUBO;
 
 // ===== 主函数 =====
 void main()
 {
+    // snorm16 / half / unorm16 由顶点输入阶段转换成浮点，这里只需还原包围盒缩放和偏移；
+    // 非量化格式时 scale = 1、offset = 0
+    vec3 position = inPosition * objectUBO.mPositionScale.xyz + objectUBO.mPositionOffset.xyz;
+    vec2 uv       = inUV * objectUBO.mUVTransform.xy + objectUBO.mUVTransform.zw;
+
     // 顶点位置变换流水线：
     // 1. 模型空间 -> 世界空间 (mModelMatrix)
     // 2. 世界空间 -> 观察空间 (mViewMatrix)
     // 3. 观察空间 -> 裁剪空间 (mProjectionMatrix)
-    gl_Position = vpUBO.mProjectionMatrix * vpUBO.mViewMatrix * objectUBO.mModelMatrix * vec4(inPosition, 1.0);
+    gl_Position = vpUBO.mProjectionMatrix * vpUBO.mViewMatrix * objectUBO.mModelMatrix * vec4(position, 1.0);
 
     // 传递颜色和纹理坐标到片段着色器
     //outColor = inColor;  // 输出原始顶点颜色
-    outUV = inUV;        // 输出原始UV坐标
+    outUV = uv;          // 输出还原后的UV坐标
 }
\ No newline at end of file
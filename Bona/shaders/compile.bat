@@ -2,4 +2,8 @@ C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V VertexShader.vert -o vs.spv
 
 C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V FragmentShader.frag -o fs.spv
 
+C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V MeshletCull.comp -o cull.spv
+
+C:\VulkanSDK\1.4.313.0\Bin\glslangValidator.exe  -V DepthPrepass.vert -o depth.spv
+
 pause
\ No newline at end of file
@@ -0,0 +1,590 @@
+﻿#include "blockCompressor.h"
+
+#include <cstring>
+#include <future>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BONA_BC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        // 按位从低到高拼出 128 位的压缩块（BC7 的字段不按字节对齐），小端存储
+        struct BitWriter
+        {
+            uint64_t mBits[2]{ 0, 0 };
+            uint32_t mPosition{ 0 };
+
+            void put(uint64_t value, uint32_t bits)
+            {
+                const uint32_t word  = mPosition >> 6;
+                const uint32_t shift = mPosition & 63;
+
+                mBits[word] |= value << shift;
+
+                // 跨越第 64 位的字段，高位部分写入第二个字
+                if (word == 0 && shift + bits > 64)
+                {
+                    mBits[1] |= value >> (64 - shift);
+                }
+
+                mPosition += bits;
+            }
+
+            void store(uint8_t* out) const
+            {
+                memcpy(out, mBits, sizeof(mBits));
+            }
+        };
+
+        // 取出 (blockX, blockY) 处的 4x4 块，超出图像的行 / 列复制边缘像素
+        void loadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* block)
+        {
+            const uint32_t x0 = blockX * 4;
+
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                const uint8_t* row = rgba + size_t(std::min(blockY * 4 + y, height - 1)) * width * 4;
+
+                if (x0 + 4 <= width)
+                {
+                    memcpy(block + y * 16, row + size_t(x0) * 4, 16);
+                    continue;
+                }
+
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    memcpy(block + y * 16 + x * 4, row + size_t(std::min(x0 + x, width - 1)) * 4, 4);
+                }
+            }
+        }
+
+        void blockMinMax(const uint8_t* block, int minColor[4], int maxColor[4])
+        {
+#ifdef BONA_BC_SSE2
+            const __m128i* p = reinterpret_cast<const __m128i*>(block);
+
+            __m128i lo = _mm_loadu_si128(p);
+            __m128i hi = lo;
+
+            for (int i = 1; i < 4; ++i)
+            {
+                const __m128i v = _mm_loadu_si128(p + i);
+                lo = _mm_min_epu8(lo, v);
+                hi = _mm_max_epu8(hi, v);
+            }
+
+            // 4 个像素槽位两两归约到第 0 个像素
+            lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 8));
+            lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 4));
+            hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 8));
+            hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 4));
+
+            const uint32_t packedMin = static_cast<uint32_t>(_mm_cvtsi128_si32(lo));
+            const uint32_t packedMax = static_cast<uint32_t>(_mm_cvtsi128_si32(hi));
+
+            for (int c = 0; c < 4; ++c)
+            {
+                minColor[c] = (packedMin >> (c * 8)) & 0xFF;
+                maxColor[c] = (packedMax >> (c * 8)) & 0xFF;
+            }
+#else
+            for (int c = 0; c < 4; ++c)
+            {
+                minColor[c] = 255;
+                maxColor[c] = 0;
+            }
+
+            for (int i = 0; i < 16; ++i)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    minColor[c] = std::min<int>(minColor[c], block[i * 4 + c]);
+                    maxColor[c] = std::max<int>(maxColor[c], block[i * 4 + c]);
+                }
+            }
+#endif
+        }
+
+        // 端点取包围盒的一条对角线：以范围最大的通道为参考，与其负相关的通道交换两端；再各自向内收缩范围的 1/16，
+        // 减少极值像素对中间插值点的影响。channels 为 3 时忽略 alpha
+        void selectEndpoints(const uint8_t* block, int channels, int endpoint0[4], int endpoint1[4])
+        {
+            int minColor[4], maxColor[4];
+            blockMinMax(block, minColor, maxColor);
+
+            int mean[4] = { 0, 0, 0, 0 };
+            for (int i = 0; i < 16; ++i)
+            {
+                for (int c = 0; c < channels; ++c)
+                {
+                    mean[c] += block[i * 4 + c];
+                }
+            }
+
+            int reference = 0;
+            for (int c = 0; c < channels; ++c)
+            {
+                mean[c] = (mean[c] + 8) / 16;
+
+                if (maxColor[c] - minColor[c] > maxColor[reference] - minColor[reference])
+                {
+                    reference = c;
+                }
+            }
+
+            for (int c = 0; c < 4; ++c)
+            {
+                const int inset = (maxColor[c] - minColor[c]) >> 4;
+
+                endpoint0[c] = c < channels ? minColor[c] + inset : 0;
+                endpoint1[c] = c < channels ? maxColor[c] - inset : 0;
+            }
+
+            for (int c = 0; c < channels; ++c)
+            {
+                if (c == reference)
+                {
+                    continue;
+                }
+
+                int covariance = 0;
+                for (int i = 0; i < 16; ++i)
+                {
+                    covariance += (block[i * 4 + c] - mean[c]) * (block[i * 4 + reference] - mean[reference]);
+                }
+
+                if (covariance < 0)
+                {
+                    std::swap(endpoint0[c], endpoint1[c]);
+                }
+            }
+        }
+
+        // 把每个像素投影到 endpoint0 -> endpoint1 的连线上，量化为 [0, steps]（0 对应 endpoint0）
+        void projectIndices(const uint8_t* block, const int endpoint0[4], const int endpoint1[4], int steps, int indices[16])
+        {
+            int direction[4];
+            int lengthSquared = 0;
+            int base          = 0;
+
+            for (int c = 0; c < 4; ++c)
+            {
+                direction[c]   = endpoint1[c] - endpoint0[c];
+                lengthSquared += direction[c] * direction[c];
+                base          += endpoint0[c] * direction[c];
+            }
+
+            if (lengthSquared == 0)
+            {
+                std::fill(indices, indices + 16, 0);
+                return;
+            }
+
+            const float scale = static_cast<float>(steps) / static_cast<float>(lengthSquared);
+
+#ifdef BONA_BC_SSE2
+            // 像素扩展成 16 位后与方向做 madd，得到每个像素的 RG 和 BA 两段部分点积，再两两相加
+            const __m128i zero      = _mm_setzero_si128();
+            const __m128i dir16     = _mm_setr_epi16(static_cast<short>(direction[0]), static_cast<short>(direction[1]),
+                                                     static_cast<short>(direction[2]), static_cast<short>(direction[3]),
+                                                     static_cast<short>(direction[0]), static_cast<short>(direction[1]),
+                                                     static_cast<short>(direction[2]), static_cast<short>(direction[3]));
+            const __m128  baseV     = _mm_set1_ps(static_cast<float>(base));
+            const __m128  scaleV    = _mm_set1_ps(scale);
+            const __m128  halfV     = _mm_set1_ps(0.5f);
+            const __m128  maxV      = _mm_set1_ps(static_cast<float>(steps));
+
+            for (int group = 0; group < 4; ++group)
+            {
+                const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + group * 16));
+
+                const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), dir16);
+                const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), dir16);
+
+                const __m128i rg = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+                const __m128i ba = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)));
+
+                __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_add_epi32(rg, ba)), baseV), scaleV);
+                t = _mm_min_ps(_mm_max_ps(_mm_add_ps(t, halfV), _mm_setzero_ps()), maxV);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + group * 4), _mm_cvttps_epi32(t));
+            }
+#else
+            for (int i = 0; i < 16; ++i)
+            {
+                int dot = 0;
+                for (int c = 0; c < 4; ++c)
+                {
+                    dot += block[i * 4 + c] * direction[c];
+                }
+
+                const float t = (static_cast<float>(dot - base)) * scale + 0.5f;
+                indices[i] = static_cast<int>(std::min(std::max(t, 0.0f), static_cast<float>(steps)));
+            }
+#endif
+        }
+
+        uint16_t packRgb565(const int color[4])
+        {
+            const int r = (color[0] * 31 + 127) / 255;
+            const int g = (color[1] * 63 + 127) / 255;
+            const int b = (color[2] * 31 + 127) / 255;
+
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        void unpackRgb565(uint16_t packed, int color[4])
+        {
+            const int r = (packed >> 11) & 31;
+            const int g = (packed >> 5) & 63;
+            const int b = packed & 31;
+
+            color[0] = (r << 3) | (r >> 2);
+            color[1] = (g << 2) | (g >> 4);
+            color[2] = (b << 3) | (b >> 2);
+            color[3] = 0;
+        }
+
+        // BC1 颜色块（也是 BC3 的后 8 字节）：始终使用 4 色模式（color0 > color1）
+        void compressColorBlock(const uint8_t* block, uint8_t* out)
+        {
+            int endpoint0[4], endpoint1[4];
+            selectEndpoints(block, 3, endpoint0, endpoint1);
+
+            uint16_t color0 = packRgb565(endpoint1);
+            uint16_t color1 = packRgb565(endpoint0);
+
+            if (color0 < color1)
+            {
+                std::swap(color0, color1);
+            }
+
+            uint32_t bits = 0;
+
+            if (color0 != color1)
+            {
+                // 索引按量化后的端点计算，和解码结果一致；投影值 0..3 对应调色板的 0, 2, 3, 1
+                int quantized0[4], quantized1[4], steps[16];
+                unpackRgb565(color0, quantized0);
+                unpackRgb565(color1, quantized1);
+
+                projectIndices(block, quantized0, quantized1, 3, steps);
+
+                static constexpr uint32_t paletteIndex[4] = { 0, 2, 3, 1 };
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    bits |= paletteIndex[steps[i]] << (i * 2);
+                }
+            }
+
+            out[0] = static_cast<uint8_t>(color0 & 0xFF);
+            out[1] = static_cast<uint8_t>(color0 >> 8);
+            out[2] = static_cast<uint8_t>(color1 & 0xFF);
+            out[3] = static_cast<uint8_t>(color1 >> 8);
+            memcpy(out + 4, &bits, sizeof(bits));
+        }
+
+        // BC4 单通道块（也是 BC3 的 alpha 和 BC5 的两个通道）：8 插值模式，value0 = 最大值，value1 = 最小值
+        void compressChannelBlock(const uint8_t* block, int channel, uint8_t* out)
+        {
+            uint8_t values[16];
+            for (int i = 0; i < 16; ++i)
+            {
+                values[i] = block[i * 4 + channel];
+            }
+
+            int minValue = 255, maxValue = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                minValue = std::min<int>(minValue, values[i]);
+                maxValue = std::max<int>(maxValue, values[i]);
+            }
+
+            out[0] = static_cast<uint8_t>(maxValue);
+            out[1] = static_cast<uint8_t>(minValue);
+            memset(out + 2, 0, 6);
+
+            if (maxValue == minValue)
+            {
+                return;
+            }
+
+            // t = round(7 * (v - min) / range)，即满足 14 * (v - min) >= (2k - 1) * range 的 k（1..7）的个数
+            const int range = maxValue - minValue;
+            int16_t   steps[16];
+
+#ifdef BONA_BC_SSE2
+            const __m128i zero     = _mm_setzero_si128();
+            const __m128i v        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+            const __m128i minV     = _mm_set1_epi16(static_cast<short>(minValue));
+            const __m128i fourteen = _mm_set1_epi16(14);
+
+            __m128i scaledLo = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(v, zero), minV), fourteen);
+            __m128i scaledHi = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(v, zero), minV), fourteen);
+            __m128i countLo  = zero;
+            __m128i countHi  = zero;
+
+            for (int k = 1; k <= 7; ++k)
+            {
+                // cmpgt(x, threshold - 1) 即 x >= threshold，结果为 -1，相减计数
+                const __m128i threshold = _mm_set1_epi16(static_cast<short>((2 * k - 1) * range - 1));
+                countLo = _mm_sub_epi16(countLo, _mm_cmpgt_epi16(scaledLo, threshold));
+                countHi = _mm_sub_epi16(countHi, _mm_cmpgt_epi16(scaledHi, threshold));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(steps), countLo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(steps + 8), countHi);
+#else
+            for (int i = 0; i < 16; ++i)
+            {
+                const int scaled = 14 * (values[i] - minValue);
+
+                steps[i] = 0;
+                for (int k = 1; k <= 7; ++k)
+                {
+                    steps[i] += scaled >= (2 * k - 1) * range ? 1 : 0;
+                }
+            }
+#endif
+
+            // 投影值 7 -> 索引 0（最大值），0 -> 索引 1（最小值），其余 t -> 8 - t
+            uint64_t bits = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                const int t     = steps[i];
+                const int index = t == 7 ? 0 : (t == 0 ? 1 : 8 - t);
+                bits |= uint64_t(index) << (i * 3);
+            }
+
+            for (int i = 0; i < 6; ++i)
+            {
+                out[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+            }
+        }
+
+        // 模式 6 的端点是 7 位值加一个所有通道共用的 P 位，选误差较小的 P 位
+        void quantizeMode6Endpoint(const int endpoint[4], int quantized[4], int& pBit)
+        {
+            int bestError = INT32_MAX;
+
+            for (int p = 0; p < 2; ++p)
+            {
+                int candidate[4];
+                int error = 0;
+
+                for (int c = 0; c < 4; ++c)
+                {
+                    candidate[c] = std::min(std::max((endpoint[c] - p + 1) >> 1, 0), 127);
+
+                    const int value = (candidate[c] << 1) | p;
+                    error += (value - endpoint[c]) * (value - endpoint[c]);
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    pBit      = p;
+                    std::copy(candidate, candidate + 4, quantized);
+                }
+            }
+        }
+
+        void compressBC7Block(const uint8_t* block, uint8_t* out)
+        {
+            int endpoint0[4], endpoint1[4];
+            selectEndpoints(block, 4, endpoint0, endpoint1);
+
+            int quantized[2][4], pBits[2];
+            quantizeMode6Endpoint(endpoint0, quantized[0], pBits[0]);
+            quantizeMode6Endpoint(endpoint1, quantized[1], pBits[1]);
+
+            int expanded[2][4];
+            for (int e = 0; e < 2; ++e)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    expanded[e][c] = (quantized[e][c] << 1) | pBits[e];
+                }
+            }
+
+            // 16 级插值权重接近等距（0, 4, 9, ... 64），直接按等距投影
+            int indices[16];
+            projectIndices(block, expanded[0], expanded[1], 15, indices);
+
+            // 第 0 个像素是锚点，索引只存 3 位，最高位必须为 0：否则交换端点并翻转所有索引
+            if (indices[0] & 8)
+            {
+                std::swap(quantized[0], quantized[1]);
+                std::swap(pBits[0], pBits[1]);
+
+                for (int& index : indices)
+                {
+                    index = 15 - index;
+                }
+            }
+
+            BitWriter writer{};
+
+            writer.put(1u << 6, 7);
+
+            for (int c = 0; c < 4; ++c)
+            {
+                writer.put(static_cast<uint32_t>(quantized[0][c]), 7);
+                writer.put(static_cast<uint32_t>(quantized[1][c]), 7);
+            }
+
+            writer.put(static_cast<uint32_t>(pBits[0]), 1);
+            writer.put(static_cast<uint32_t>(pBits[1]), 1);
+
+            for (int i = 0; i < 16; ++i)
+            {
+                writer.put(static_cast<uint32_t>(indices[i]), i == 0 ? 3 : 4);
+            }
+
+            writer.store(out);
+        }
+    }
+
+    VkFormat BlockCompressor::getVkFormat(BlockFormat format)
+    {
+        switch (format)
+        {
+        case BlockFormat::BC1: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        case BlockFormat::BC3: return VK_FORMAT_BC3_SRGB_BLOCK;
+        case BlockFormat::BC4: return VK_FORMAT_BC4_UNORM_BLOCK;
+        case BlockFormat::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+        case BlockFormat::BC7: return VK_FORMAT_BC7_SRGB_BLOCK;
+        default:               return VK_FORMAT_R8G8B8A8_SRGB;
+        }
+    }
+
+    uint32_t BlockCompressor::getBlockBytes(BlockFormat format)
+    {
+        switch (format)
+        {
+        case BlockFormat::BC1:
+        case BlockFormat::BC4: return 8;
+        case BlockFormat::BC3:
+        case BlockFormat::BC5:
+        case BlockFormat::BC7: return 16;
+        default:               return 0;
+        }
+    }
+
+    VkDeviceSize BlockCompressor::getLevelSize(BlockFormat format, uint32_t width, uint32_t height)
+    {
+        return VkDeviceSize((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(format);
+    }
+
+    std::vector<uint8_t> BlockCompressor::compress(const uint8_t* rgba,
+                                                   const std::vector<Wrapper::MipLevel>& levels,
+                                                   BlockFormat format,
+                                                   std::vector<Wrapper::MipLevel>& compressedLevels,
+                                                   uint32_t threadCount)
+    {
+        const uint32_t blockBytes = getBlockBytes(format);
+
+        if (blockBytes == 0)
+        {
+            throw std::runtime_error("Error: unsupported block compression format!");
+        }
+
+        // 步骤1：计算各级输出位置，并把所有级别的块行排成一个任务列表（小级别的块行很少，合并后负载更均匀）
+        struct BlockRow
+        {
+            uint32_t mLevel{ 0 };
+            uint32_t mBlockY{ 0 };
+        };
+
+        std::vector<BlockRow> rows{};
+        VkDeviceSize totalSize = 0;
+
+        compressedLevels.clear();
+        compressedLevels.reserve(levels.size());
+
+        for (uint32_t level = 0; level < levels.size(); ++level)
+        {
+            compressedLevels.push_back({ totalSize, levels[level].mWidth, levels[level].mHeight });
+            totalSize += (getLevelSize(format, levels[level].mWidth, levels[level].mHeight) + 15) & ~VkDeviceSize(15);
+
+            for (uint32_t blockY = 0; blockY < (levels[level].mHeight + 3) / 4; ++blockY)
+            {
+                rows.push_back({ level, blockY });
+            }
+        }
+
+        std::vector<uint8_t> compressed(totalSize);
+
+        // 步骤2：块行交错分给各线程，每个块独立编码，互不写同一位置
+        const size_t hardwareThreads = std::max<size_t>(1, threadCount ? threadCount : std::thread::hardware_concurrency());
+        const size_t workerCount     = std::max<size_t>(1, std::min(rows.size(), hardwareThreads));
+
+        auto compressRows = [&](size_t worker)
+        {
+            alignas(16) uint8_t block[64];
+
+            for (size_t i = worker; i < rows.size(); i += workerCount)
+            {
+                const auto& source = levels[rows[i].mLevel];
+                const auto& target = compressedLevels[rows[i].mLevel];
+
+                const uint32_t blocksX = (source.mWidth + 3) / 4;
+                uint8_t*       out     = compressed.data() + target.mOffset + size_t(rows[i].mBlockY) * blocksX * blockBytes;
+
+                for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+                {
+                    loadBlock(rgba + source.mOffset, source.mWidth, source.mHeight, blockX, rows[i].mBlockY, block);
+                    compressBlock(block, format, out + size_t(blockX) * blockBytes);
+                }
+            }
+        };
+
+        std::vector<std::future<void>> workers{};
+
+        for (size_t worker = 1; worker < workerCount; ++worker)
+        {
+            workers.push_back(std::async(std::launch::async, compressRows, worker));
+        }
+
+        compressRows(0);
+
+        for (auto& worker : workers)
+        {
+            worker.get();
+        }
+
+        return compressed;
+    }
+
+    void BlockCompressor::compressBlock(const uint8_t* pixels, BlockFormat format, uint8_t* out)
+    {
+        switch (format)
+        {
+        case BlockFormat::BC1:
+            compressColorBlock(pixels, out);
+            break;
+        case BlockFormat::BC3:
+            compressChannelBlock(pixels, 3, out);
+            compressColorBlock(pixels, out + 8);
+            break;
+        case BlockFormat::BC4:
+            compressChannelBlock(pixels, 0, out);
+            break;
+        case BlockFormat::BC5:
+            compressChannelBlock(pixels, 0, out);
+            compressChannelBlock(pixels, 1, out + 8);
+            break;
+        case BlockFormat::BC7:
+            compressBC7Block(pixels, out);
+            break;
+        default:
+            break;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+#include "../vulkanWrapper/image.h"
+
+namespace LearnVulkan
+{
+    // 块压缩格式（4x4 像素一块）。BC1 / BC3 / BC7 按 sRGB 颜色上传，BC4 / BC5 按线性数据上传（遮罩、法线 XY）
+    enum class BlockFormat : uint32_t
+    {
+        None,
+        BC1,    // RGB，8 字节 / 块，丢弃 alpha
+        BC3,    // RGB + 插值 alpha，16 字节 / 块
+        BC4,    // 单通道（取 R），8 字节 / 块
+        BC5,    // 双通道（取 RG），16 字节 / 块
+        BC7     // RGBA，16 字节 / 块，只使用模式 6（单分区、7 位端点 + P 位、4 位索引）
+    };
+
+    // CPU 端块压缩编码器：端点取包围盒对角线（按协方差符号选对角、向内收缩 1/16），索引沿端点连线投影量化。
+    // 包围盒和索引计算用 SSE2 一次处理 4 个像素 / 16 个通道值，其余平台走标量路径；块之间互不依赖，按块行多线程并行
+    class BlockCompressor
+    {
+    public:
+        [[nodiscard]] static VkFormat getVkFormat(BlockFormat format);
+
+        /// 每块字节数（8 或 16），None 时为 0
+        [[nodiscard]] static uint32_t getBlockBytes(BlockFormat format);
+
+        /// 一级 width x height 图像压缩后的字节数（不足 4 的边按整块计算）
+        [[nodiscard]] static VkDeviceSize getLevelSize(BlockFormat format, uint32_t width, uint32_t height);
+
+        /// 压缩整条 RGBA8 mip 链，levels 为链中各级的偏移和尺寸（如 MipmapGenerator::build 的输出）。
+        /// compressedLevels 输出压缩后各级的偏移（16 字节对齐）和尺寸，可直接用于 UploadContext::uploadImageLevels。
+        /// 所有级别的块行合在一起交错分给各线程，threadCount 为 0 时使用全部硬件线程
+        static std::vector<uint8_t> compress(const uint8_t* rgba,
+                                             const std::vector<Wrapper::MipLevel>& levels,
+                                             BlockFormat format,
+                                             std::vector<Wrapper::MipLevel>& compressedLevels,
+                                             uint32_t threadCount = 0);
+
+        /// 压缩一个 4x4 块（16 个行优先的 RGBA8 像素），输出 getBlockBytes(format) 字节
+        static void compressBlock(const uint8_t* pixels, BlockFormat format, uint8_t* out);
+    };
+}
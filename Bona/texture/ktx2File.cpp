@@ -0,0 +1,281 @@
+﻿#include "ktx2File.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifdef BONA_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace LearnVulkan
+{
+    namespace
+    {
+        constexpr uint8_t Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };   // «KTX 20»\r\n\x1A\n
+
+        // 文件头和索引，字段均为小端；从标识符开始算 sgdByteOffset 恰好 8 字节对齐，结构体没有填充
+        struct Ktx2Header
+        {
+            uint8_t  mIdentifier[12]{};
+            uint32_t mVkFormat{ 0 };
+            uint32_t mTypeSize{ 0 };
+            uint32_t mPixelWidth{ 0 };
+            uint32_t mPixelHeight{ 0 };
+            uint32_t mPixelDepth{ 0 };
+            uint32_t mLayerCount{ 0 };
+            uint32_t mFaceCount{ 0 };
+            uint32_t mLevelCount{ 0 };
+            uint32_t mSupercompressionScheme{ 0 };
+            uint32_t mDfdByteOffset{ 0 };
+            uint32_t mDfdByteLength{ 0 };
+            uint32_t mKvdByteOffset{ 0 };
+            uint32_t mKvdByteLength{ 0 };
+            uint64_t mSgdByteOffset{ 0 };
+            uint64_t mSgdByteLength{ 0 };
+        };
+
+        struct Ktx2LevelIndex
+        {
+            uint64_t mByteOffset{ 0 };
+            uint64_t mByteLength{ 0 };
+            uint64_t mUncompressedByteLength{ 0 };
+        };
+
+        static_assert(sizeof(Ktx2Header) == 80, "KTX2 header layout");
+        static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level index layout");
+
+        struct FormatBlock
+        {
+            uint32_t mWidth{ 1 };
+            uint32_t mHeight{ 1 };
+            uint32_t mBytes{ 0 };
+        };
+
+        // 支持的格式及其纹素块大小，0 字节表示不支持
+        FormatBlock getFormatBlock(VkFormat format)
+        {
+            switch (format)
+            {
+            case VK_FORMAT_R8_UNORM:
+            case VK_FORMAT_R8_SRGB:
+                return { 1, 1, 1 };
+
+            case VK_FORMAT_R8G8_UNORM:
+            case VK_FORMAT_R8G8_SRGB:
+                return { 1, 1, 2 };
+
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+            case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+            case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+            case VK_FORMAT_R16G16_SFLOAT:
+            case VK_FORMAT_R32_SFLOAT:
+                return { 1, 1, 4 };
+
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            case VK_FORMAT_R32G32_SFLOAT:
+                return { 1, 1, 8 };
+
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                return { 1, 1, 16 };
+
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+            case VK_FORMAT_BC4_SNORM_BLOCK:
+                return { 4, 4, 8 };
+
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+            case VK_FORMAT_BC5_SNORM_BLOCK:
+            case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+            case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                return { 4, 4, 16 };
+
+            default:
+                return { 1, 1, 0 };
+            }
+        }
+    }
+
+    bool Ktx2File::isKtx2Path(const std::string& path)
+    {
+        constexpr const char* extension = ".ktx2";
+        constexpr size_t      length    = 5;
+
+        if (path.size() < length)
+        {
+            return false;
+        }
+
+        return std::equal(path.end() - length, path.end(), extension, [](char a, char b)
+        {
+            return std::tolower(static_cast<unsigned char>(a)) == b;
+        });
+    }
+
+    Ktx2File::Ptr Ktx2File::open(const std::string& path)
+    {
+        auto file = MappedFile::open(path);
+
+        if (!file)
+        {
+            throw std::runtime_error("Error: failed to open KTX2 file " + path);
+        }
+
+        return std::make_shared<Ktx2File>(file, path);
+    }
+
+    Ktx2File::Ktx2File(const MappedFile::Ptr& file, const std::string& path)
+    {
+        mFile = file;
+        mPath = path;
+
+        const uint8_t* data     = mFile->getData();
+        const uint64_t fileSize = mFile->getSize();
+
+        auto fail = [&](const char* reason)
+        {
+            return std::runtime_error(std::string("Error: ") + reason + " in KTX2 file " + mPath);
+        };
+
+        // 步骤1：标识符和文件头
+        if (fileSize < sizeof(Ktx2Header) || memcmp(data, Identifier, sizeof(Identifier)) != 0)
+        {
+            throw fail("invalid identifier");
+        }
+
+        Ktx2Header header{};
+        memcpy(&header, data, sizeof(header));
+
+        mFormat           = static_cast<VkFormat>(header.mVkFormat);
+        mWidth            = header.mPixelWidth;
+        mHeight           = header.mPixelHeight;
+        mLayerCount       = std::max(1u, header.mLayerCount);
+        mSupercompression = static_cast<Supercompression>(header.mSupercompressionScheme);
+
+        const FormatBlock block = getFormatBlock(mFormat);
+
+        if (block.mBytes == 0)
+        {
+            throw fail("unsupported vkFormat (Basis Universal or unknown format)");
+        }
+
+        if (mWidth == 0 || mHeight == 0 || header.mPixelDepth > 1 || header.mFaceCount != 1)
+        {
+            throw fail("unsupported dimensions (only 2D textures and 2D arrays are supported)");
+        }
+
+        if (mSupercompression != Supercompression::None && mSupercompression != Supercompression::Zstd)
+        {
+            throw fail("unsupported supercompression scheme");
+        }
+
+#ifndef BONA_HAS_ZSTD
+        if (mSupercompression == Supercompression::Zstd)
+        {
+            throw fail("zstd supercompression requires building with libzstd");
+        }
+#endif
+
+        // 步骤2：级别索引。levelCount 为 0 表示由加载方生成 mip，这里只上传第 0 级
+        const uint32_t levelCount = std::max(1u, header.mLevelCount);
+        const uint64_t indexStart = sizeof(Ktx2Header);
+
+        if (levelCount > Wrapper::Image::getMipLevelCount(mWidth, mHeight) ||
+            indexStart + uint64_t(levelCount) * sizeof(Ktx2LevelIndex) > fileSize)
+        {
+            throw fail("invalid level index");
+        }
+
+        mLevels.resize(levelCount);
+
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            Ktx2LevelIndex index{};
+            memcpy(&index, data + indexStart + uint64_t(level) * sizeof(Ktx2LevelIndex), sizeof(index));
+
+            const uint64_t width   = std::max(mWidth >> level, 1u);
+            const uint64_t height  = std::max(mHeight >> level, 1u);
+            const uint64_t blocksX = (width + block.mWidth - 1) / block.mWidth;
+            const uint64_t blocksY = (height + block.mHeight - 1) / block.mHeight;
+
+            mLevels[level].mByteOffset = index.mByteOffset;
+            mLevels[level].mByteLength = index.mByteLength;
+            mLevels[level].mSize       = blocksX * blocksY * block.mBytes * mLayerCount;
+
+            // 数据必须完整落在文件内，解压后的长度必须正好是这一级所有层的大小
+            const uint64_t expectedLength = mSupercompression == Supercompression::None ? index.mByteLength : index.mUncompressedByteLength;
+
+            if (index.mByteOffset > fileSize || index.mByteLength > fileSize - index.mByteOffset || expectedLength < mLevels[level].mSize)
+            {
+                throw fail("level data out of range");
+            }
+        }
+    }
+
+    VkDeviceSize Ktx2File::getUploadLayout(std::vector<Wrapper::MipLevel>& levels) const
+    {
+        levels.clear();
+        levels.reserve(mLevels.size());
+
+        VkDeviceSize totalSize = 0;
+
+        for (uint32_t level = 0; level < mLevels.size(); ++level)
+        {
+            levels.push_back({ totalSize, std::max(mWidth >> level, 1u), std::max(mHeight >> level, 1u) });
+            totalSize += (mLevels[level].mSize + 15) & ~VkDeviceSize(15);
+        }
+
+        return totalSize;
+    }
+
+    void Ktx2File::readLevels(uint8_t* dst) const
+    {
+        std::vector<Wrapper::MipLevel> levels{};
+        getUploadLayout(levels);
+
+        for (uint32_t level = 0; level < mLevels.size(); ++level)
+        {
+            readLevel(level, dst + levels[level].mOffset);
+        }
+    }
+
+    void Ktx2File::readLevel(uint32_t level, uint8_t* dst) const
+    {
+        const uint8_t* src  = mFile->getData() + mLevels[level].mByteOffset;
+        const size_t   size = static_cast<size_t>(mLevels[level].mSize);
+
+        if (mSupercompression == Supercompression::None)
+        {
+            memcpy(dst, src, size);
+            return;
+        }
+
+#ifdef BONA_HAS_ZSTD
+        // 每一级是一个独立的 zstd 帧。zstd 解压会回读已输出的数据（匹配复制），
+        // dst 可能是写合并的显存映射，先解到主机内存再顺序拷贝
+        std::vector<uint8_t> scratch(size);
+
+        const size_t result = ZSTD_decompress(scratch.data(), size, src, static_cast<size_t>(mLevels[level].mByteLength));
+
+        if (ZSTD_isError(result) || result != size)
+        {
+            throw std::runtime_error("Error: failed to decompress zstd level in KTX2 file " + mPath);
+        }
+
+        memcpy(dst, scratch.data(), size);
+#endif
+    }
+}
@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+#include "../vulkanWrapper/image.h"
+#include "../mappedFile.h"
+
+namespace LearnVulkan
+{
+    // KTX2 纹理容器：映射文件后只解析文件头和级别索引，像素按 GPU 格式（vkFormat）原样存放，
+    // 上传时直接从映射拷贝或解压进暂存区，不经过图像解码和格式转换。
+    // 支持预生成的 mip 链和 2D 纹理数组；不支持立方体贴图、3D 纹理、Basis Universal 和 zlib 超压缩。
+    // zstd 超压缩需要构建时找到 libzstd（定义 BONA_HAS_ZSTD），否则打开这类文件时抛异常
+    class Ktx2File
+    {
+    public:
+        using Ptr = std::shared_ptr<Ktx2File>;
+
+        enum class Supercompression : uint32_t
+        {
+            None    = 0,
+            BasisLZ = 1,
+            Zstd    = 2,
+            Zlib    = 3
+        };
+
+        /// 按扩展名（.ktx2，不区分大小写）判断
+        static bool isKtx2Path(const std::string& path);
+
+        /// 映射并校验文件头和级别索引，文件不存在、损坏或格式不支持时抛异常
+        static Ptr open(const std::string& path);
+
+        Ktx2File(const MappedFile::Ptr& file, const std::string& path);
+
+        ~Ktx2File() = default;
+
+        /// 上传数据的总字节数；levels 输出每级在上传数据中的偏移（16 字节对齐）和尺寸，每级内各数组层紧密排列
+        VkDeviceSize getUploadLayout(std::vector<Wrapper::MipLevel>& levels) const;
+
+        /// 按 getUploadLayout 的布局把所有级别写到 dst，zstd 超压缩的级别在这里解压
+        void readLevels(uint8_t* dst) const;
+
+        /// 只读取第 level 级（所有数组层）到 dst，可在任意线程调用
+        void readLevel(uint32_t level, uint8_t* dst) const;
+
+        [[nodiscard]] auto getFormat()           const { return mFormat; }
+        [[nodiscard]] auto getWidth()            const { return mWidth; }
+        [[nodiscard]] auto getHeight()           const { return mHeight; }
+        [[nodiscard]] auto getLayerCount()       const { return mLayerCount; }
+        [[nodiscard]] auto getLevelCount()       const { return static_cast<uint32_t>(mLevels.size()); }
+        [[nodiscard]] auto getSupercompression() const { return mSupercompression; }
+
+    private:
+        struct Level
+        {
+            uint64_t     mByteOffset{ 0 };   // 文件中的位置
+            uint64_t     mByteLength{ 0 };   // 文件中的长度（超压缩后）
+            VkDeviceSize mSize{ 0 };         // 解压后的长度（所有数组层）
+        };
+
+    private:
+        MappedFile::Ptr    mFile{ nullptr };
+        std::string        mPath{};
+        VkFormat           mFormat{ VK_FORMAT_UNDEFINED };
+        uint32_t           mWidth{ 0 };
+        uint32_t           mHeight{ 0 };
+        uint32_t           mLayerCount{ 1 };
+        Supercompression   mSupercompression{ Supercompression::None };
+        std::vector<Level> mLevels{};
+    };
+}
@@ -0,0 +1,107 @@
+﻿#include "mipmapGenerator.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BONA_MIPMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace LearnVulkan
+{
+    std::vector<uint8_t> MipmapGenerator::build(const uint8_t* rgba, uint32_t width, uint32_t height, std::vector<Wrapper::MipLevel>& levels)
+    {
+        const uint32_t levelCount = Wrapper::Image::getMipLevelCount(width, height);
+
+        levels.clear();
+        levels.reserve(levelCount);
+
+        VkDeviceSize totalSize = 0;
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            const uint32_t levelWidth  = std::max(width >> level, 1u);
+            const uint32_t levelHeight = std::max(height >> level, 1u);
+
+            levels.push_back({ totalSize, levelWidth, levelHeight });
+
+            // 每级起点对齐到 16 字节，满足 bufferOffset 需为纹素大小倍数的要求
+            totalSize += (VkDeviceSize(levelWidth) * levelHeight * 4 + 15) & ~VkDeviceSize(15);
+        }
+
+        std::vector<uint8_t> chain(totalSize);
+        memcpy(chain.data(), rgba, size_t(width) * height * 4);
+
+        for (uint32_t level = 1; level < levelCount; ++level)
+        {
+            const auto& prev = levels[level - 1];
+            downsample(chain.data() + prev.mOffset, prev.mWidth, prev.mHeight, chain.data() + levels[level].mOffset);
+        }
+
+        return chain;
+    }
+
+    void MipmapGenerator::downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst)
+    {
+        const uint32_t dstWidth  = std::max(srcWidth / 2, 1u);
+        const uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+        const size_t   srcPitch  = size_t(srcWidth) * 4;
+
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            // 高度为 1 或奇数时用同一行代替不存在的下一行
+            const uint8_t* row0 = src + size_t(std::min(y * 2, srcHeight - 1)) * srcPitch;
+            const uint8_t* row1 = src + size_t(std::min(y * 2 + 1, srcHeight - 1)) * srcPitch;
+            uint8_t*       out  = dst + size_t(y) * dstWidth * 4;
+
+            uint32_t x = 0;
+
+#ifdef BONA_MIPMAP_SSE2
+            // 每次读两行各 8 个源像素（32 字节），输出 4 个像素；需要 2x + 7 < srcWidth
+            const __m128i zero  = _mm_setzero_si128();
+            const __m128i round = _mm_set1_epi16(2);
+
+            auto sumPairs = [&](__m128i a, __m128i b)
+            {
+                // a / b 为上下两行的 4 个像素，结果的 8 个 16 位通道为 2 个输出像素的 4 点之和
+                const __m128i lo  = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                const __m128i hi  = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                const __m128i sLo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                const __m128i sHi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+                return _mm_unpacklo_epi64(sLo, sHi);
+            };
+
+            if (srcWidth >= 2)
+            {
+                for (; x + 4 <= dstWidth && size_t(x) * 2 + 8 <= srcWidth; x += 4)
+                {
+                    const uint8_t* p0 = row0 + size_t(x) * 8;
+                    const uint8_t* p1 = row1 + size_t(x) * 8;
+
+                    const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p0));
+                    const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p0 + 16));
+                    const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1));
+                    const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1 + 16));
+
+                    const __m128i s01 = _mm_srli_epi16(_mm_add_epi16(sumPairs(a0, b0), round), 2);
+                    const __m128i s23 = _mm_srli_epi16(_mm_add_epi16(sumPairs(a1, b1), round), 2);
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + size_t(x) * 4), _mm_packus_epi16(s01, s23));
+                }
+            }
+#endif
+
+            for (; x < dstWidth; ++x)
+            {
+                // 宽度为 1 或奇数时用同一列代替不存在的右侧列
+                const size_t c0 = size_t(std::min(x * 2, srcWidth - 1)) * 4;
+                const size_t c1 = size_t(std::min(x * 2 + 1, srcWidth - 1)) * 4;
+
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    const uint32_t sum = row0[c0 + channel] + row0[c1 + channel] + row1[c0 + channel] + row1[c1 + channel];
+                    out[size_t(x) * 4 + channel] = static_cast<uint8_t>((sum + 2) >> 2);
+                }
+            }
+        }
+    }
+}
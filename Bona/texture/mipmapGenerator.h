@@ -0,0 +1,19 @@
+﻿#pragma once
+
+#include "../vulkanWrapper/base.h"
+#include "../vulkanWrapper/image.h"
+
+namespace LearnVulkan
+{
+    // CPU 端 mip 链生成：2x2 盒式滤波，逐级从上一级降采样，奇数尺寸时最后一行 / 列与自身平均。
+    // 主路径用 SSE2 一次处理 4 个输出像素（16 位累加、四舍五入），其余平台和行尾走标量路径
+    class MipmapGenerator
+    {
+    public:
+        /// 生成包含第 0 级在内的完整 mip 链，所有级别依次紧密拼接在返回的数组中，levels 输出每级的偏移和尺寸
+        static std::vector<uint8_t> build(const uint8_t* rgba, uint32_t width, uint32_t height, std::vector<Wrapper::MipLevel>& levels);
+
+        /// 把 srcWidth x srcHeight 的 RGBA8 图像降采样到 max(srcWidth / 2, 1) x max(srcHeight / 2, 1)
+        static void downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst);
+    };
+}
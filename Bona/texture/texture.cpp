@@ -1,42 +1,197 @@
 ﻿#include "texture.h"
+#include "mipmapGenerator.h"
+#include "../meshCache.h"
+
+// stb_image 的分配都走 UploadContext 的主机内存：大块分配按页对齐，解码结果可以直接导入为复制源
+#define STBI_MALLOC(size)                       LearnVulkan::Wrapper::UploadContext::allocateHostMemory(size)
+#define STBI_REALLOC_SIZED(p, oldSize, newSize) LearnVulkan::Wrapper::UploadContext::reallocateHostMemory(p, oldSize, newSize)
+#define STBI_FREE(p)                            LearnVulkan::Wrapper::UploadContext::freeHostMemory(p)
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "../stb_image.h"
 
+#include <algorithm>
+#include <future>
+#include <thread>
+
 namespace LearnVulkan
 {
-    Texture::Texture(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, const std::string& imageFilePath)
+    namespace
     {
-        mDevice = device;
+        // .bccache 中的数据段
+        enum TextureCacheSection : uint32_t
+        {
+            LevelsSection = 0,   // Wrapper::MipLevel 数组
+            BlocksSection = 1    // 各级压缩块，偏移见 LevelsSection
+        };
 
-        // -------------------- 步骤1：加载图像文件数据（CPU 内存） --------------------
-        int texWidth, texHeight, texSize, texChannles;
+        // 缓存键的导入选项：低 8 位为 BlockFormat
+        constexpr uint32_t CacheFlagMipmaps = 1u << 8;
 
-        // 使用 stb_image 库加载图像文件（跨平台轻量级图像加载库）
-        // 参数说明：
-        //   imageFilePath.c_str(): 图像文件路径
-        //   &texWidth/&texHeight: 输出图像宽高（像素）
-        //   &texChannles: 输出原始通道数（如 RGB=3，RGBA=4）
-        //   STBI_rgb_alpha: 强制转换为 RGBA 格式（4 通道，忽略原始通道数）
-        stbi_uc* pixels = stbi_load(imageFilePath.c_str(),
-                                    &texWidth,
-                                    &texHeight,
-                                    &texChannles,
-                                    STBI_rgb_alpha);
+        // 上传数据是一块 CPU 内存（整条 mip 链按 data.mLevels 排列）：整体或按级别拷进暂存区，数据由回调持有到上传为止
+        void copyFrom(Texture::Data& data, std::shared_ptr<const void> owner, const void* bytes, VkDeviceSize size)
+        {
+            const auto* source = static_cast<const uint8_t*>(bytes);
+            const auto  levels = data.mLevels;
 
-        if (!pixels)  // 加载失败处理
+            data.mSize  = size;
+            data.mWrite = [owner, source, size](uint8_t* staging)
+            {
+                memcpy(staging, source, static_cast<size_t>(size));
+            };
+
+            // 第 i 级占 [levels[i].mOffset, levels[i + 1].mOffset)，含级别之间的对齐填充
+            data.mWriteLevel = [owner, source, size, levels](uint32_t level, uint8_t* dst)
+            {
+                const VkDeviceSize begin = levels[level].mOffset;
+                const VkDeviceSize end   = level + 1 < levels.size() ? levels[level + 1].mOffset : size;
+
+                memcpy(dst, source + begin, static_cast<size_t>(end - begin));
+            };
+        }
+
+        // 把 1 ~ 3 通道的像素扩展成 RGBA 写进暂存区：灰度复制到 RGB，缺少的 alpha 取 255
+        Wrapper::UploadContext::StagingWriter expandToRgba(std::shared_ptr<stbi_uc> pixels, int channels, size_t pixelCount)
         {
-            throw std::runtime_error("Error: failed to read image data!");
+            return [pixels, channels, pixelCount](uint8_t* staging)
+            {
+                const stbi_uc* src = pixels.get();
+
+                for (size_t i = 0; i < pixelCount; ++i, src += channels, staging += 4)
+                {
+                    const bool gray = channels < 3;
+
+                    staging[0] = src[0];
+                    staging[1] = gray ? src[0] : src[1];
+                    staging[2] = gray ? src[0] : src[2];
+                    staging[3] = channels == 2 ? src[1] : 255;
+                }
+            };
+        }
+    }
+
+    std::vector<Texture::Data> Texture::decodeAll(const Wrapper::Device::Ptr& device, const std::vector<Source>& sources, uint32_t threadCount)
+    {
+        // 各纹理在工作线程上并行解码（按硬件线程数分组）；块压缩内部也是多线程的，线程数按解码线程数均分
+        const size_t hardwareThreads = std::max<size_t>(1, threadCount ? threadCount : std::thread::hardware_concurrency());
+        const size_t workerCount     = std::max<size_t>(1, std::min(sources.size(), hardwareThreads));
+        const auto   compressThreads = static_cast<uint32_t>(std::max<size_t>(1, hardwareThreads / workerCount));
+
+        std::vector<Data> data(sources.size());
+
+        auto decodeSources = [&](size_t worker)
+        {
+            for (size_t i = worker; i < sources.size(); i += workerCount)
+            {
+                data[i] = decode(device, sources[i], compressThreads);
+            }
+        };
+
+        std::vector<std::future<void>> workers{};
+
+        for (size_t worker = 1; worker < workerCount; ++worker)
+        {
+            workers.push_back(std::async(std::launch::async, decodeSources, worker));
+        }
+
+        decodeSources(0);
+
+        for (auto& worker : workers)
+        {
+            worker.get();
+        }
+
+        return data;
+    }
+
+    std::vector<Texture::Ptr> Texture::createTextures(const Wrapper::Device::Ptr& device,
+                                                      const std::vector<Source>& sources,
+                                                      const Wrapper::UploadContext::Ptr& uploadContext,
+                                                      uint32_t threadCount)
+    {
+        // 步骤1：并行解码
+        auto data = decodeAll(device, sources, threadCount);
+
+        // 步骤2：调用线程上依次创建图像并记录上传（UploadContext 不是线程安全的），所有纹理同一批提交
+        const auto uploader = uploadContext != nullptr ? uploadContext : Wrapper::UploadContext::create(device);
+
+        std::vector<Texture::Ptr> textures{};
+        textures.reserve(sources.size());
+
+        for (auto& textureData : data)
+        {
+            textures.push_back(Texture::create(device, textureData, uploader));
+
+            // 写进暂存区后立即释放解码结果
+            textureData = Data{};
         }
 
-        texSize = texWidth * texHeight * 4;  // 计算图像总字节数（RGBA 每个像素 4 字节）
+        if (uploadContext == nullptr)
+        {
+            uploader->flush();
+        }
 
-        // -------------------- 步骤2：创建 Vulkan 图像对象（GPU 内存） --------------------
+        return textures;
+    }
+
+    std::vector<Texture::Ptr> Texture::createTextures(const Wrapper::Device::Ptr& device,
+                                                      const std::vector<std::string>& imageFilePaths,
+                                                      const Wrapper::UploadContext::Ptr& uploadContext,
+                                                      MipmapMode mipmapMode,
+                                                      BlockFormat blockFormat)
+    {
+        std::vector<Source> sources{};
+        sources.reserve(imageFilePaths.size());
+
+        for (const auto& path : imageFilePaths)
+        {
+            sources.push_back({ path, mipmapMode, blockFormat });
+        }
+
+        return createTextures(device, sources, uploadContext);
+    }
+
+    Texture::Data Texture::decode(const Wrapper::Device::Ptr& device, const Source& source, uint32_t compressThreads)
+    {
+        if (Ktx2File::isKtx2Path(source.mPath))
+        {
+            return decodeKtx2(device, source.mPath);
+        }
+
+        if (source.mBlockFormat != BlockFormat::None)
+        {
+            if (device->supportsTextureCompressionBC())
+            {
+                return decodeCompressed(source.mPath, source.mMipmapMode, source.mBlockFormat, compressThreads);
+            }
+
+            std::cout << "Warning: BC texture compression is not supported, loading " << source.mPath << " uncompressed" << std::endl;
+        }
+
+        return decodeUncompressed(device, source.mPath, source.mMipmapMode);
+    }
+
+    Texture::Texture(const Wrapper::Device::Ptr& device,
+                     const std::string& imageFilePath,
+                     const Wrapper::UploadContext::Ptr& uploadContext,
+                     MipmapMode mipmapMode,
+                     BlockFormat blockFormat)
+        : Texture(device, decode(device, { imageFilePath, mipmapMode, blockFormat }), uploadContext)
+    {
+    }
+
+    Texture::Texture(const Wrapper::Device::Ptr& device,
+                     const Data& data,
+                     const Wrapper::UploadContext::Ptr& uploadContext)
+    {
+        mDevice = device;
+
+        // -------------------- 创建 Vulkan 图像对象（GPU 内存） --------------------
         // 创建一个 2D 纹理图像，用于存储 GPU 可访问的纹理数据
         // 参数说明（关键参数）：
         //   mDevice: Vulkan 设备
-        //   texWidth/texHeight: 图像宽高（像素）
-        //   VK_FORMAT_R8G8B8A8_SRGB: 图像格式（RGBA 8 位，sRGB 色彩空间）
+        //   mWidth/mHeight: 图像宽高（像素）
+        //   mFormat: 图像格式（未压缩时为 RGBA 8 位 sRGB，块压缩或 KTX2 时为对应格式）
         //   VK_IMAGE_TYPE_2D: 二维图像（非 1D/3D/立方体贴图）
         //   VK_IMAGE_TILING_OPTIMAL: 最优平铺方式（Vulkan 自动优化内存布局）
         //   VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT:
@@ -46,49 +201,254 @@ namespace LearnVulkan
         //   VK_SAMPLE_COUNT_1_BIT: 单采样（无多重采样）
         //   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT: 内存属性（GPU 本地内存，高性能）
         //   VK_IMAGE_ASPECT_COLOR_BIT: 图像子资源方面（仅颜色通道）
+        //   mMipLevels: 完整 mip 链（GPU 生成时第 i 级由第 i - 1 级 blit 得到，因此还需要 TRANSFER_SRC_BIT）
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (data.mGenerateMipmaps)
+        {
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+
         mImage = Wrapper::Image::create(mDevice,
-                                        texWidth,
-                                        texHeight,
-                                        VK_FORMAT_R8G8B8A8_SRGB,
+                                        static_cast<int>(data.mWidth),
+                                        static_cast<int>(data.mHeight),
+                                        data.mFormat,
                                         VK_IMAGE_TYPE_2D,
                                         VK_IMAGE_TILING_OPTIMAL,
-                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                        usage,
                                         VK_SAMPLE_COUNT_1_BIT,
                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                        VK_IMAGE_ASPECT_COLOR_BIT);
+                                        VK_IMAGE_ASPECT_COLOR_BIT,
+                                        data.mMipLevels,
+                                        data.mLayerCount);
+
+        // -------------------- 上传 --------------------
+        // 数据立即写进暂存区，TRANSFER_DST 转换、复制（和 blit 生成 mip）、SHADER_READ_ONLY 转换在提交时录制进同一个命令缓冲区，
+        // 多个纹理共用一个 UploadContext 时也只有一次提交
+        const auto uploader = uploadContext != nullptr ? uploadContext : Wrapper::UploadContext::create(mDevice, data.mSize);
+
+        if (data.mHostData != nullptr)
+        {
+            uploader->uploadImageFromHost(mImage,
+                                          data.mHostData,
+                                          data.mSize,
+                                          data.mLevels,
+                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                          data.mGenerateMipmaps);
+        }
+        else
+        {
+            uploader->uploadImageLevels(mImage,
+                                        data.mSize,
+                                        data.mLevels,
+                                        data.mWrite,
+                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                        data.mGenerateMipmaps);
+        }
 
+        if (uploadContext == nullptr)
+        {
+            uploader->flush();
+        }
 
-        VkImageSubresourceRange region{};
-        region.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.baseArrayLayer = 0;
-        region.layerCount     = 1;
-        region.baseMipLevel   = 0;
-        region.levelCount     = 1;
+        // 默认采样状态（线性 / 重复 / 各向异性）的采样器所有纹理共用，LOD 范围由图像视图限制
+        mSampler = mDevice->getSamplerCache()->get();
 
-        mImage->setImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                               VK_PIPELINE_STAGE_TRANSFER_BIT,
-                               VK_PIPELINE_STAGE_TRANSFER_BIT,
-                               region,
-                               commandPool);
+        // 延迟提交时图像此刻还没有转换，直接使用上传后的最终布局
+        mImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        mImageInfo.imageView   = mImage->getImageView();
+        mImageInfo.sampler     = mSampler;
+    }
 
-        mImage->fillImageData(texSize,
-                             (void*)pixels,
-                             commandPool);
+    Texture::~Texture() {}
 
-        mImage->setImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                               VK_PIPELINE_STAGE_TRANSFER_BIT,
-                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                               region,
-                               commandPool);
+    Texture::Data Texture::decodeUncompressed(const Wrapper::Device::Ptr& device, const std::string& imageFilePath, MipmapMode mipmapMode)
+    {
+        Data data{};
+        data.mFormat = VK_FORMAT_R8G8B8A8_SRGB;
 
-        stbi_image_free(pixels);
+        // -------------------- 步骤1：确定 mip 链的生成方式 --------------------
+        if (mipmapMode == MipmapMode::Auto)
+        {
+            mipmapMode = Wrapper::Image::supportsLinearBlit(device, data.mFormat) ? MipmapMode::Gpu : MipmapMode::Cpu;
+        }
 
-        mSampler = Wrapper::Sampler::create(mDevice);
+        // -------------------- 步骤2：加载图像文件数据（CPU 内存） --------------------
+        int texWidth, texHeight, texChannles;
 
-        mImageInfo.imageLayout = mImage->getLayout();
-        mImageInfo.imageView   = mImage->getImageView();
-        mImageInfo.sampler     = mSampler->getSampler();
+        // 使用 stb_image 库加载图像文件（跨平台轻量级图像加载库）
+        // 参数说明：
+        //   imageFilePath.c_str(): 图像文件路径
+        //   &texWidth/&texHeight: 输出图像宽高（像素）
+        //   &texChannles: 输出原始通道数（如 RGB=3，RGBA=4）
+        //   desiredChannels: CPU 生成 mip 链时强制转换为 RGBA（STBI_rgb_alpha）；
+        //                    否则保持原始通道数（0），不足 4 通道时上传时再直接扩展到暂存区，省去一次整图 RGBA 转换和拷贝
+        const int desiredChannels = mipmapMode == MipmapMode::Cpu ? STBI_rgb_alpha : 0;
+
+        std::shared_ptr<stbi_uc> pixels(stbi_load(imageFilePath.c_str(),
+                                                  &texWidth,
+                                                  &texHeight,
+                                                  &texChannles,
+                                                  desiredChannels),
+                                        stbi_image_free);
+
+        if (!pixels)  // 加载失败处理
+        {
+            throw std::runtime_error("Error: failed to read image data!");
+        }
+
+        const size_t       pixelCount = size_t(texWidth) * texHeight;
+        const VkDeviceSize texSize    = VkDeviceSize(pixelCount) * 4;  // 计算上传的总字节数（RGBA 每个像素 4 字节）
+
+        data.mWidth     = static_cast<uint32_t>(texWidth);
+        data.mHeight    = static_cast<uint32_t>(texHeight);
+        data.mMipLevels = mipmapMode == MipmapMode::None ? 1 : Wrapper::Image::getMipLevelCount(data.mWidth, data.mHeight);
+
+        // -------------------- 步骤3：准备上传数据 --------------------
+        if (mipmapMode == MipmapMode::Cpu)
+        {
+            auto chain = std::make_shared<std::vector<uint8_t>>(MipmapGenerator::build(pixels.get(), data.mWidth, data.mHeight, data.mLevels));
+
+            copyFrom(data, chain, chain->data(), chain->size());
+
+            return data;
+        }
+
+        data.mLevels          = { { 0, data.mWidth, data.mHeight } };
+        data.mSize            = texSize;
+        data.mGenerateMipmaps = mipmapMode == MipmapMode::Gpu;
+
+        if (texChannles == 4)
+        {
+            // 已经是 RGBA：解码结果就是上传数据，支持时直接导入，不经过暂存区
+            data.mHostData = pixels;
+        }
+        else
+        {
+            data.mWrite = expandToRgba(pixels, texChannles, pixelCount);
+        }
+
+        return data;
     }
 
-    Texture::~Texture() {}
+    Texture::Data Texture::decodeCompressed(const std::string& imageFilePath,
+                                            MipmapMode mipmapMode,
+                                            BlockFormat blockFormat,
+                                            uint32_t compressThreads)
+    {
+        const bool withMipmaps = mipmapMode != MipmapMode::None;
+
+        // -------------------- 步骤1：查找磁盘缓存（键为源文件内容 + 压缩格式 + 是否带 mip 链） --------------------
+        const std::string cachePath = imageFilePath + ".bccache";
+        const uint32_t    flags     = static_cast<uint32_t>(blockFormat) | (withMipmaps ? CacheFlagMipmaps : 0u);
+
+        MeshCacheKey key{};
+        const bool hasKey = MeshCache::makeKey(imageFilePath, flags, key);
+
+        MeshCache::Ptr cache = hasKey ? MeshCache::open(cachePath, key) : nullptr;
+
+        Data data{};
+        data.mFormat = BlockCompressor::getVkFormat(blockFormat);
+
+        if (cache)
+        {
+            const auto levelSection = cache->getSection(LevelsSection);
+            const auto blockSection = cache->getSection(BlocksSection);
+
+            if (levelSection.mData && blockSection.mData &&
+                levelSection.mSize > 0 && levelSection.mSize % sizeof(Wrapper::MipLevel) == 0)
+            {
+                const auto* first = static_cast<const Wrapper::MipLevel*>(levelSection.mData);
+                data.mLevels.assign(first, first + levelSection.mSize / sizeof(Wrapper::MipLevel));
+
+                // 每一级都必须完整落在数据段内
+                const bool valid = std::all_of(data.mLevels.begin(), data.mLevels.end(), [&](const Wrapper::MipLevel& level)
+                {
+                    const VkDeviceSize size = BlockCompressor::getLevelSize(blockFormat, level.mWidth, level.mHeight);
+                    return level.mOffset <= blockSection.mSize && size <= blockSection.mSize - level.mOffset;
+                });
+
+                if (valid)
+                {
+                    // 上传时直接从缓存文件的映射拷进暂存区
+                    copyFrom(data, cache, blockSection.mData, blockSection.mSize);
+                }
+            }
+        }
+
+        // -------------------- 步骤2：未命中时解码、生成 mip 链并压缩，写回缓存 --------------------
+        if (!data.mWrite)
+        {
+            int texWidth, texHeight, texChannles;
+
+            stbi_uc* pixels = stbi_load(imageFilePath.c_str(), &texWidth, &texHeight, &texChannles, STBI_rgb_alpha);
+
+            if (!pixels)
+            {
+                throw std::runtime_error("Error: failed to read image data!");
+            }
+
+            std::vector<uint8_t>           mipChain{};
+            std::vector<Wrapper::MipLevel> sourceLevels{ { 0, uint32_t(texWidth), uint32_t(texHeight) } };
+
+            if (withMipmaps)
+            {
+                mipChain = MipmapGenerator::build(pixels, texWidth, texHeight, sourceLevels);
+            }
+
+            auto compressed = std::make_shared<std::vector<uint8_t>>(
+                BlockCompressor::compress(mipChain.empty() ? pixels : mipChain.data(), sourceLevels, blockFormat, data.mLevels, compressThreads));
+
+            stbi_image_free(pixels);
+
+            if (hasKey)
+            {
+                MeshCache::write(cachePath, key,
+                {
+                    { LevelsSection, data.mLevels.data(), data.mLevels.size() * sizeof(Wrapper::MipLevel) },
+                    { BlocksSection, compressed->data(),  compressed->size() }
+                });
+            }
+
+            copyFrom(data, compressed, compressed->data(), compressed->size());
+        }
+
+        data.mWidth     = data.mLevels[0].mWidth;
+        data.mHeight    = data.mLevels[0].mHeight;
+        data.mMipLevels = static_cast<uint32_t>(data.mLevels.size());
+
+        return data;
+    }
+
+    Texture::Data Texture::decodeKtx2(const Wrapper::Device::Ptr& device, const std::string& imageFilePath)
+    {
+        // -------------------- 步骤1：映射文件，解析格式和级别布局 --------------------
+        const auto file   = Ktx2File::open(imageFilePath);
+        const auto format = file->getFormat();
+
+        const bool blockCompressed = format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+
+        VkFormatProperties formatProps{};
+        vkGetPhysicalDeviceFormatProperties(device->getPhysicalDevice(), format, &formatProps);
+
+        if ((blockCompressed && !device->supportsTextureCompressionBC()) ||
+            !(formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        {
+            throw std::runtime_error("Error: texture format of " + imageFilePath + " is not supported by the device!");
+        }
+
+        // -------------------- 步骤2：按文件中的格式、级别数和层数上传，各级直接从映射拷贝（或解压）进暂存区 --------------------
+        Data data{};
+        data.mFormat     = format;
+        data.mWidth      = file->getWidth();
+        data.mHeight     = file->getHeight();
+        data.mMipLevels  = file->getLevelCount();
+        data.mLayerCount = file->getLayerCount();
+        data.mSize       = file->getUploadLayout(data.mLevels);
+        data.mWrite      = [file](uint8_t* staging) { file->readLevels(staging); };
+        data.mWriteLevel = [file](uint32_t level, uint8_t* dst) { file->readLevel(level, dst); };
+
+        return data;
+    }
 }
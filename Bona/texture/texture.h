@@ -2,9 +2,12 @@
 
 #include "../vulkanWrapper/base.h"
 #include "../vulkanWrapper/image.h"
-#include "../vulkanWrapper/sampler.h"
+#include "../vulkanWrapper/samplerCache.h"
 #include "../vulkanWrapper/device.h"
 #include "../vulkanWrapper/commandPool.h"
+#include "../vulkanWrapper/uploadContext.h"
+#include "blockCompressor.h"
+#include "ktx2File.h"
 
 namespace LearnVulkan
 {
@@ -12,25 +15,119 @@ namespace LearnVulkan
     {
     public:
         using Ptr = std::shared_ptr<Texture>;
-        static Ptr create(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, const std::string& imageFilePath)
+
+        // mip 链的生成方式
+        enum class MipmapMode
+        {
+            None,   // 只有第 0 级
+            Auto,   // 格式支持线性过滤 blit 时用 Gpu，否则用 Cpu
+            Gpu,    // 上传第 0 级后在图形队列上用 vkCmdBlitImage 逐级降采样
+            Cpu     // 加载时用 MipmapGenerator（SIMD 盒式滤波）生成，整条链一起上传
+        };
+
+        // 一张待加载的纹理及其导入选项
+        struct Source
+        {
+            std::string mPath{};
+            MipmapMode  mMipmapMode{ MipmapMode::Auto };
+            BlockFormat mBlockFormat{ BlockFormat::None };
+        };
+
+        /// 把第 level 级（含到下一级的对齐填充）写到 dst
+        using LevelWriter = std::function<void(uint32_t level, uint8_t* dst)>;
+
+        // 解码后、上传前的 CPU 端数据。解码（图像解码、mip 生成、块压缩、缓存读写）只读取设备属性，
+        // 不访问上传上下文，因此可以在工作线程上并行进行；mWrite 持有解码结果（或映射的缓存 / KTX2 文件），
+        // 上传时把数据直接写进暂存区（如 RGB -> RGBA 扩展直接输出到暂存区）。
+        // mHostData 不为空时数据已经是最终布局、位于可导入的主机内存，上传时优先直接导入，mWrite 为空。
+        // 整条 mip 链都在 CPU 端（Cpu 生成、块压缩、KTX2）时 mWriteLevel 可以单独读取某一级，供 TextureStreamer 按级别流送
+        struct Data
+        {
+            VkFormat                              mFormat{ VK_FORMAT_UNDEFINED };
+            uint32_t                              mWidth{ 0 };
+            uint32_t                              mHeight{ 0 };
+            uint32_t                              mMipLevels{ 1 };
+            uint32_t                              mLayerCount{ 1 };
+            bool                                  mGenerateMipmaps{ false };   // 只上传第 0 级，其余级别由 GPU blit 生成
+            std::vector<Wrapper::MipLevel>        mLevels{};
+            VkDeviceSize                          mSize{ 0 };
+            Wrapper::UploadContext::StagingWriter mWrite{};
+            std::shared_ptr<void>                 mHostData{ nullptr };
+            LevelWriter                           mWriteLevel{};
+        };
+
+        // 传入 uploadContext 时布局转换和复制只记录在其中，和其他资源一起提交，调用方负责在使用前 submit / flush；
+        // 否则单独一次提交并等待完成。
+        // blockFormat 不为 None 时在 CPU 上压缩（块压缩格式不能作为 blit 目标，Gpu / Auto 都按 Cpu 生成 mip 链），
+        // 结果写入源文件旁的 <源文件>.bccache，之后直接映射缓存上传；设备不支持 BC 格式时退回未压缩。
+        // .ktx2 文件按文件中的格式、mip 链和数组层原样上传，忽略 mipmapMode 和 blockFormat；多层时图像视图为 2D_ARRAY
+        static Ptr create(const Wrapper::Device::Ptr& device,
+                          const std::string& imageFilePath,
+                          const Wrapper::UploadContext::Ptr& uploadContext = nullptr,
+                          MipmapMode mipmapMode = MipmapMode::Auto,
+                          BlockFormat blockFormat = BlockFormat::None)
+        {
+            return std::make_shared<Texture>(device, imageFilePath, uploadContext, mipmapMode, blockFormat);
+        }
+
+        static Ptr create(const Wrapper::Device::Ptr& device,
+                          const Data& data,
+                          const Wrapper::UploadContext::Ptr& uploadContext = nullptr)
         {
-            return std::make_shared<Texture>(device, commandPool, imageFilePath);
+            return std::make_shared<Texture>(device, data, uploadContext);
         }
 
-        Texture(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, const std::string& imageFilePath);
+        /// 批量创建纹理：先在工作线程上并行解码所有纹理，再在调用线程上依次创建图像，
+        /// 所有图像的屏障和复制录制在同一个命令缓冲区里，一次提交。threadCount 为 0 时使用全部硬件线程，为 1 时串行解码
+        static std::vector<Ptr> createTextures(const Wrapper::Device::Ptr& device,
+                                               const std::vector<Source>& sources,
+                                               const Wrapper::UploadContext::Ptr& uploadContext = nullptr,
+                                               uint32_t threadCount = 0);
+
+        static std::vector<Ptr> createTextures(const Wrapper::Device::Ptr& device,
+                                               const std::vector<std::string>& imageFilePaths,
+                                               const Wrapper::UploadContext::Ptr& uploadContext = nullptr,
+                                               MipmapMode mipmapMode = MipmapMode::Auto,
+                                               BlockFormat blockFormat = BlockFormat::None);
+
+        /// 在工作线程上并行解码，结果与 sources 一一对应；threadCount 同 createTextures
+        static std::vector<Data> decodeAll(const Wrapper::Device::Ptr& device, const std::vector<Source>& sources, uint32_t threadCount = 0);
+
+        /// 只做 CPU 端的解码，可在任意线程调用；compressThreads 为块压缩使用的线程数（0 为全部硬件线程）
+        static Data decode(const Wrapper::Device::Ptr& device, const Source& source, uint32_t compressThreads = 0);
+
+        Texture(const Wrapper::Device::Ptr& device,
+                const std::string& imageFilePath,
+                const Wrapper::UploadContext::Ptr& uploadContext = nullptr,
+                MipmapMode mipmapMode = MipmapMode::Auto,
+                BlockFormat blockFormat = BlockFormat::None);
+
+        Texture(const Wrapper::Device::Ptr& device,
+                const Data& data,
+                const Wrapper::UploadContext::Ptr& uploadContext = nullptr);
 
         ~Texture();
 
         [[nodiscard]] auto getImage() const { return mImage; }
         
+        /// 来自设备的采样器缓存，与其他纹理共用，不随纹理销毁
         [[nodiscard]] auto getSampler() const { return mSampler; }
 
+        [[nodiscard]] auto getMipLevels() const { return mImage->getMipLevels(); }
+
         [[nodiscard]] VkDescriptorImageInfo& getImageInfo() { return mImageInfo; }
 
+    private:
+        static Data decodeUncompressed(const Wrapper::Device::Ptr& device, const std::string& imageFilePath, MipmapMode mipmapMode);
+
+        static Data decodeCompressed(const std::string& imageFilePath, MipmapMode mipmapMode, BlockFormat blockFormat, uint32_t compressThreads);
+
+        static Data decodeKtx2(const Wrapper::Device::Ptr& device, const std::string& imageFilePath);
+
     private:
         Wrapper::Device::Ptr  mDevice{ nullptr };
         Wrapper::Image::Ptr   mImage{ nullptr };
-        Wrapper::Sampler::Ptr mSampler{ nullptr };
+        VkSampler             mSampler{ VK_NULL_HANDLE };
         VkDescriptorImageInfo mImageInfo{};
     };
 }
@@ -0,0 +1,408 @@
+﻿#include "textureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LearnVulkan
+{
+    TextureStreamer::StreamedTexture::StreamedTexture(Texture::Data data, uint32_t tailLevel)
+        : mData(std::move(data)), mTailLevel(tailLevel), mResidentLevel(tailLevel), mPlannedLevel(tailLevel)
+    {
+    }
+
+    void TextureStreamer::StreamedTexture::bind(const Wrapper::DescriptorSet::Ptr& descriptorSet, const Wrapper::UniformParameter::Ptr& param)
+    {
+        mBindings.push_back({ descriptorSet, param });
+    }
+
+    uint32_t TextureStreamer::StreamedTexture::getDesiredLevel() const
+    {
+        const float size = static_cast<float>(std::max(mData.mWidth, mData.mHeight));
+
+        if (mScreenSize <= 0.0f)
+        {
+            return mTailLevel;
+        }
+
+        // 纹理覆盖屏幕上 mScreenSize 个像素时，比这更精细的级别采样时用不到
+        const float level = std::floor(std::log2(std::max(size / mScreenSize, 1.0f)));
+
+        return std::min(mTailLevel, static_cast<uint32_t>(level));
+    }
+
+    VkDeviceSize TextureStreamer::StreamedTexture::getResidentBytes(uint32_t level) const
+    {
+        if (level >= mData.mLevels.size())
+        {
+            return mData.mSize;
+        }
+
+        return mData.mSize - mData.mLevels[level].mOffset;
+    }
+
+    Texture::Data TextureStreamer::StreamedTexture::makeLevelData(uint32_t level) const
+    {
+        const VkDeviceSize base = mData.mLevels[level].mOffset;
+
+        Texture::Data data{};
+        data.mFormat     = mData.mFormat;
+        data.mWidth      = mData.mLevels[level].mWidth;
+        data.mHeight     = mData.mLevels[level].mHeight;
+        data.mMipLevels  = getLevelCount() - level;
+        data.mLayerCount = mData.mLayerCount;
+        data.mSize       = mData.mSize - base;
+
+        for (uint32_t i = level; i < getLevelCount(); ++i)
+        {
+            auto mipLevel = mData.mLevels[i];
+            mipLevel.mOffset -= base;
+            data.mLevels.push_back(mipLevel);
+        }
+
+        return data;
+    }
+
+    void TextureStreamer::StreamedTexture::writeLevels(uint32_t level, uint8_t* dst) const
+    {
+        const VkDeviceSize base = mData.mLevels[level].mOffset;
+
+        for (uint32_t i = level; i < getLevelCount(); ++i)
+        {
+            mData.mWriteLevel(i, dst + (mData.mLevels[i].mOffset - base));
+        }
+    }
+
+    TextureStreamer::TextureStreamer(const Wrapper::Device::Ptr& device, const Settings& settings)
+    {
+        mDevice   = device;
+        mSettings = settings;
+
+        for (uint32_t i = 0; i < std::max(1u, mSettings.mWorkerCount); ++i)
+        {
+            mWorkers.emplace_back(&TextureStreamer::workerLoop, this);
+        }
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+
+        mCondition.notify_all();
+
+        for (auto& worker : mWorkers)
+        {
+            worker.join();
+        }
+    }
+
+    std::vector<TextureStreamer::StreamedTexture::Ptr> TextureStreamer::addTextures(const std::vector<Texture::Source>& sources,
+                                                                                   const Wrapper::UploadContext::Ptr& uploadContext,
+                                                                                   uint32_t threadCount)
+    {
+        // 步骤1：并行解码，流送需要整条 mip 链的 CPU 副本
+        std::vector<Texture::Source> streamSources = sources;
+
+        for (auto& source : streamSources)
+        {
+            if (source.mMipmapMode != Texture::MipmapMode::None)
+            {
+                source.mMipmapMode = Texture::MipmapMode::Cpu;
+            }
+        }
+
+        auto data = Texture::decodeAll(mDevice, streamSources, threadCount);
+
+        // 步骤2：只上传最粗的几级，立即可用
+        std::vector<StreamedTexture::Ptr> textures{};
+
+        for (auto& textureData : data)
+        {
+            const bool streamable = textureData.mWriteLevel && !textureData.mGenerateMipmaps &&
+                                    textureData.mLevels.size() == textureData.mMipLevels;
+
+            uint32_t tailLevel = 0;
+
+            while (streamable && tailLevel + 1 < textureData.mLevels.size() &&
+                   std::max(textureData.mLevels[tailLevel].mWidth, textureData.mLevels[tailLevel].mHeight) > mSettings.mResidentTailSize)
+            {
+                ++tailLevel;
+            }
+
+            auto texture = std::make_shared<StreamedTexture>(std::move(textureData), tailLevel);
+
+            if (tailLevel == 0)
+            {
+                // 不流送：按原样整体上传
+                texture->mTexture = Texture::create(mDevice, texture->mData, uploadContext);
+            }
+            else
+            {
+                auto tailData = texture->makeLevelData(tailLevel);
+
+                const StreamedTexture* source = texture.get();
+                tailData.mWrite = [source, tailLevel](uint8_t* staging) { source->writeLevels(tailLevel, staging); };
+
+                texture->mTexture = Texture::create(mDevice, tailData, uploadContext);
+            }
+
+            mResidentBytes += texture->getResidentBytes(tailLevel);
+
+            // 降一级后的新图像不超过该纹理第 1 级开始的大小
+            if (texture->getLevelCount() > 1)
+            {
+                mSwapHeadroom = std::max(mSwapHeadroom, texture->getResidentBytes(1));
+            }
+
+            mTextures.push_back(texture);
+            textures.push_back(texture);
+        }
+
+        return textures;
+    }
+
+    void TextureStreamer::workerLoop()
+    {
+        while (true)
+        {
+            LoadRequest request{};
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return mStop || !mRequests.empty(); });
+
+                if (mStop)
+                {
+                    return;
+                }
+
+                request = std::move(mRequests.front());
+                mRequests.pop_front();
+            }
+
+            // 读进按页对齐的主机内存，上传时支持的设备直接导入，不再经过暂存区
+            LoadResult result{};
+            result.mTexture = request.mTexture;
+            result.mLevel   = request.mLevel;
+
+            try
+            {
+                const auto size = static_cast<size_t>(request.mTexture->getResidentBytes(request.mLevel));
+
+                result.mHostData = std::shared_ptr<void>(Wrapper::UploadContext::allocateHostMemory(size),
+                                                         Wrapper::UploadContext::freeHostMemory);
+
+                if (result.mHostData == nullptr)
+                {
+                    throw std::runtime_error("Error: out of host memory while streaming texture levels!");
+                }
+
+                request.mTexture->writeLevels(request.mLevel, static_cast<uint8_t*>(result.mHostData.get()));
+            }
+            catch (const std::exception& e)
+            {
+                result.mHostData.reset();
+                result.mError = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mResults.push_back(std::move(result));
+        }
+    }
+
+    void TextureStreamer::request(const StreamedTexture::Ptr& texture, uint32_t level)
+    {
+        texture->mPending = true;
+        mReservedBytes   += texture->getResidentBytes(level);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRequests.push_back({ texture, level });
+        }
+
+        mCondition.notify_one();
+    }
+
+    void TextureStreamer::update(const Wrapper::UploadContext::Ptr& uploadContext)
+    {
+        // 步骤1：收取读完的级别，创建新图像并上传（替换在 applySwaps 中进行）
+        std::deque<LoadResult> results{};
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            results.swap(mResults);
+        }
+
+        for (auto& result : results)
+        {
+            if (result.mHostData == nullptr)
+            {
+                std::cout << "Warning: " << result.mError << std::endl;
+
+                // 读取失败的纹理停在当前级别
+                result.mTexture->mTailLevel = result.mTexture->mResidentLevel;
+                result.mTexture->mPending   = false;
+                mReservedBytes -= result.mTexture->getResidentBytes(result.mLevel);
+
+                if (result.mLevel > result.mTexture->mResidentLevel)
+                {
+                    mDemoting = false;
+                }
+
+                continue;
+            }
+
+            auto data = result.mTexture->makeLevelData(result.mLevel);
+            data.mHostData = result.mHostData;
+
+            // 描述符集的份数即在途帧数，每一份都要改写
+            uint32_t frameCount = 1;
+
+            for (const auto& binding : result.mTexture->mBindings)
+            {
+                frameCount = std::max(frameCount, binding.mDescriptorSet->getCount());
+            }
+
+            mSwaps.push_back({ result.mTexture, Texture::create(mDevice, data, uploadContext), result.mLevel, std::vector<bool>(frameCount, false) });
+        }
+
+        if (!results.empty())
+        {
+            uploadContext->submit();
+        }
+
+        // 步骤2：按预算规划并发出新的请求
+        plan();
+    }
+
+    void TextureStreamer::plan()
+    {
+        // 按屏幕尺寸从大到小分配预算（不含降级保留的空间）
+        std::vector<StreamedTexture::Ptr> byPriority = mTextures;
+
+        std::stable_sort(byPriority.begin(), byPriority.end(), [](const StreamedTexture::Ptr& a, const StreamedTexture::Ptr& b)
+        {
+            return a->mScreenSize > b->mScreenSize;
+        });
+
+        const VkDeviceSize available = mSettings.mBudget > mSwapHeadroom ? mSettings.mBudget - mSwapHeadroom : 0;
+        VkDeviceSize       planned   = 0;
+
+        for (const auto& texture : byPriority)
+        {
+            uint32_t level = texture->getDesiredLevel();
+
+            while (level < texture->mTailLevel && planned + texture->getResidentBytes(level) > available)
+            {
+                ++level;
+            }
+
+            texture->mPlannedLevel = level;
+            planned += texture->getResidentBytes(level);
+        }
+
+        // 降级：屏幕尺寸最小的先降，一次只有一个，保证保留的空间够用
+        if (!mDemoting)
+        {
+            for (auto it = byPriority.rbegin(); it != byPriority.rend(); ++it)
+            {
+                const auto& texture = *it;
+
+                if (!texture->mPending && texture->mResidentLevel < texture->mPlannedLevel)
+                {
+                    mDemoting = true;
+                    request(texture, texture->mPlannedLevel);
+                    break;
+                }
+            }
+        }
+
+        // 升级：屏幕尺寸大的先升，每次一级；新图像和旧图像同时存在期间都计入预算
+        uint32_t pending = static_cast<uint32_t>(std::count_if(mTextures.begin(), mTextures.end(),
+                                                               [](const StreamedTexture::Ptr& texture) { return texture->mPending; }));
+
+        for (const auto& texture : byPriority)
+        {
+            if (pending >= mSettings.mMaxPendingLoads)
+            {
+                break;
+            }
+
+            if (texture->mPending || texture->mResidentLevel <= texture->mPlannedLevel)
+            {
+                continue;
+            }
+
+            const uint32_t level = texture->mResidentLevel - 1;
+
+            if (mResidentBytes + mReservedBytes + texture->getResidentBytes(level) > available)
+            {
+                continue;
+            }
+
+            request(texture, level);
+            ++pending;
+        }
+    }
+
+    bool TextureStreamer::applySwaps(uint32_t frame)
+    {
+        bool updated = false;
+
+        // 步骤1：改写本帧的描述符集，其余帧可能仍在使用旧图像
+        for (auto& swap : mSwaps)
+        {
+            if (frame >= swap.mUpdatedFrames.size() || swap.mUpdatedFrames[frame])
+            {
+                continue;
+            }
+
+            for (auto& binding : swap.mTexture->mBindings)
+            {
+                binding.mDescriptorSet->updateImage(binding.mParam->mBinding, swap.mNewTexture->getImageInfo(), frame);
+            }
+
+            swap.mUpdatedFrames[frame] = true;
+            updated                    = true;
+        }
+
+        // 步骤2：所有帧都已换成新图像的替换完成。最后一帧的栅栏刚等待过，更早的帧在改写各自描述符集时也已等待过，
+        // 引用旧图像的提交都已执行完毕
+        auto done = std::stable_partition(mSwaps.begin(), mSwaps.end(), [](const Swap& swap)
+        {
+            return std::find(swap.mUpdatedFrames.begin(), swap.mUpdatedFrames.end(), false) != swap.mUpdatedFrames.end();
+        });
+
+        for (auto it = done; it != mSwaps.end(); ++it)
+        {
+            auto& swap    = *it;
+            auto& texture = swap.mTexture;
+
+            for (auto& binding : texture->mBindings)
+            {
+                binding.mParam->mTexture = swap.mNewTexture;
+            }
+
+            // 旧图像在这里释放，新图像的预留转为驻留
+            const VkDeviceSize newBytes = texture->getResidentBytes(swap.mLevel);
+
+            mResidentBytes = mResidentBytes - texture->getResidentBytes(texture->mResidentLevel) + newBytes;
+            mReservedBytes -= newBytes;
+
+            if (swap.mLevel > texture->mResidentLevel)
+            {
+                mDemoting = false;
+            }
+
+            texture->mTexture       = swap.mNewTexture;
+            texture->mResidentLevel = swap.mLevel;
+            texture->mPending       = false;
+        }
+
+        mSwaps.erase(done, mSwaps.end());
+
+        return updated;
+    }
+}
@@ -0,0 +1,173 @@
+﻿#pragma once
+
+#include "texture.h"
+#include "../vulkanWrapper/descriptorSet.h"
+#include "../vulkanWrapper/description.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace LearnVulkan
+{
+    // 渐进式 mip 流送：纹理创建时只驻留最粗的几级（边长不超过 mResidentTailSize 的级别），立即可用；
+    // 更精细的级别按优先级在后台线程读入（映射的 .bccache / KTX2 页面读入、zstd 解压）到可导入的主机内存，
+    // 主线程用 [新的最精细级别, 最粗级别] 创建新图像、上传，再替换描述符。每次只升一级，画面逐级变清晰。
+    //
+    // 显存预算约束所有流送纹理的 mip 数据（按数据字节数估算，不含驱动的对齐和元数据），包括替换期间新旧图像同时存在的部分：
+    //   - 每帧按屏幕尺寸从大到小分配预算，放不下的纹理（通常在远处）只分到较粗的级别
+    //   - 驻留超过分配的纹理降级（丢弃最精细的级别），同一时刻只有一个降级在进行，
+    //     预算中保留最大一次降级所需的空间，因此降级总能进行、不会超出预算
+    //
+    // 描述符集每个在途帧一份，替换逐帧进行，不需要等待所有帧：
+    //   每帧等待本帧栅栏、调用 update(uploadContext) 之后调用 applySwaps(frame)，只改写这一帧的描述符集；
+    //   所有帧的描述符集都换成新图像后（此时用到旧图像的提交都已完成）才释放旧图像
+    class TextureStreamer
+    {
+    public:
+        using Ptr = std::shared_ptr<TextureStreamer>;
+
+        struct Settings
+        {
+            VkDeviceSize mBudget{ 256ull * 1024 * 1024 };   // 所有流送纹理的显存预算
+            uint32_t     mResidentTailSize{ 64 };           // 边长不超过它的级别始终驻留
+            uint32_t     mWorkerCount{ 2 };                 // 后台读取线程数
+            uint32_t     mMaxPendingLoads{ 4 };             // 同时在读取或等待替换的纹理数
+        };
+
+        class StreamedTexture
+        {
+        public:
+            using Ptr = std::shared_ptr<StreamedTexture>;
+
+            StreamedTexture(Texture::Data data, uint32_t tailLevel);
+
+            /// 纹理在屏幕上的边长（像素），决定期望的最精细级别；默认按最精细的级别
+            void setScreenSize(float pixels) { mScreenSize = pixels; }
+
+            /// 替换时同步更新 param 的纹理和 descriptorSet 中 param->mBinding 处的描述符
+            void bind(const Wrapper::DescriptorSet::Ptr& descriptorSet, const Wrapper::UniformParameter::Ptr& param);
+
+            [[nodiscard]] auto getTexture()       const { return mTexture; }
+            [[nodiscard]] auto getResidentLevel() const { return mResidentLevel; }
+            [[nodiscard]] auto getTailLevel()     const { return mTailLevel; }
+            [[nodiscard]] auto getLevelCount()    const { return static_cast<uint32_t>(mData.mLevels.size()); }
+
+            /// 屏幕尺寸对应的最精细级别：纹理边长 / 屏幕边长取 log2，不超过最粗驻留级别
+            [[nodiscard]] uint32_t getDesiredLevel() const;
+
+            /// 驻留 [level, 最粗级别] 的字节数
+            [[nodiscard]] VkDeviceSize getResidentBytes(uint32_t level) const;
+
+        private:
+            friend class TextureStreamer;
+
+            struct Binding
+            {
+                Wrapper::DescriptorSet::Ptr    mDescriptorSet{ nullptr };
+                Wrapper::UniformParameter::Ptr mParam{ nullptr };
+            };
+
+            /// 描述 [level, 最粗级别] 的上传数据，偏移相对第 level 级
+            Texture::Data makeLevelData(uint32_t level) const;
+
+            /// 把 [level, 最粗级别] 按 makeLevelData 的布局写到 dst
+            void writeLevels(uint32_t level, uint8_t* dst) const;
+
+        private:
+            Texture::Data        mData{};
+            uint32_t             mTailLevel{ 0 };
+            uint32_t             mResidentLevel{ 0 };
+            uint32_t             mPlannedLevel{ 0 };
+            bool                 mPending{ false };   // 正在读取或等待替换
+            float                mScreenSize{ std::numeric_limits<float>::max() };
+            Texture::Ptr         mTexture{ nullptr };
+            std::vector<Binding> mBindings{};
+        };
+
+        static Ptr create(const Wrapper::Device::Ptr& device, const Settings& settings)
+        {
+            return std::make_shared<TextureStreamer>(device, settings);
+        }
+
+        TextureStreamer(const Wrapper::Device::Ptr& device, const Settings& settings);
+
+        ~TextureStreamer();
+
+        /// 并行解码并创建流送纹理，每个只上传最粗的几级（记录在 uploadContext 中，由调用方提交）。
+        /// 未压缩的源按 Cpu 生成 mip 链（GPU blit 生成的级别没有 CPU 副本，无法流送）；
+        /// 没有整条 CPU 端 mip 链的纹理（如 mipmapMode 为 None）整体驻留，不参与流送
+        std::vector<StreamedTexture::Ptr> addTextures(const std::vector<Texture::Source>& sources,
+                                                      const Wrapper::UploadContext::Ptr& uploadContext,
+                                                      uint32_t threadCount = 0);
+
+        /// 每帧调用：收取后台读完的级别并创建新图像（上传记录进 uploadContext 并提交），
+        /// 按预算重新规划各纹理的级别，发出新的读取请求
+        void update(const Wrapper::UploadContext::Ptr& uploadContext);
+
+        [[nodiscard]] bool hasPendingSwaps() const { return !mSwaps.empty(); }
+
+        /// 把等待替换的新图像写进第 frame 帧的描述符集，调用前该帧的栅栏已等待过；
+        /// 某次替换的所有帧都已改写时释放旧图像。返回本帧的描述符集是否被改写（已录制的命令缓冲区随之失效）
+        bool applySwaps(uint32_t frame);
+
+        /// 当前驻留的 mip 数据字节数（不含正在替换的新图像）
+        [[nodiscard]] auto getResidentBytes() const { return mResidentBytes; }
+
+        /// 驻留 + 正在读取 / 替换的新图像
+        [[nodiscard]] auto getCommittedBytes() const { return mResidentBytes + mReservedBytes; }
+
+        [[nodiscard]] const auto& getSettings() const { return mSettings; }
+
+    private:
+        struct LoadRequest
+        {
+            StreamedTexture::Ptr mTexture{ nullptr };
+            uint32_t             mLevel{ 0 };
+        };
+
+        struct LoadResult
+        {
+            StreamedTexture::Ptr  mTexture{ nullptr };
+            uint32_t              mLevel{ 0 };
+            std::shared_ptr<void> mHostData{ nullptr };
+            std::string           mError{};
+        };
+
+        struct Swap
+        {
+            StreamedTexture::Ptr mTexture{ nullptr };
+            Texture::Ptr         mNewTexture{ nullptr };
+            uint32_t             mLevel{ 0 };
+            std::vector<bool>    mUpdatedFrames{};   // 各帧的描述符集是否已改写
+        };
+
+        void workerLoop();
+
+        void plan();
+
+        void request(const StreamedTexture::Ptr& texture, uint32_t level);
+
+    private:
+        Wrapper::Device::Ptr mDevice{ nullptr };
+        Settings             mSettings{};
+
+        std::vector<StreamedTexture::Ptr> mTextures{};
+
+        VkDeviceSize mResidentBytes{ 0 };
+        VkDeviceSize mReservedBytes{ 0 };   // 正在读取 / 等待替换的新图像
+        VkDeviceSize mSwapHeadroom{ 0 };    // 为降级保留的空间：最大一次降级的新图像
+        bool         mDemoting{ false };
+
+        std::vector<Swap> mSwaps{};
+
+        // 读取线程：请求队列和完成队列由 mMutex 保护
+        std::vector<std::thread>  mWorkers{};
+        std::mutex                mMutex{};
+        std::condition_variable   mCondition{};
+        std::deque<LoadRequest>   mRequests{};
+        std::deque<LoadResult>    mResults{};
+        bool                      mStop{ false };
+    };
+}
@@ -1,5 +1,11 @@
 ﻿#include "uniformManager.h"
 
+// 每帧环形缓冲区段的最小容量；物体多时按 VP + 每个物体一份常量扩大
+static constexpr VkDeviceSize FrameUniformCapacity = 64 * 1024;
+
+// 估算每份常量占用的空间时按 minUniformBufferOffsetAlignment 的上限取整
+static constexpr VkDeviceSize MaxUniformAlignment = 256;
+
 UniformManager::UniformManager()
 {
 }
@@ -8,45 +14,80 @@ UniformManager::~UniformManager()
 {
 }
 
-void UniformManager::init(const Wrapper::Device::Ptr& device, const Wrapper::CommandPool::Ptr& commandPool, int frameCount)
+void UniformManager::init(const Wrapper::Device::Ptr& device,
+                          const Wrapper::UploadContext::Ptr& uploadContext,
+                          int frameCount,
+                          uint32_t textureDecodeThreads,
+                          const TextureStreamer::Ptr& streamer,
+                          const AssetCache::Ptr& assetCache)
 {
     mDevice = device;
 
+    // VP 和物体常量按帧写进同一个常驻映射的环形缓冲区，以动态统一缓冲区绑定
+    const VkDeviceSize objectSize = (sizeof(ObjectUniform) + MaxUniformAlignment - 1) / MaxUniformAlignment * MaxUniformAlignment;
+    const VkDeviceSize frameSize  = MaxUniformAlignment + objectSize * mObjectCapacity;
+
+    mRingBuffer = Wrapper::UniformRingBuffer::create(device, std::max(FrameUniformCapacity, frameSize), frameCount);
+
     auto vpParam             = Wrapper::UniformParameter::create();  
     vpParam->mBinding        = 0;                                    
     vpParam->mCount          = 1;                                   
-    vpParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    vpParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     vpParam->mSize           = sizeof(VPMatrices);
     vpParam->mStage          = VK_SHADER_STAGE_VERTEX_BIT;
-
-    for (int i = 0; i < frameCount; ++i)
-    {
-        auto buffer = Wrapper::Buffer::createUniformBuffer(device, vpParam->mSize, nullptr);
-        vpParam->mBuffers.push_back(buffer);
-    }
+    vpParam->mBuffers.assign(frameCount, mRingBuffer->getBuffer());
     mUniformParams.push_back(vpParam);
 
     auto objectParam             = Wrapper::UniformParameter::create();
     objectParam->mBinding        = 1;
     objectParam->mCount          = 1;
-    objectParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    objectParam->mDescriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     objectParam->mSize           = sizeof(ObjectUniform);
     objectParam->mStage          = VK_SHADER_STAGE_VERTEX_BIT;
+    objectParam->mBuffers.assign(frameCount, mRingBuffer->getBuffer());
+    mUniformParams.push_back(objectParam);
 
-    for (int i = 0; i < frameCount; ++i)
+    // 模型的全部贴图并行解码 / 压缩，再由同一个上传上下文一次提交；依次绑定到 2、3、4、5，目前片段着色器只采样 2（漫反射）
+    const std::vector<Texture::Source> textureSources =
     {
-        auto buffer = Wrapper::Buffer::createUniformBuffer(device, objectParam->mSize, nullptr);
-        objectParam->mBuffers.push_back(buffer);
+        { "assets/models/diablo3_pose/diablo3_pose_diffuse.tga",    Texture::MipmapMode::Auto, BlockFormat::BC7 },
+        { "assets/models/diablo3_pose/diablo3_pose_nm_tangent.tga", Texture::MipmapMode::Auto, BlockFormat::BC5 },
+        { "assets/models/diablo3_pose/diablo3_pose_spec.tga",       Texture::MipmapMode::Auto, BlockFormat::BC4 },
+        { "assets/models/diablo3_pose/diablo3_pose_glow.tga",       Texture::MipmapMode::Auto, BlockFormat::BC1 }
+    };
+
+    std::vector<Texture::Ptr> textures{};
+
+    if (streamer != nullptr)
+    {
+        // 流送纹理同样经过资源缓存，同一文件只创建一个流送句柄
+        mStreamedTextures = assetCache != nullptr ? assetCache->getStreamedTextures(textureSources, streamer, uploadContext, textureDecodeThreads)
+                                                  : streamer->addTextures(textureSources, uploadContext, textureDecodeThreads);
+
+        for (const auto& streamed : mStreamedTextures)
+        {
+            textures.push_back(streamed->getTexture());
+        }
+    }
+    else if (assetCache != nullptr)
+    {
+        textures = assetCache->getTextures(textureSources, uploadContext, textureDecodeThreads);
+    }
+    else
+    {
+        textures = Texture::createTextures(mDevice, textureSources, uploadContext, textureDecodeThreads);
     }
-    mUniformParams.push_back(objectParam);
 
-    auto textureParam             = Wrapper::UniformParameter::create();
-    textureParam->mBinding        = 2;
-    textureParam->mCount          = 1;
-    textureParam->mDescriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    textureParam->mStage          = VK_SHADER_STAGE_FRAGMENT_BIT;
-    textureParam->mTexture        = Texture::create(mDevice, commandPool, "assets/models/diablo3_pose/diablo3_pose_diffuse.tga");
-    mUniformParams.push_back(textureParam);
+    for (size_t i = 0; i < textures.size(); ++i)
+    {
+        auto textureParam             = Wrapper::UniformParameter::create();
+        textureParam->mBinding        = static_cast<uint32_t>(2 + i);
+        textureParam->mCount          = 1;
+        textureParam->mDescriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        textureParam->mStage          = VK_SHADER_STAGE_FRAGMENT_BIT;
+        textureParam->mTexture        = textures[i];
+        mUniformParams.push_back(textureParam);
+    }
 
     mDescriptorSetLayout = Wrapper::DescriptorSetLayout::create(device);
     mDescriptorSetLayout->build(mUniformParams);
@@ -54,16 +95,46 @@ void UniformManager::init(const Wrapper::Device::Ptr& device, const Wrapper::Com
     mDescriptorPool = Wrapper::DescriptorPool::create(device);
     mDescriptorPool->build(mUniformParams, frameCount);
 
+    // 每个在途帧一个描述符集（都指向同一个环形缓冲区），流送替换贴图时只改写 GPU 已用完的那一帧的描述符集
     mDescriptorSet = Wrapper::DescriptorSet::create(device, mUniformParams, mDescriptorSetLayout, mDescriptorPool, frameCount);
+
+    // 流送替换新级别时同步更新参数和描述符
+    for (size_t i = 0; i < mStreamedTextures.size(); ++i)
+    {
+        mStreamedTextures[i]->bind(mDescriptorSet, mUniformParams[2 + i]);
+    }
+
+    // 动态偏移在每帧 update 之后录制命令时读取；先为每帧写一遍默认值，保证第一次 update 之前偏移也有效
+    mDynamicOffsets.resize(frameCount);
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        update(VPMatrices{}, { ObjectUniform{} }, i);
+    }
 }
 
-void UniformManager::update(const VPMatrices& vpMatrices, const ObjectUniform& objectUniform, const int& frameCount)
+void UniformManager::update(const VPMatrices& vpMatrices, const std::vector<ObjectUniform>& objectUniforms, const int& frameCount)
 {
-    mUniformParams[0]->mBuffers[frameCount]->updateBufferByMap((void*)(&vpMatrices),
-                                                                sizeof(VPMatrices));
+    // 每份常量一次 memcpy，返回的偏移就是绑定时的动态偏移；VP 所有物体共用一份，绘制每个物体时只换绑定点 1 的偏移
+    mRingBuffer->beginFrame(frameCount);
 
-    mUniformParams[1]->mBuffers[frameCount]->updateBufferByMap((void*)(&objectUniform),
-                                                                sizeof(ObjectUniform));
+    const uint32_t vpOffset = mRingBuffer->push(vpMatrices);
 
-    // 注意：纹理不需要每帧更新，初始设置后即保持
+    auto& offsets = mDynamicOffsets[frameCount];
+    offsets.resize(objectUniforms.size());
+
+    for (size_t i = 0; i < objectUniforms.size(); ++i)
+    {
+        offsets[i].assign({ vpOffset, mRingBuffer->push(objectUniforms[i]) });
+    }
+
+    // 注意：纹理不需要每帧更新，初始设置后即保持（流送的替换由 TextureStreamer::applySwaps 完成）
+}
+
+void UniformManager::setTextureScreenSize(float pixels)
+{
+    for (const auto& streamed : mStreamedTextures)
+    {
+        streamed->setScreenSize(pixels);
+    }
 }
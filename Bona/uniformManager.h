@@ -1,13 +1,16 @@
 ﻿#pragma once
 
 #include "vulkanWrapper/buffer.h"
+#include "vulkanWrapper/uniformRingBuffer.h"
 #include "vulkanWrapper/descriptorSetLayout.h"
 #include "vulkanWrapper/descriptorPool.h"
 #include "vulkanWrapper/descriptorSet.h"
 #include "vulkanWrapper/description.h"
 #include "vulkanWrapper/device.h"
-#include "vulkanWrapper/commandPool.h"
+#include "vulkanWrapper/uploadContext.h"
 #include "vulkanWrapper/base.h"
+#include "texture/textureStreamer.h"
+#include "assetCache.h"
 
 using namespace LearnVulkan;
 
@@ -21,20 +24,43 @@ public:
 
     ~UniformManager();
 
-    void init(const Wrapper::Device::Ptr &device, const Wrapper::CommandPool::Ptr &commandPool, int frameCount);
+    /// 纹理上传记录在 uploadContext 中，调用方在录制 / 提交命令缓冲区之前提交
+    // textureDecodeThreads 为 0 时按硬件线程数并行解码贴图，为 1 时串行
+    // 给出 streamer 时贴图由它流送：先只驻留最粗的几级，精细级别按屏幕尺寸和显存预算逐级替换进描述符集；
+    // 给出 assetCache 时贴图（包括流送纹理）从缓存取得，与其他使用者共用
+    void init(const Wrapper::Device::Ptr &device, const Wrapper::UploadContext::Ptr &uploadContext, int frameCount,
+              uint32_t textureDecodeThreads = 0, const TextureStreamer::Ptr &streamer = nullptr,
+              const AssetCache::Ptr &assetCache = nullptr);
 
-    void update(const VPMatrices &vpMatrices, const ObjectUniform &objectUniform, const int& frameCount);
+    /// 每帧可绘制的最多物体数，决定环形缓冲区每帧段的大小；需在 init 之前设置
+    void setObjectCapacity(uint32_t count) { mObjectCapacity = std::max(1u, count); }
+
+    /// 写入第 frameCount 帧的 VP 和每个物体的常量，物体数不能超过 setObjectCapacity
+    void update(const VPMatrices &vpMatrices, const std::vector<ObjectUniform> &objectUniforms, const int& frameCount);
+
+    /// 模型在屏幕上的尺寸（像素），模型的贴图都按它选择流送的级别
+    void setTextureScreenSize(float pixels);
 
     [[nodiscard]] auto getDescriptorLayout() const { return mDescriptorSetLayout; }
 
+    // VP / 物体常量都在环形缓冲区里，帧之间只有动态偏移不同；描述符集每帧一个，贴图替换可以逐帧进行
     [[nodiscard]] auto getDescriptorSet(int frameCount) const { return mDescriptorSet->getDescriptorSet(frameCount); }
 
+    /// 第 frameCount 帧绘制第 object 个物体时绑定描述符集使用的动态偏移（绑定点 0、1）；可从多个录制线程同时读取
+    [[nodiscard]] const auto& getDynamicOffsets(int frameCount, uint32_t object = 0) const { return mDynamicOffsets[frameCount][object]; }
+
 private:
     Wrapper::Device::Ptr mDevice{ nullptr };
 
     std::vector<Wrapper::UniformParameter::Ptr> mUniformParams;
 
+    Wrapper::UniformRingBuffer::Ptr                 mRingBuffer{ nullptr };
+    std::vector<std::vector<std::vector<uint32_t>>> mDynamicOffsets{};   // [帧][物体]
+    uint32_t                                        mObjectCapacity{ 1 };
+
     Wrapper::DescriptorSetLayout::Ptr mDescriptorSetLayout{ nullptr };
     Wrapper::DescriptorPool::Ptr      mDescriptorPool{ nullptr };
     Wrapper::DescriptorSet::Ptr       mDescriptorSet{ nullptr };
+
+    std::vector<TextureStreamer::StreamedTexture::Ptr> mStreamedTextures{};
 };
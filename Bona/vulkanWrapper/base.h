@@ -40,9 +40,15 @@ struct VPMatrices
 struct ObjectUniform
 {
     glm::mat4 mModelMatrix;
+    glm::vec4 mPositionScale;   // 量化顶点的反量化参数：position = encoded * scale + offset
+    glm::vec4 mPositionOffset;
+    glm::vec4 mUVTransform;     // uv = encoded * xy + zw
 
     ObjectUniform()
     {
-        mModelMatrix = glm::mat4(1.0f);
+        mModelMatrix    = glm::mat4(1.0f);
+        mPositionScale  = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+        mPositionOffset = glm::vec4(0.0f);
+        mUVTransform    = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
     }
 };
@@ -1,34 +1,68 @@
 ﻿#include "buffer.h"
 #include "commandBuffer.h"
 #include"commandPool.h"
+#include "uploadContext.h"
+
+#include <cstring>
 
 namespace LearnVulkan::Wrapper
 {
-    Buffer::Ptr Buffer::createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData)
+    static void uploadInitialData(const Buffer::Ptr& buffer, VkDeviceSize size, const void* pData, const std::shared_ptr<UploadContext>& uploadContext)
+    {
+        if (pData == nullptr)
+        {
+            return;
+        }
+
+        if (uploadContext != nullptr)
+        {
+            uploadContext->uploadBuffer(buffer, pData, size);
+        }
+        else
+        {
+            buffer->updateBufferByStage(pData, size);
+        }
+    }
+
+    Buffer::Ptr Buffer::createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, const std::shared_ptr<UploadContext>& uploadContext)
     {
         auto buffer = Buffer::create(device,
                                      size,
                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        buffer->updateBufferByStage(pData, size);
+        uploadInitialData(buffer, size, pData, uploadContext);
+
+        return buffer;
+    }
+
+    Buffer::Ptr Buffer::createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, VkBufferUsageFlags extraUsage,
+                                          const std::shared_ptr<UploadContext>& uploadContext)
+    {
+        auto buffer = Buffer::create(device,
+                                     size,
+                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | extraUsage,
+                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        uploadInitialData(buffer, size, pData, uploadContext);
 
         return buffer;
     }
 
-    Buffer::Ptr Buffer::createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData)
+    Buffer::Ptr Buffer::createStorageBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, VkBufferUsageFlags extraUsage,
+                                            const std::shared_ptr<UploadContext>& uploadContext)
     {
         auto buffer = Buffer::create(device,
                                      size,
-                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                     VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | extraUsage,
                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        buffer->updateBufferByStage(pData, size);
+        uploadInitialData(buffer, size, pData, uploadContext);
 
         return buffer;
     }
 
-    Buffer::Ptr Buffer::createUniformBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData)
+    Buffer::Ptr Buffer::createUniformBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData)
     {
         auto buffer = Buffer::create(device,
                                      size,
@@ -43,7 +77,22 @@ namespace LearnVulkan::Wrapper
         return buffer;
     }
 
-    Buffer::Ptr Buffer::createStageBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData)
+    Buffer::Ptr Buffer::createIndirectBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData)
+    {
+        auto buffer = Buffer::create(device,
+                                     size,
+                                     VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        if (pData != nullptr)
+        {
+            buffer->updateBufferByMap(pData, size);
+        }
+
+        return buffer;
+    }
+
+    Buffer::Ptr Buffer::createStageBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData)
     {
         auto buffer = Buffer::create(device,
                                      size,
@@ -76,18 +125,68 @@ namespace LearnVulkan::Wrapper
         VkMemoryRequirements memReq{};
         vkGetBufferMemoryRequirements(mDevice->getDevice(), mBuffer, &memReq);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memReq.size;
+        mAllocation = mDevice->getAllocator()->allocate(memReq, properties, MemoryAllocator::ResourceKind::Linear);
 
-        allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties);
+        vkBindBufferMemory(mDevice->getDevice(), mBuffer, mAllocation.mMemory, mAllocation.mOffset);
 
-        if (vkAllocateMemory(mDevice->getDevice(), &allocInfo, nullptr, &mBufferMemory) != VK_SUCCESS)
+        mBufferInfo.buffer = mBuffer;
+        mBufferInfo.offset = 0;
+        mBufferInfo.range  = size;
+    }
+
+    Buffer::Buffer(const Device::Ptr& device, void* hostPointer, VkDeviceSize size)
+    {
+        mDevice = device;
+
+        VkExternalMemoryBufferCreateInfoKHR externalInfo{};
+        externalInfo.sType       = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO_KHR;
+        externalInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+
+        VkBufferCreateInfo createInfo{};
+        createInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        createInfo.pNext       = &externalInfo;
+        createInfo.size        = size;
+        createInfo.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(mDevice->getDevice(), &createInfo, nullptr, &mBuffer) != VK_SUCCESS)
         {
-            throw std::runtime_error("Error: failed to allocate memory!");
+            throw std::runtime_error("Error: failed to create host import buffer!");
         }
 
-        vkBindBufferMemory(mDevice->getDevice(), mBuffer, mBufferMemory, 0);
+        VkMemoryRequirements memReq{};
+        vkGetBufferMemoryRequirements(mDevice->getDevice(), mBuffer, &memReq);
+
+        // 内存类型必须同时满足缓冲区和主机指针的要求
+        const uint32_t typeBits = memReq.memoryTypeBits & mDevice->getHostPointerMemoryTypes(hostPointer);
+
+        if (typeBits == 0)
+        {
+            vkDestroyBuffer(mDevice->getDevice(), mBuffer, nullptr);
+            throw std::runtime_error("Error: host pointer cannot be imported!");
+        }
+
+        VkImportMemoryHostPointerInfoEXT importInfo{};
+        importInfo.sType        = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+        importInfo.handleType   = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+        importInfo.pHostPointer = hostPointer;
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.pNext           = &importInfo;
+        allocInfo.allocationSize  = size;
+        allocInfo.memoryTypeIndex = mDevice->getAllocator()->findMemoryType(typeBits, 0);
+
+        if (vkAllocateMemory(mDevice->getDevice(), &allocInfo, nullptr, &mImportedMemory) != VK_SUCCESS)
+        {
+            vkDestroyBuffer(mDevice->getDevice(), mBuffer, nullptr);
+            throw std::runtime_error("Error: failed to import host memory!");
+        }
+
+        vkBindBufferMemory(mDevice->getDevice(), mBuffer, mImportedMemory, 0);
+
+        mAllocation.mMappedData = hostPointer;
+        mAllocation.mSize       = size;
 
         mBufferInfo.buffer = mBuffer;
         mBufferInfo.offset = 0;
@@ -101,40 +200,29 @@ namespace LearnVulkan::Wrapper
             vkDestroyBuffer(mDevice->getDevice(), mBuffer, nullptr);
         }
 
-        if (mBufferMemory != VK_NULL_HANDLE)
+        if (mImportedMemory != VK_NULL_HANDLE)
         {
-            vkFreeMemory(mDevice->getDevice(), mBufferMemory, nullptr);
+            vkFreeMemory(mDevice->getDevice(), mImportedMemory, nullptr);
+            return;
         }
+
+        mDevice->getAllocator()->free(mAllocation);
     }
 
-    uint32_t Buffer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+    void Buffer::updateBufferByMap(const void* data, size_t size, VkDeviceSize offset)
     {
-        VkPhysicalDeviceMemoryProperties memProps;
-        vkGetPhysicalDeviceMemoryProperties(mDevice->getPhysicalDevice(), &memProps);
-
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
+        // 主机可见内存由分配器常驻映射，直接写入
+        if (mAllocation.mMappedData == nullptr)
         {
-            if ((typeFilter & (1 << i)) && ((memProps.memoryTypes[i].propertyFlags & properties) == properties))
-            {
-                return i;
-            }
+            throw std::runtime_error("Error: buffer memory is not host visible!");
         }
 
-        throw std::runtime_error("Error: cannot find the property memory type!");
-    }
-
-    void Buffer::updateBufferByMap(void* data, size_t size)
-    {
-        void* memPtr = nullptr;
-
-        vkMapMemory(mDevice->getDevice(), mBufferMemory, 0, size, 0, &memPtr);
-
-        memcpy(memPtr, data, size);
+        memcpy(static_cast<uint8_t*>(mAllocation.mMappedData) + offset, data, size);
 
-        vkUnmapMemory(mDevice->getDevice(), mBufferMemory);
+        mDevice->getAllocator()->flush(mAllocation, offset, size);
     }
 
-    void Buffer::updateBufferByStage(void* data, size_t size)
+    void Buffer::updateBufferByStage(const void* data, size_t size)
     {
         auto stageBuffer = Buffer::create(mDevice,
                                           size,
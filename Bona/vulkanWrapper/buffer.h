@@ -5,6 +5,8 @@
 
 namespace LearnVulkan::Wrapper
 {
+    class UploadContext;
+
     class Buffer
     {
     public:
@@ -15,22 +17,43 @@ namespace LearnVulkan::Wrapper
         }
 
     public:
-        static Ptr createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, void * pData);
+        // 设备本地缓冲区的初始数据：传入 uploadContext 时只记录复制请求，由调用方统一 flush；
+        // 否则立即通过临时暂存缓冲区同步上传
+        static Ptr createVertexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData,
+                                      const std::shared_ptr<UploadContext>& uploadContext = nullptr);
+
+        /// extraUsage 用于同时作为其他用途读取（如计算着色器以存储缓冲区读取索引）
+        static Ptr createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData, VkBufferUsageFlags extraUsage = 0,
+                                     const std::shared_ptr<UploadContext>& uploadContext = nullptr);
+
+        static Ptr createUniformBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData = nullptr);
+
+        static Ptr createStorageBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData = nullptr, VkBufferUsageFlags extraUsage = 0,
+                                       const std::shared_ptr<UploadContext>& uploadContext = nullptr);
 
-        static Ptr createIndexBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData);
+        /// 主机可见的间接绘制参数缓冲区，CPU 每帧直接改写
+        static Ptr createIndirectBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData = nullptr);
 
-        static Ptr createUniformBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData = nullptr);
+        static Ptr createStageBuffer(const Device::Ptr& device, VkDeviceSize size, const void* pData = nullptr);
 
-        static Ptr createStageBuffer(const Device::Ptr& device, VkDeviceSize size, void* pData = nullptr);
+        /// 把主机内存 [hostPointer, hostPointer + size) 直接导入为传输源缓冲区（VK_EXT_external_memory_host），不拷贝。
+        /// 指针和 size 都要按 Device::getHostPointerAlignment 对齐，缓冲区销毁前主机内存必须保持有效
+        static Ptr createHostImportBuffer(const Device::Ptr& device, void* hostPointer, VkDeviceSize size)
+        {
+            return std::make_shared<Buffer>(device, hostPointer, size);
+        }
 
     public:
         Buffer(const Device::Ptr &device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
 
+        Buffer(const Device::Ptr& device, void* hostPointer, VkDeviceSize size);
+
         ~Buffer();
 
-        void updateBufferByMap(void *data, size_t size);
+        /// 写入常驻映射的主机可见内存的 [offset, offset + size)
+        void updateBufferByMap(const void* data, size_t size, VkDeviceSize offset = 0);
 
-        void updateBufferByStage(void* data, size_t size);
+        void updateBufferByStage(const void* data, size_t size);
 
         void copyBuffer(const VkBuffer& srcBuffer, const VkBuffer& dstBuffer, VkDeviceSize size);
 
@@ -38,12 +61,12 @@ namespace LearnVulkan::Wrapper
 
         [[nodiscard]] VkDescriptorBufferInfo& getBufferInfo() { return mBufferInfo; }
 
-    private:
-        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+        [[nodiscard]] const auto& getAllocation() const { return mAllocation; }
 
     private:
         VkBuffer               mBuffer{ VK_NULL_HANDLE };
-        VkDeviceMemory         mBufferMemory{ VK_NULL_HANDLE };
+        MemoryAllocation       mAllocation{};
+        VkDeviceMemory         mImportedMemory{ VK_NULL_HANDLE };   // 导入的主机内存，不经过分配器
         Device::Ptr            mDevice{ nullptr };
         VkDescriptorBufferInfo mBufferInfo{};
     };
@@ -52,6 +52,11 @@ namespace LearnVulkan::Wrapper
         vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
     }
 
+    void CommandBuffer::bindComputePipeline(const VkPipeline& pipeline)
+    {
+        vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    }
+
     void CommandBuffer::bindVertexBuffer(const std::vector<VkBuffer>& buffers)
     {
         std::vector<VkDeviceSize> offsets(buffers.size(), 0);
@@ -59,15 +64,15 @@ namespace LearnVulkan::Wrapper
         vkCmdBindVertexBuffers(mCommandBuffer, 0, static_cast<uint32_t>(buffers.size()), buffers.data(), offsets.data());
     }
 
-    void CommandBuffer::bindIndexBuffer(const VkBuffer& buffer)
+    void CommandBuffer::bindIndexBuffer(const VkBuffer& buffer, VkIndexType indexType)
     {
-        vkCmdBindIndexBuffer(mCommandBuffer, buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(mCommandBuffer, buffer, 0, indexType);
     }
 
-    void CommandBuffer::bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet& descriptorSet)
+    void CommandBuffer::bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet& descriptorSet, VkPipelineBindPoint bindPoint)
     {
         vkCmdBindDescriptorSets(mCommandBuffer,
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                bindPoint,
                                 layout,
                                 0,               // 第一个描述符集
                                 1,               // 描述符集数量
@@ -76,6 +81,21 @@ namespace LearnVulkan::Wrapper
                                 nullptr);        // 动态偏移数组
     }
 
+    void CommandBuffer::bindDescriptorSet(const VkPipelineLayout layout,
+                                          const VkDescriptorSet& descriptorSet,
+                                          const std::vector<uint32_t>& dynamicOffsets,
+                                          VkPipelineBindPoint bindPoint)
+    {
+        vkCmdBindDescriptorSets(mCommandBuffer,
+                                bindPoint,
+                                layout,
+                                0,
+                                1,
+                                &descriptorSet,
+                                static_cast<uint32_t>(dynamicOffsets.size()),
+                                dynamicOffsets.data());
+    }
+
     void CommandBuffer::draw(size_t vertexCount)
     {
         vkCmdDraw(mCommandBuffer,
@@ -85,16 +105,44 @@ namespace LearnVulkan::Wrapper
                   0);
     }
 
-    void CommandBuffer::drawIndex(size_t indexCount)
+    void CommandBuffer::drawIndex(size_t indexCount, uint32_t firstIndex)
     {
         vkCmdDrawIndexed(mCommandBuffer,
                          indexCount,  // 索引数量
                          1,           // 实例数量
-                         0,           // 首个索引偏移
+                         firstIndex,  // 首个索引偏移
                          0,           // 顶点偏移
                          0);          // 首个实例索引
     }
 
+    void CommandBuffer::drawIndexIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount)
+    {
+        vkCmdDrawIndexedIndirect(mCommandBuffer,
+                                 buffer,
+                                 offset,
+                                 drawCount,
+                                 sizeof(VkDrawIndexedIndirectCommand));
+    }
+
+    void CommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+    {
+        vkCmdDispatch(mCommandBuffer, groupCountX, groupCountY, groupCountZ);
+    }
+
+    void CommandBuffer::updateBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const void* pData)
+    {
+        // 数据直接记录在命令缓冲区中，大小须为 4 的倍数且不超过 65536 字节
+        vkCmdUpdateBuffer(mCommandBuffer, buffer, offset, size, pData);
+    }
+
+    void CommandBuffer::executeCommands(const std::vector<VkCommandBuffer>& commandBuffers)
+    {
+        if (!commandBuffers.empty())
+        {
+            vkCmdExecuteCommands(mCommandBuffer, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+        }
+    }
+
     void CommandBuffer::endRenderPass()
     {
         vkCmdEndRenderPass(mCommandBuffer);
@@ -113,13 +161,13 @@ namespace LearnVulkan::Wrapper
         vkCmdCopyBuffer(mCommandBuffer, srcBuffer, dstBuffer, copyInfoCount, copyInfos.data());
     }
 
-    void CommandBuffer::copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height)
+    void CommandBuffer::copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height, VkDeviceSize bufferOffset)
     {
         // 定义缓冲区到图像的复制区域描述结构体（Vulkan API核心结构）
         VkBufferImageCopy region{};
 
-        // 缓冲区数据起始偏移量（从缓冲区的第0字节开始复制）
-        region.bufferOffset = 0;
+        // 缓冲区数据起始偏移量（批量上传时为数据在暂存环形缓冲区中的位置）
+        region.bufferOffset = bufferOffset;
 
         // 缓冲区数据的"行长度"（单位：字节）：
         // 0表示缓冲区中的数据是**紧密排列**的（无额外行间距），Vulkan会自动根据图像格式计算实际行宽
@@ -157,6 +205,21 @@ namespace LearnVulkan::Wrapper
                                &region);
     }
 
+    void CommandBuffer::copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, const std::vector<VkBufferImageCopy>& regions)
+    {
+        vkCmdCopyBufferToImage(mCommandBuffer,
+                               srcBuffer,
+                               dstImage,
+                               dstImageLayout,
+                               static_cast<uint32_t>(regions.size()),
+                               regions.data());
+    }
+
+    void CommandBuffer::blitImage(VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const VkImageBlit& region, VkFilter filter)
+    {
+        vkCmdBlitImage(mCommandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, 1, &region, filter);
+    }
+
     void CommandBuffer::transferImageLayout(const VkImageMemoryBarrier& imageMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
     {
         vkCmdPipelineBarrier(mCommandBuffer,
@@ -171,6 +234,75 @@ namespace LearnVulkan::Wrapper
                              &imageMemoryBarrier);
     }
 
+    void CommandBuffer::transferImageLayout(const std::vector<VkImageMemoryBarrier>& imageMemoryBarriers, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+    {
+        if (imageMemoryBarriers.empty())
+        {
+            return;
+        }
+
+        vkCmdPipelineBarrier(mCommandBuffer,
+                             srcStageMask,
+                             dstStageMask,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(imageMemoryBarriers.size()),
+                             imageMemoryBarriers.data());
+    }
+
+    void CommandBuffer::memoryBarrier(const VkMemoryBarrier& memoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+    {
+        vkCmdPipelineBarrier(mCommandBuffer,
+                             srcStageMask,
+                             dstStageMask,
+                             0,
+                             1,
+                             &memoryBarrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+    }
+
+    void CommandBuffer::pipelineBarrier(const std::vector<VkBufferMemoryBarrier>& bufferMemoryBarriers,
+                                        const std::vector<VkImageMemoryBarrier>& imageMemoryBarriers,
+                                        VkPipelineStageFlags srcStageMask,
+                                        VkPipelineStageFlags dstStageMask)
+    {
+        if (bufferMemoryBarriers.empty() && imageMemoryBarriers.empty())
+        {
+            return;
+        }
+
+        vkCmdPipelineBarrier(mCommandBuffer,
+                             srcStageMask,
+                             dstStageMask,
+                             0,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(bufferMemoryBarriers.size()),
+                             bufferMemoryBarriers.data(),
+                             static_cast<uint32_t>(imageMemoryBarriers.size()),
+                             imageMemoryBarriers.data());
+    }
+
+    void CommandBuffer::bufferBarrier(const VkBufferMemoryBarrier& bufferMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask)
+    {
+        vkCmdPipelineBarrier(mCommandBuffer,
+                             srcStageMask,
+                             dstStageMask,
+                             0,
+                             0,
+                             nullptr,
+                             1,
+                             &bufferMemoryBarrier,
+                             0,
+                             nullptr);
+    }
+
     /**
      * @brief 同步提交命令缓冲区到指定队列，并等待队列执行完成
      *
@@ -26,15 +26,32 @@ namespace LearnVulkan::Wrapper
 
         void bindGraphicPipeline(const VkPipeline &pipeline);
 
+        void bindComputePipeline(const VkPipeline &pipeline);
+
         void bindVertexBuffer(const std::vector<VkBuffer> &buffers);
 
-        void bindIndexBuffer(const VkBuffer &buffer);
+        void bindIndexBuffer(const VkBuffer &buffer, VkIndexType indexType = VK_INDEX_TYPE_UINT32);
+
+        void bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet &descriptorSet, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
 
-        void bindDescriptorSet(const VkPipelineLayout layout, const VkDescriptorSet &descriptorSet);
+        /// 带动态偏移绑定，dynamicOffsets 按绑定点顺序对应集合中的每个 *_DYNAMIC 描述符
+        void bindDescriptorSet(const VkPipelineLayout layout,
+                               const VkDescriptorSet &descriptorSet,
+                               const std::vector<uint32_t> &dynamicOffsets,
+                               VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
 
         void draw(size_t vertexCount);
 
-        void drawIndex(size_t indexCount);
+        void drawIndex(size_t indexCount, uint32_t firstIndex = 0);
+
+        void drawIndexIndirect(VkBuffer buffer, VkDeviceSize offset = 0, uint32_t drawCount = 1);
+
+        void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+        void updateBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, const void* pData);
+
+        /// 执行二级命令缓冲区；所在子通道须以 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS 开始
+        void executeCommands(const std::vector<VkCommandBuffer>& commandBuffers);
 
         void endRenderPass();
 
@@ -42,10 +59,28 @@ namespace LearnVulkan::Wrapper
 
         void copyBufferToBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t copyInfoCount, const std::vector<VkBufferCopy>& copyInfos);
 
-        void copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height);
+        void copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0);
+
+        /// 一次复制多个区域（如完整 mip 链的每一级）
+        void copyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, const std::vector<VkBufferImageCopy>& regions);
+
+        void blitImage(VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout, const VkImageBlit& region, VkFilter filter);
 
         void transferImageLayout(const VkImageMemoryBarrier& imageMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
 
+        /// 多个图像的布局转换合并到一次 vkCmdPipelineBarrier
+        void transferImageLayout(const std::vector<VkImageMemoryBarrier>& imageMemoryBarriers, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
+
+        void memoryBarrier(const VkMemoryBarrier& memoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
+
+        /// 缓冲区和图像屏障合并到一次 vkCmdPipelineBarrier（如队列族所有权的释放 / 获取）
+        void pipelineBarrier(const std::vector<VkBufferMemoryBarrier>& bufferMemoryBarriers,
+                             const std::vector<VkImageMemoryBarrier>& imageMemoryBarriers,
+                             VkPipelineStageFlags srcStageMask,
+                             VkPipelineStageFlags dstStageMask);
+
+        void bufferBarrier(const VkBufferMemoryBarrier& bufferMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
+
         void submitSync(VkQueue queue, VkFence fence = VK_NULL_HANDLE);
 
         [[nodiscard]] auto getCommandBuffer() const { return mCommandBuffer; }
@@ -2,13 +2,13 @@
 
 namespace LearnVulkan::Wrapper
 {
-    CommandPool::CommandPool(const Device::Ptr& device, VkCommandPoolCreateFlagBits flag)
+    CommandPool::CommandPool(const Device::Ptr& device, VkCommandPoolCreateFlagBits flag, std::optional<uint32_t> queueFamily)
     {
         mDevice = device;
 
         VkCommandPoolCreateInfo createInfo{};
         createInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        createInfo.queueFamilyIndex = device->getGraphicQueueFamily().value();
+        createInfo.queueFamilyIndex = queueFamily.has_value() ? queueFamily.value() : device->getGraphicQueueFamily().value();
         createInfo.flags            = flag;
 
         if (vkCreateCommandPool(mDevice->getDevice(), &createInfo, nullptr, &mCommandPool) != VK_SUCCESS)
@@ -24,4 +24,12 @@ namespace LearnVulkan::Wrapper
             vkDestroyCommandPool(mDevice->getDevice(), mCommandPool, nullptr);
         }
     }
+
+    void CommandPool::reset(VkCommandPoolResetFlags flags)
+    {
+        if (vkResetCommandPool(mDevice->getDevice(), mCommandPool, flags) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to reset command pool!");
+        }
+    }
 }
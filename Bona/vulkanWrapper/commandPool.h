@@ -10,15 +10,23 @@ namespace LearnVulkan::Wrapper
     public:
         using Ptr = std::shared_ptr<CommandPool>;
 
-        static Ptr create(const Device::Ptr& device, VkCommandPoolCreateFlagBits flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT)
+        // queueFamily 为空时使用图形队列族
+        static Ptr create(const Device::Ptr& device,
+                          VkCommandPoolCreateFlagBits flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                          std::optional<uint32_t> queueFamily = std::nullopt)
         {
-            return std::make_shared<CommandPool>(device, flag); 
+            return std::make_shared<CommandPool>(device, flag, queueFamily); 
         }
 
-        CommandPool(const Device::Ptr &device, VkCommandPoolCreateFlagBits flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+        CommandPool(const Device::Ptr &device,
+                    VkCommandPoolCreateFlagBits flag = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                    std::optional<uint32_t> queueFamily = std::nullopt);
 
         ~CommandPool();
 
+        /// 把池中所有命令缓冲区一次性重置回初始状态，比逐个释放再分配便宜；调用前这些命令缓冲区必须都已执行完毕
+        void reset(VkCommandPoolResetFlags flags = 0);
+
         [[nodiscard]] auto getCommandPool() const { return mCommandPool; }
 
     private:
@@ -0,0 +1,58 @@
+﻿#include "computePipeline.h"
+
+namespace LearnVulkan::Wrapper
+{
+    ComputePipeline::ComputePipeline(const Device::Ptr& device)
+    {
+        mDevice = device;
+
+        mLayoutState.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    }
+
+    ComputePipeline::~ComputePipeline()
+    {
+        if (mLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(mDevice->getDevice(), mLayout, nullptr);
+        }
+
+        if (mPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(mDevice->getDevice(), mPipeline, nullptr);
+        }
+    }
+
+    void ComputePipeline::build()
+    {
+        if (mLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(mDevice->getDevice(), mLayout, nullptr);
+        }
+
+        if (vkCreatePipelineLayout(mDevice->getDevice(), &mLayoutState, nullptr, &mLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to create compute pipeline layout!");
+        }
+
+        VkComputePipelineCreateInfo pipelineCreateInfo{};
+        pipelineCreateInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineCreateInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineCreateInfo.stage.stage  = mShader->getShaderStage();
+        pipelineCreateInfo.stage.pName  = mShader->getShaderEntryPoint().c_str();
+        pipelineCreateInfo.stage.module = mShader->getShaderModule();
+        pipelineCreateInfo.layout       = mLayout;
+
+        pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+        pipelineCreateInfo.basePipelineIndex  = -1;
+
+        if (mPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(mDevice->getDevice(), mPipeline, nullptr);
+        }
+
+        if (vkCreateComputePipelines(mDevice->getDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &mPipeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to create compute pipeline!");
+        }
+    }
+}
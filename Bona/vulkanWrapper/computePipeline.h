@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "base.h"
+#include "device.h"
+#include "shader.h"
+
+namespace LearnVulkan::Wrapper
+{
+    class ComputePipeline
+    {
+    public:
+        using Ptr = std::shared_ptr<ComputePipeline>;
+
+        static Ptr create(const Device::Ptr& device)
+        {
+            return std::make_shared<ComputePipeline>(device);
+        }
+
+        ComputePipeline(const Device::Ptr& device);
+
+        ~ComputePipeline();
+
+        void setShader(const Shader::Ptr& shader) { mShader = shader; }
+
+        void build();
+
+    public:
+        VkPipelineLayoutCreateInfo mLayoutState{};
+
+    public:
+        [[nodiscard]] auto getPipeline() const { return mPipeline; }
+        [[nodiscard]] auto getLayout()   const { return mLayout; }
+
+    private:
+        VkPipeline       mPipeline{ VK_NULL_HANDLE };
+        VkPipelineLayout mLayout{ VK_NULL_HANDLE };
+        Device::Ptr      mDevice{ nullptr };
+        Shader::Ptr      mShader{ nullptr };
+    };
+}
@@ -19,11 +19,15 @@ namespace LearnVulkan::Wrapper
     void DescriptorPool::build(std::vector<UniformParameter::Ptr>& params, const int& frameCount)
     {
         int uniformBufferCount = 0;
+        int dynamicBufferCount = 0;
+        int storageBufferCount = 0;
         int textureCount       = 0;
 
         for (const auto& param : params)
         {
             if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) { uniformBufferCount++; }
+            if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) { dynamicBufferCount++; }
+            if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) { storageBufferCount++; }
             if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) { textureCount++; }
 
             // 注：可扩展支持更多描述符类型
@@ -31,15 +35,38 @@ namespace LearnVulkan::Wrapper
 
         std::vector<VkDescriptorPoolSize> poolSizes{};
 
-        VkDescriptorPoolSize uniformBufferSize{};
-        uniformBufferSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        uniformBufferSize.descriptorCount = uniformBufferCount * frameCount;
-        poolSizes.push_back(uniformBufferSize);
+        // 描述符数量为 0 的类型不能出现在池大小里
+        if (uniformBufferCount > 0)
+        {
+            VkDescriptorPoolSize uniformBufferSize{};
+            uniformBufferSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            uniformBufferSize.descriptorCount = uniformBufferCount * frameCount;
+            poolSizes.push_back(uniformBufferSize);
+        }
+
+        if (dynamicBufferCount > 0)
+        {
+            VkDescriptorPoolSize dynamicBufferSize{};
+            dynamicBufferSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            dynamicBufferSize.descriptorCount = dynamicBufferCount * frameCount;
+            poolSizes.push_back(dynamicBufferSize);
+        }
 
-        VkDescriptorPoolSize textureSize{};
-        textureSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        textureSize.descriptorCount = textureCount * frameCount;
-        poolSizes.push_back(textureSize);
+        if (storageBufferCount > 0)
+        {
+            VkDescriptorPoolSize storageBufferSize{};
+            storageBufferSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            storageBufferSize.descriptorCount = storageBufferCount * frameCount;
+            poolSizes.push_back(storageBufferSize);
+        }
+
+        if (textureCount > 0)
+        {
+            VkDescriptorPoolSize textureSize{};
+            textureSize.type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            textureSize.descriptorCount = textureCount * frameCount;
+            poolSizes.push_back(textureSize);
+        }
 
         VkDescriptorPoolCreateInfo createInfo{};
         createInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -29,6 +29,11 @@ namespace LearnVulkan::Wrapper
         {
             std::vector<VkWriteDescriptorSet> descriptorSetWrites{};
 
+            // 动态统一缓冲区的范围是单份数据的大小而不是整个缓冲区，偏移在绑定时给出；
+            // 预留容量保证写入描述符前指针不会失效
+            std::vector<VkDescriptorBufferInfo> dynamicBufferInfos{};
+            dynamicBufferInfos.reserve(params.size());
+
             for (const auto& param : params)
             {
                 VkWriteDescriptorSet descriptorSetWrite{};
@@ -39,11 +44,23 @@ namespace LearnVulkan::Wrapper
                 descriptorSetWrite.descriptorCount = param->mCount;
                 descriptorSetWrite.dstBinding      = param->mBinding;
 
-                if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+                    param->mDescriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
                 {
                     descriptorSetWrite.pBufferInfo = &param->mBuffers[i]->getBufferInfo();
                 }
 
+                if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+                {
+                    VkDescriptorBufferInfo bufferInfo{};
+                    bufferInfo.buffer = param->mBuffers[i]->getBuffer();
+                    bufferInfo.offset = 0;
+                    bufferInfo.range  = param->mSize;
+
+                    dynamicBufferInfos.push_back(bufferInfo);
+                    descriptorSetWrite.pBufferInfo = &dynamicBufferInfos.back();
+                }
+
                 if (param->mDescriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
                 {
                     descriptorSetWrite.pImageInfo = &param->mTexture->getImageInfo();
@@ -60,5 +77,44 @@ namespace LearnVulkan::Wrapper
         }
     }
 
+    void DescriptorSet::updateImage(uint32_t binding, const VkDescriptorImageInfo& imageInfo)
+    {
+        std::vector<VkWriteDescriptorSet> descriptorSetWrites{};
+
+        for (const auto& descriptorSet : mDescriptorSets)
+        {
+            VkWriteDescriptorSet descriptorSetWrite{};
+            descriptorSetWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorSetWrite.dstSet          = descriptorSet;
+            descriptorSetWrite.dstBinding      = binding;
+            descriptorSetWrite.dstArrayElement = 0;
+            descriptorSetWrite.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorSetWrite.descriptorCount = 1;
+            descriptorSetWrite.pImageInfo      = &imageInfo;
+
+            descriptorSetWrites.push_back(descriptorSetWrite);
+        }
+
+        vkUpdateDescriptorSets(mDevice->getDevice(),
+                               static_cast<uint32_t>(descriptorSetWrites.size()),
+                               descriptorSetWrites.data(),
+                               0,
+                               nullptr);
+    }
+
+    void DescriptorSet::updateImage(uint32_t binding, const VkDescriptorImageInfo& imageInfo, uint32_t frame)
+    {
+        VkWriteDescriptorSet descriptorSetWrite{};
+        descriptorSetWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorSetWrite.dstSet          = mDescriptorSets[frame];
+        descriptorSetWrite.dstBinding      = binding;
+        descriptorSetWrite.dstArrayElement = 0;
+        descriptorSetWrite.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorSetWrite.descriptorCount = 1;
+        descriptorSetWrite.pImageInfo      = &imageInfo;
+
+        vkUpdateDescriptorSets(mDevice->getDevice(), 1, &descriptorSetWrite, 0, nullptr);
+    }
+
     DescriptorSet::~DescriptorSet() {}
 }
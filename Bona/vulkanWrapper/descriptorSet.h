@@ -35,6 +35,15 @@ namespace LearnVulkan::Wrapper
 
         [[nodiscard]] auto getDescriptorSet(int frameCount) const { return mDescriptorSets[frameCount]; }
 
+        [[nodiscard]] auto getCount() const { return static_cast<uint32_t>(mDescriptorSets.size()); }
+
+        /// 重写所有帧的描述符集中 binding 处的图像（如流送纹理换成新的图像）。
+        /// 描述符集不能正在被待执行的命令缓冲区使用，调用方先等待相关的帧完成
+        void updateImage(uint32_t binding, const VkDescriptorImageInfo& imageInfo);
+
+        /// 只重写第 frame 帧的描述符集，其余帧的描述符集可以仍在使用中
+        void updateImage(uint32_t binding, const VkDescriptorImageInfo& imageInfo, uint32_t frame);
+
     private:
         std::vector<VkDescriptorSet> mDescriptorSets{};
         Device::Ptr                  mDevice{ nullptr };
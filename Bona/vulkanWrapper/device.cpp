@@ -1,5 +1,8 @@
 ﻿#include "device.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace LearnVulkan::Wrapper
 {
 
@@ -10,10 +13,17 @@ namespace LearnVulkan::Wrapper
         pickPhysicalDevice();
         initQueueFamilies(mPhysicalDevice);
         createLogicalDevice();
+
+        mAllocator    = MemoryAllocator::create(mPhysicalDevice, mDevice);
+        mSamplerCache = SamplerCache::create(mPhysicalDevice, mDevice);
     }
 
     Device::~Device()
     {
+        // 采样器和内存块必须在逻辑设备销毁前释放
+        mSamplerCache.reset();
+        mAllocator.reset();
+
         vkDestroyDevice(mDevice, nullptr);
         mSurface.reset();
         mInstance.reset();
@@ -120,6 +130,22 @@ namespace LearnVulkan::Wrapper
 
             ++i;
         }
+
+        // 独立传输队列族：不支持图形，优先选同时也不支持计算的（专用 DMA 引擎）
+        for (uint32_t family = 0; family < queueFamilyCount; ++family)
+        {
+            const VkQueueFlags flags = queueFamilies[family].queueFlags;
+
+            if (queueFamilies[family].queueCount == 0 || !(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                continue;
+            }
+
+            if (!mTransferQueueFamily.has_value() || !(flags & VK_QUEUE_COMPUTE_BIT))
+            {
+                mTransferQueueFamily = family;
+            }
+        }
     }
 
     void Device::createLogicalDevice()
@@ -128,6 +154,11 @@ namespace LearnVulkan::Wrapper
 
         std::set<uint32_t> queueFamilies = { mGraphicQueueFamily.value(), mPresentQueueFamily.value() };
 
+        if (mTransferQueueFamily.has_value())
+        {
+            queueFamilies.insert(mTransferQueueFamily.value());
+        }
+
         float queuePriority = 1.0;
 
         for (uint32_t queueFamily : queueFamilies)
@@ -141,9 +172,15 @@ namespace LearnVulkan::Wrapper
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
-        // 3. 启用设备特性（各向异性过滤）
+        // 3. 启用设备特性（各向异性过滤；支持时启用 BC 块压缩纹理）
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(mPhysicalDevice, &supportedFeatures);
+
+        mTextureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+
         VkPhysicalDeviceFeatures deviceFeatures = {};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.samplerAnisotropy    = VK_TRUE;
+        deviceFeatures.textureCompressionBC = mTextureCompressionBC ? VK_TRUE : VK_FALSE;
 
         // 4. 填写逻辑设备创建信息
         VkDeviceCreateInfo deviceCreateInfo = {};
@@ -152,9 +189,10 @@ namespace LearnVulkan::Wrapper
         deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
 
-        // 5. 启用设备扩展
-        deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceRequiredExtensions.size());
-        deviceCreateInfo.ppEnabledExtensionNames = deviceRequiredExtensions.data();
+        // 5. 启用设备扩展（必需扩展 + 可用时的可选扩展）
+        const auto extensions = getEnabledExtensions();
+        deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        deviceCreateInfo.ppEnabledExtensionNames = extensions.data();
 
         // 6. 启用验证层（如果实例启用了）
         if (mInstance->getEnableValidationLayer())
@@ -176,6 +214,119 @@ namespace LearnVulkan::Wrapper
         // 8. 获取队列句柄
         vkGetDeviceQueue(mDevice, mGraphicQueueFamily.value(), 0, &mGraphicQueue);
         vkGetDeviceQueue(mDevice, mPresentQueueFamily.value(), 0, &mPresentQueue);
+
+        if (mTransferQueueFamily.has_value())
+        {
+            vkGetDeviceQueue(mDevice, mTransferQueueFamily.value(), 0, &mTransferQueue);
+        }
+
+        // 9. 可选的暂存路径：导入主机内存、可映射的显存
+        initHostPointerImport();
+    }
+
+    std::vector<const char*> Device::getEnabledExtensions()
+    {
+        std::vector<const char*> extensions = deviceRequiredExtensions;
+
+        uint32_t extensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> available(extensionCount);
+        vkEnumerateDeviceExtensionProperties(mPhysicalDevice, nullptr, &extensionCount, available.data());
+
+        auto isAvailable = [&](const char* name)
+        {
+            return std::any_of(available.begin(), available.end(), [&](const VkExtensionProperties& extension)
+            {
+                return strcmp(extension.extensionName, name) == 0;
+            });
+        };
+
+        // 导入主机内存：需要 external_memory（1.0 上的扩展形式，依赖实例扩展 external_memory_capabilities），对齐要求要通过 properties2 查询
+        mHostPointerImportAvailable = mInstance->supportsPhysicalDeviceProperties2() &&
+                                      mInstance->supportsExternalMemoryCapabilities() &&
+                                      isAvailable(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME) &&
+                                      isAvailable(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+
+        if (mHostPointerImportAvailable)
+        {
+            extensions.push_back(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME);
+            extensions.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+        }
+
+        return extensions;
+    }
+
+    void Device::initHostPointerImport()
+    {
+        // 超过 256MB 的 DEVICE_LOCAL | HOST_VISIBLE 堆说明整块显存可映射（没有 Resizable BAR 时只有 256MB 的窗口，留给其他用途）
+        constexpr VkDeviceSize BarWindowSize = 256ull * 1024 * 1024;
+
+        VkPhysicalDeviceMemoryProperties memoryProps{};
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memoryProps);
+
+        const VkMemoryPropertyFlags hostVisibleDeviceLocal = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        for (uint32_t i = 0; i < memoryProps.memoryTypeCount; ++i)
+        {
+            const auto& type = memoryProps.memoryTypes[i];
+
+            if ((type.propertyFlags & hostVisibleDeviceLocal) == hostVisibleDeviceLocal &&
+                memoryProps.memoryHeaps[type.heapIndex].size > BarWindowSize)
+            {
+                mHostVisibleDeviceLocal = true;
+            }
+        }
+
+        if (!mHostPointerImportAvailable)
+        {
+            return;
+        }
+
+        auto getProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+            vkGetInstanceProcAddr(mInstance->getInstance(), "vkGetPhysicalDeviceProperties2KHR"));
+
+        mGetMemoryHostPointerProperties = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+            vkGetDeviceProcAddr(mDevice, "vkGetMemoryHostPointerPropertiesEXT"));
+
+        if (getProperties2 == nullptr || mGetMemoryHostPointerProperties == nullptr)
+        {
+            return;
+        }
+
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProps{};
+        hostProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+
+        VkPhysicalDeviceProperties2KHR props{};
+        props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+        props.pNext = &hostProps;
+
+        getProperties2(mPhysicalDevice, &props);
+
+        mHostPointerAlignment = hostProps.minImportedHostPointerAlignment;
+    }
+
+    uint32_t Device::getHostPointerMemoryTypes(const void* hostPointer) const
+    {
+        if (!supportsHostPointerImport())
+        {
+            return 0;
+        }
+
+        VkMemoryHostPointerPropertiesEXT props{};
+        props.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+
+        if (mGetMemoryHostPointerProperties(mDevice,
+                                            VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+                                            hostPointer,
+                                            &props) != VK_SUCCESS)
+        {
+            return 0;
+        }
+
+        return props.memoryTypeBits;
     }
 
     bool Device::isQueueFamilyComplete()
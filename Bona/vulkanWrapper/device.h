@@ -3,6 +3,8 @@
 #include "base.h"
 #include "instance.h"
 #include "windowSurface.h"
+#include "memoryAllocator.h"
+#include "samplerCache.h"
 
 namespace LearnVulkan::Wrapper
 {
@@ -47,6 +49,36 @@ namespace LearnVulkan::Wrapper
         [[nodiscard]] auto getGraphicQueue()       const { return mGraphicQueue; }
         [[nodiscard]] auto getPresentQueue()       const { return mPresentQueue; }
 
+        /// 是否有独立的传输队列族（只支持传输、不支持图形的队列族，通常对应 GPU 的 DMA 引擎）
+        [[nodiscard]] bool hasDedicatedTransferQueue() const { return mTransferQueueFamily.has_value(); }
+
+        /// 没有独立传输队列时退回图形队列
+        [[nodiscard]] auto getTransferQueueFamily() const { return mTransferQueueFamily.has_value() ? mTransferQueueFamily : mGraphicQueueFamily; }
+        [[nodiscard]] auto getTransferQueue()       const { return mTransferQueueFamily.has_value() ? mTransferQueue : mGraphicQueue; }
+        [[nodiscard]] auto getAllocator()          const { return mAllocator; }
+        [[nodiscard]] auto getSamplerCache()       const { return mSamplerCache; }
+
+        /// 是否启用了 textureCompressionBC 特性（BC1 ~ BC7 格式可直接采样）
+        [[nodiscard]] bool supportsTextureCompressionBC() const { return mTextureCompressionBC; }
+
+        /// 是否启用了 VK_EXT_external_memory_host：按 getHostPointerAlignment 对齐的主机内存可直接导入为缓冲区内存
+        [[nodiscard]] bool supportsHostPointerImport() const { return mHostPointerAlignment != 0; }
+
+        /// 导入主机内存时指针和大小的对齐要求（minImportedHostPointerAlignment），不支持导入时为 0
+        [[nodiscard]] auto getHostPointerAlignment() const { return mHostPointerAlignment; }
+
+        /// 主机指针可导入的内存类型位，失败时为 0
+        uint32_t getHostPointerMemoryTypes(const void* hostPointer) const;
+
+        /// 是否有足够大的 DEVICE_LOCAL | HOST_VISIBLE 内存（Resizable BAR 或集成显卡），
+        /// CPU 直接写显存，暂存区可以放在这里，复制时不再经过 PCIe 读取系统内存
+        [[nodiscard]] bool hasHostVisibleDeviceLocalMemory() const { return mHostVisibleDeviceLocal; }
+
+    private:
+        std::vector<const char*> getEnabledExtensions();
+
+        void initHostPointerImport();
+
     private:
         VkPhysicalDevice   mPhysicalDevice{ VK_NULL_HANDLE };
         Instance::Ptr      mInstance{ nullptr };
@@ -58,8 +90,21 @@ namespace LearnVulkan::Wrapper
         std::optional<uint32_t> mPresentQueueFamily;
         VkQueue                 mPresentQueue{ VK_NULL_HANDLE };
 
+        std::optional<uint32_t> mTransferQueueFamily;
+        VkQueue                 mTransferQueue{ VK_NULL_HANDLE };
+
         VkDevice mDevice{ VK_NULL_HANDLE };
 
+        bool mTextureCompressionBC{ false };
+
+        bool                                    mHostPointerImportAvailable{ false };
+        VkDeviceSize                            mHostPointerAlignment{ 0 };
+        PFN_vkGetMemoryHostPointerPropertiesEXT mGetMemoryHostPointerProperties{ nullptr };
+        bool                                    mHostVisibleDeviceLocal{ false };
+
+        MemoryAllocator::Ptr mAllocator{ nullptr };   // 所有 Buffer / Image 的设备内存都从这里子分配
+        SamplerCache::Ptr    mSamplerCache{ nullptr };   // 纹理共用的采样器
+
         VkSampleCountFlagBits mMsaaSamples{ VK_SAMPLE_COUNT_1_BIT };
     };
 }
\ No newline at end of file
@@ -37,4 +37,9 @@ namespace LearnVulkan::Wrapper
                         VK_TRUE,   
                         timeout);  
     }
+
+    bool Fence::isSignaled() const
+    {
+        return vkGetFenceStatus(mDevice->getDevice(), mFence) == VK_SUCCESS;
+    }
 }
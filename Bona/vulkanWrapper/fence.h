@@ -22,6 +22,9 @@ namespace LearnVulkan::Wrapper
 
         void block(uint64_t timeout = UINT64_MAX);
 
+        /// 不阻塞地查询是否已触发
+        bool isSignaled() const;
+
         [[nodiscard]] auto getFence() const { return mFence; }
 
     private:
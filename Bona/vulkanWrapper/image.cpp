@@ -18,6 +18,9 @@ namespace LearnVulkan::Wrapper
                                                     VK_IMAGE_TILING_OPTIMAL,
                                                     VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 
+        // D32_SFLOAT 没有模板分量，视图只能包含深度
+        const bool hasStencil = resultFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || resultFormat == VK_FORMAT_D24_UNORM_S8_UINT;
+
         return Image::create(device,
                              width,
                              height,
@@ -27,7 +30,7 @@ namespace LearnVulkan::Wrapper
                              VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
                              VK_SAMPLE_COUNT_1_BIT,
                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                             VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+                             hasStencil ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT);
     }
 
     Image::Image(const Device::Ptr &device,
@@ -39,7 +42,9 @@ namespace LearnVulkan::Wrapper
                  const VkImageUsageFlags& usage,
                  const VkSampleCountFlagBits& sample,
                  const VkMemoryPropertyFlags& properties,
-                 const VkImageAspectFlags& aspectFlags)
+                 const VkImageAspectFlags& aspectFlags,
+                 uint32_t mipLevels,
+                 uint32_t arrayLayers)
     {
         // 初始化成员变量
         mDevice = device;
@@ -47,6 +52,8 @@ namespace LearnVulkan::Wrapper
         mWidth = width;    // 记录图像宽度
         mHeight = height;  // 记录图像高度
         mFormat = format;  // 记录图像格式
+        mMipLevels = std::max(1u, mipLevels);
+        mArrayLayers = std::max(1u, arrayLayers);
 
         // ---------------------------
         // 步骤 1：创建 Vulkan 图像（VkImage）
@@ -65,10 +72,10 @@ namespace LearnVulkan::Wrapper
         imageCreateInfo.usage         = usage;      // 图像用途（决定后续如何使用，如渲染目标、纹理采样）
         imageCreateInfo.samples       = sample;     // 多重采样等级（影响抗锯齿）
 
-        // 多级渐远纹理（Mipmap）层级数（此处固定为 1，不生成 Mipmap）
-        imageCreateInfo.mipLevels     = 1;
-        // 数组层数（适用于立方体贴图等数组图像，此处固定为 1）
-        imageCreateInfo.arrayLayers   = 1;
+        // 多级渐远纹理（Mipmap）层级数，纹理为完整 mip 链，附件为 1
+        imageCreateInfo.mipLevels     = mMipLevels;
+        // 数组层数（纹理数组为层数，其余为 1）
+        imageCreateInfo.arrayLayers   = mArrayLayers;
         // 初始布局（图像创建后首次使用前的布局，未定义表示初始状态无需转换）
         imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         // 共享模式（独占模式：仅一个队列族访问；共享模式：多个队列族共享）
@@ -86,22 +93,15 @@ namespace LearnVulkan::Wrapper
         VkMemoryRequirements memReq{};
         vkGetImageMemoryRequirements(mDevice->getDevice(), mImage, &memReq);
 
-        // 内存分配信息结构体
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memReq.size;
-
-        // 内存类型索引（需满足图像需求的内存属性和传入的 properties 参数）
-        // findMemoryType 函数通常根据 memReq.memoryTypeBits（支持的内存类型位掩码）和 properties（所需属性）查找匹配的索引
-        allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties);
+        // 从设备的分配器子分配（内存类型需满足图像需求和传入的 properties 参数）
+        // 最优排布图像与缓冲区分开放置以满足 bufferImageGranularity，大图像单独分配
+        const auto kind      = tiling == VK_IMAGE_TILING_OPTIMAL ? MemoryAllocator::ResourceKind::Optimal : MemoryAllocator::ResourceKind::Linear;
+        const bool dedicated = memReq.size >= MemoryAllocator::DedicatedImageSize;
 
-        if (vkAllocateMemory(mDevice->getDevice(), &allocInfo, nullptr, &mImageMemory) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Error: failed to allocate memory!");
-        }
+        mAllocation = mDevice->getAllocator()->allocate(memReq, properties, kind, dedicated);
 
         // 将分配的内存绑定到图像对象（图像必须绑定内存后才能使用）
-        vkBindImageMemory(mDevice->getDevice(), mImage, mImageMemory, 0);
+        vkBindImageMemory(mDevice->getDevice(), mImage, mAllocation.mMemory, mAllocation.mOffset);
 
         // ---------------------------
         // 步骤 3：创建图像视图（VkImageView）
@@ -110,17 +110,24 @@ namespace LearnVulkan::Wrapper
         VkImageViewCreateInfo imageViewCreateInfo{};
         imageViewCreateInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 
-        // 视图类型（根据图像类型选择：2D 图像用 VK_IMAGE_VIEW_TYPE_2D，3D 图像用 VK_IMAGE_VIEW_TYPE_3D）
-        imageViewCreateInfo.viewType                        = imageType == VK_IMAGE_TYPE_2D ? VK_IMAGE_VIEW_TYPE_2D : VK_IMAGE_VIEW_TYPE_3D;
+        // 视图类型（根据图像类型选择：2D 图像用 VK_IMAGE_VIEW_TYPE_2D，多层时为 VK_IMAGE_VIEW_TYPE_2D_ARRAY，3D 图像用 VK_IMAGE_VIEW_TYPE_3D）
+        if (imageType == VK_IMAGE_TYPE_2D)
+        {
+            imageViewCreateInfo.viewType                    = mArrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+        }
+        else
+        {
+            imageViewCreateInfo.viewType                    = VK_IMAGE_VIEW_TYPE_3D;
+        }
         imageViewCreateInfo.format                          = format;
         imageViewCreateInfo.image                           = mImage;
 
         // 子资源范围（指定图像的哪些部分可通过视图访问）
         imageViewCreateInfo.subresourceRange.aspectMask     = aspectFlags;
         imageViewCreateInfo.subresourceRange.baseMipLevel   = 0;
-        imageViewCreateInfo.subresourceRange.levelCount     = 1;
+        imageViewCreateInfo.subresourceRange.levelCount     = mMipLevels;
         imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-        imageViewCreateInfo.subresourceRange.layerCount     = 1;
+        imageViewCreateInfo.subresourceRange.layerCount     = mArrayLayers;
 
         if (vkCreateImageView(mDevice->getDevice(), &imageViewCreateInfo, nullptr, &mImageView) != VK_SUCCESS)
         {
@@ -135,31 +142,36 @@ namespace LearnVulkan::Wrapper
             vkDestroyImageView(mDevice->getDevice(), mImageView, nullptr);
         }
 
-        if (mImageMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(mDevice->getDevice(), mImageMemory, nullptr);
-        }
-
         if (mImage != VK_NULL_HANDLE)
         {
             vkDestroyImage(mDevice->getDevice(), mImage, nullptr);
         }
+
+        mDevice->getAllocator()->free(mAllocation);
     }
 
-    uint32_t Image::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+    uint32_t Image::getMipLevelCount(uint32_t width, uint32_t height)
     {
-        VkPhysicalDeviceMemoryProperties memProps;
-        vkGetPhysicalDeviceMemoryProperties(mDevice->getPhysicalDevice(), &memProps);
+        uint32_t levels = 1;
 
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
         {
-            if ((typeFilter & (1 << i)) && ((memProps.memoryTypes[i].propertyFlags & properties) == properties))
-            {
-                return i;
-            }
+            ++levels;
         }
 
-        throw std::runtime_error("Error: cannot find the property memory type!");
+        return levels;
+    }
+
+    bool Image::supportsLinearBlit(const Device::Ptr& device, VkFormat format)
+    {
+        VkFormatProperties formatProps{};
+        vkGetPhysicalDeviceFormatProperties(device->getPhysicalDevice(), format, &formatProps);
+
+        const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                              VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                              VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+        return (formatProps.optimalTilingFeatures & required) == required;
     }
 
     VkFormat Image::findDepthFormat(const Device::Ptr& device)
@@ -206,11 +218,7 @@ namespace LearnVulkan::Wrapper
                format == VK_FORMAT_D24_UNORM_S8_UINT;
     }
 
-    void Image::setImageLayout(VkImageLayout newLayout,
-                               VkPipelineStageFlags srcStageMask,
-                               VkPipelineStageFlags dstStageMask,
-                               VkImageSubresourceRange subresrouceRange,
-                               const CommandPool::Ptr& commandPool)
+    VkImageMemoryBarrier Image::transitionLayout(VkImageLayout newLayout, VkImageSubresourceRange subresrouceRange)
     {
         // 1. 初始化图像内存屏障（Image Memory Barrier）
         // 内存屏障用于告知Vulkan驱动：旧布局到新布局的转换需要同步哪些操作
@@ -275,6 +283,17 @@ namespace LearnVulkan::Wrapper
         // 4. 更新图像的当前布局状态（成员变量记录最新布局）
         mLayout = newLayout;
 
+        return imageMemoryBarrier;
+    }
+
+    void Image::setImageLayout(VkImageLayout newLayout,
+                               VkPipelineStageFlags srcStageMask,
+                               VkPipelineStageFlags dstStageMask,
+                               VkImageSubresourceRange subresrouceRange,
+                               const CommandPool::Ptr& commandPool)
+    {
+        auto imageMemoryBarrier = transitionLayout(newLayout, subresrouceRange);
+
         // 5. 创建并录制命令缓冲以提交布局转换
         // 使用指定命令池创建临时命令缓冲（用于本次一次性提交）
         auto commandBuffer = CommandBuffer::create(mDevice, commandPool);
@@ -293,6 +312,71 @@ namespace LearnVulkan::Wrapper
         commandBuffer->submitSync(mDevice->getGraphicQueue());
     }
 
+    void Image::generateMipmaps(const CommandBuffer::Ptr& commandBuffer, VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                           = mImage;
+        barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount     = mArrayLayers;
+        barrier.subresourceRange.levelCount     = 1;
+
+        int32_t width  = static_cast<int32_t>(mWidth);
+        int32_t height = static_cast<int32_t>(mHeight);
+
+        for (uint32_t level = 1; level < mMipLevels; ++level)
+        {
+            // 上一级写完后转为 blit 源
+            barrier.subresourceRange.baseMipLevel = level - 1;
+            barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask                 = VK_ACCESS_TRANSFER_READ_BIT;
+
+            commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            const int32_t nextWidth  = std::max(width / 2, 1);
+            const int32_t nextHeight = std::max(height / 2, 1);
+
+            VkImageBlit blit{};
+            blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, mArrayLayers };
+            blit.srcOffsets[0]  = { 0, 0, 0 };
+            blit.srcOffsets[1]  = { width, height, 1 };
+            blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, mArrayLayers };
+            blit.dstOffsets[0]  = { 0, 0, 0 };
+            blit.dstOffsets[1]  = { nextWidth, nextHeight, 1 };
+
+            commandBuffer->blitImage(mImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                     mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     blit, VK_FILTER_LINEAR);
+
+            // 上一级不再被读取，直接转到最终布局
+            barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.newLayout     = finalLayout;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask);
+
+            width  = nextWidth;
+            height = nextHeight;
+        }
+
+        // 最后一级只被写过
+        barrier.subresourceRange.baseMipLevel = mMipLevels - 1;
+        barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout                     = finalLayout;
+        barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+
+        commandBuffer->transferImageLayout(barrier, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStageMask);
+
+        mLayout = finalLayout;
+    }
+
     void Image::fillImageData(size_t size,
                               void* pData,
                               const CommandPool::Ptr& commandPool)
@@ -3,9 +3,18 @@
 #include "base.h"
 #include "device.h"
 #include "commandPool.h"
+#include "commandBuffer.h"
 
 namespace LearnVulkan::Wrapper
 {
+    // 一个 mip 级别的像素在上传数据中的位置；数组图像的各层在该级别内按层序紧密排列
+    struct MipLevel
+    {
+        VkDeviceSize mOffset{ 0 };
+        uint32_t     mWidth{ 0 };
+        uint32_t     mHeight{ 0 };
+    };
+
     class Image
     {
     public:
@@ -25,7 +34,9 @@ namespace LearnVulkan::Wrapper
                           const VkImageUsageFlags& usage,
                           const VkSampleCountFlagBits& sample,
                           const VkMemoryPropertyFlags& properties,
-                          const VkImageAspectFlags& aspectFlags)
+                          const VkImageAspectFlags& aspectFlags,
+                          uint32_t mipLevels = 1,
+                          uint32_t arrayLayers = 1)
         {
             return std::make_shared<Image>(device,
                                            width,
@@ -36,7 +47,9 @@ namespace LearnVulkan::Wrapper
                                            usage,
                                            sample,
                                            properties,
-                                           aspectFlags);
+                                           aspectFlags,
+                                           mipLevels,
+                                           arrayLayers);
         }
 
 		// VkFormat : 每一个像素的格式
@@ -50,7 +63,9 @@ namespace LearnVulkan::Wrapper
               const VkImageUsageFlags &usage,
               const VkSampleCountFlagBits &sample,
               const VkMemoryPropertyFlags &properties,
-              const VkImageAspectFlags &aspectFlags);
+              const VkImageAspectFlags &aspectFlags,
+              uint32_t mipLevels = 1,
+              uint32_t arrayLayers = 1);
 
         ~Image();
 
@@ -62,11 +77,27 @@ namespace LearnVulkan::Wrapper
 
         void fillImageData(size_t size, void* pData, const CommandPool::Ptr &commandPool);
 
+        /// 只生成布局转换屏障并记录新布局，不提交；由调用方录制到自己的命令缓冲区中（批量上传时使用）
+        VkImageMemoryBarrier transitionLayout(VkImageLayout newLayout, VkImageSubresourceRange subresrouceRange);
+
+        /// 在 commandBuffer 中用 vkCmdBlitImage 逐级降采样生成第 1 级及以后的 mip，结束时所有级别处于 finalLayout。
+        /// 前提：所有级别处于 TRANSFER_DST 且第 0 级已有数据，图像带 TRANSFER_SRC 用途，命令缓冲区属于图形队列
+        void generateMipmaps(const CommandBuffer::Ptr& commandBuffer, VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask);
+
+        /// 完整 mip 链的级别数：floor(log2(max(width, height))) + 1
+        static uint32_t getMipLevelCount(uint32_t width, uint32_t height);
+
+        /// 格式是否支持 generateMipmaps 需要的线性过滤 blit
+        static bool supportsLinearBlit(const Device::Ptr& device, VkFormat format);
+
         [[nodiscard]] auto getImage()     const { return mImage; }
         [[nodiscard]] auto getLayout()    const { return mLayout; }
         [[nodiscard]] auto getWidth()     const { return mWidth; }
         [[nodiscard]] auto getHeight()    const { return mHeight; }
         [[nodiscard]] auto getImageView() const { return mImageView; }
+        [[nodiscard]] auto getFormat()    const { return mFormat; }
+        [[nodiscard]] auto getMipLevels() const { return mMipLevels; }
+        [[nodiscard]] auto getArrayLayers() const { return mArrayLayers; }
 
     public:
         static VkFormat findDepthFormat(const Device::Ptr& device);
@@ -78,17 +109,16 @@ namespace LearnVulkan::Wrapper
 
         bool hasStencilComponent(VkFormat format) const;
 
-    private:
-        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-
     private:
         size_t         mWidth{ 0 };
         size_t         mHeight{ 0 };
         Device::Ptr    mDevice{ nullptr };
         VkImage        mImage{ VK_NULL_HANDLE };        //句柄
-        VkDeviceMemory mImageMemory{ VK_NULL_HANDLE };  //内存
+        MemoryAllocation mAllocation{};                 //内存（由设备的分配器子分配）
         VkImageView    mImageView{ VK_NULL_HANDLE };    //控制器
         VkFormat       mFormat{ VK_FORMAT_UNDEFINED };
         VkImageLayout  mLayout{ VK_IMAGE_LAYOUT_UNDEFINED };
+        uint32_t       mMipLevels{ 1 };
+        uint32_t       mArrayLayers{ 1 };
     };
 }
@@ -1,5 +1,8 @@
 ﻿#include "instance.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace LearnVulkan::Wrapper
 {
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallBack(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -122,6 +125,36 @@ namespace LearnVulkan::Wrapper
 
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
+        uint32_t extensionCount = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> available(extensionCount);
+        vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, available.data());
+
+        auto isAvailable = [&](const char* name)
+        {
+            return std::any_of(available.begin(), available.end(), [&](const VkExtensionProperties& extension)
+            {
+                return strcmp(extension.extensionName, name) == 0;
+            });
+        };
+
+        // 可选：查询设备的扩展属性（如导入主机内存的对齐要求）
+        mPhysicalDeviceProperties2 = isAvailable(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
+        if (mPhysicalDeviceProperties2)
+        {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+        }
+
+        // 可选：1.0 实例上设备扩展 VK_KHR_external_memory（导入主机内存）依赖这个实例扩展
+        mExternalMemoryCapabilities = isAvailable(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
+
+        if (mExternalMemoryCapabilities)
+        {
+            extensions.push_back(VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME);
+        }
+
         return extensions;
     }
 
@@ -30,9 +30,17 @@ namespace LearnVulkan::Wrapper
 
         [[nodiscard]] bool getEnableValidationLayer() const { return mEnableValidationLayer; }
 
+        /// 是否启用了 VK_KHR_get_physical_device_properties2（1.0 实例上查询扩展属性需要它）
+        [[nodiscard]] bool supportsPhysicalDeviceProperties2() const { return mPhysicalDeviceProperties2; }
+
+        /// 是否启用了 VK_KHR_external_memory_capabilities（1.0 实例上设备启用 VK_KHR_external_memory 需要它）
+        [[nodiscard]] bool supportsExternalMemoryCapabilities() const { return mExternalMemoryCapabilities; }
+
     private:
         VkInstance               mInstance{ VK_NULL_HANDLE };
         bool                     mEnableValidationLayer{ false };
         VkDebugUtilsMessengerEXT mDebugger{ VK_NULL_HANDLE };
+        bool                     mPhysicalDeviceProperties2{ false };
+        bool                     mExternalMemoryCapabilities{ false };
     };
 }
@@ -0,0 +1,641 @@
+﻿#include "memoryAllocator.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace LearnVulkan::Wrapper
+{
+    namespace
+    {
+        constexpr VkDeviceSize DefaultBlockSize = 64ull * 1024 * 1024;
+        constexpr VkDeviceSize MinGranularity   = 64;      // 块内所有偏移和大小都是它的倍数，对齐不超过它的请求无需额外处理
+        constexpr uint32_t     SecondLevelBits  = 4;       // 每个 2 的幂区间再细分 16 档
+        constexpr uint32_t     SecondLevelCount = 1u << SecondLevelBits;
+        constexpr uint32_t     FirstLevelCount  = 64;
+        constexpr uint32_t     InvalidNode      = ~0u;
+
+        uint32_t floorLog2(uint64_t value)
+        {
+            uint32_t result = 0;
+            for (uint32_t shift = 32; shift > 0; shift >>= 1)
+            {
+                if (value >> shift)
+                {
+                    value >>= shift;
+                    result += shift;
+                }
+            }
+            return result;
+        }
+
+        uint32_t lowestBit(uint64_t value)
+        {
+            return floorLog2(value & (~value + 1));
+        }
+
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        // TLSF 映射：一级为 floor(log2(size))，二级为其后 SecondLevelBits 位
+        void mapping(VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel)
+        {
+            firstLevel  = floorLog2(size);
+            secondLevel = static_cast<uint32_t>((size >> (firstLevel - SecondLevelBits)) ^ SecondLevelCount);
+        }
+    }
+
+    // 一个 VkDeviceMemory 内存块及其 TLSF 子分配状态。
+    // 物理相邻的区间组成双向链表，空闲区间按 (一级, 二级) 大小分档挂在各自的空闲链表上，两级位图用于 O(1) 查找
+    class MemoryBlock
+    {
+    public:
+        MemoryBlock(VkDeviceMemory memory, VkDeviceSize size, void* mappedData, uint32_t pool)
+            : mMemory(memory), mSize(size), mMappedData(mappedData), mPool(pool)
+        {
+            for (auto& heads : mFreeHeads)
+            {
+                heads.fill(InvalidNode);
+            }
+
+            const uint32_t node = createNode(0, size);
+            insertFree(node);
+        }
+
+        /// 成功时返回节点编号和对齐后的偏移
+        bool allocate(VkDeviceSize size, VkDeviceSize alignment, uint32_t& outNode, VkDeviceSize& outOffset)
+        {
+            size = alignUp(std::max(size, MinGranularity), MinGranularity);
+
+            // 对齐超过 MinGranularity 时最多需要在前面空出 alignment - MinGranularity
+            const VkDeviceSize padding = alignment > MinGranularity ? alignment - MinGranularity : 0;
+            const uint32_t node = findFree(size + padding);
+
+            if (node == InvalidNode)
+            {
+                return false;
+            }
+
+            removeFree(node);
+
+            // 前部空隙拆成独立的空闲区间
+            const VkDeviceSize alignedOffset = alignUp(mNodes[node].mOffset, std::max(alignment, MinGranularity));
+            const VkDeviceSize front         = alignedOffset - mNodes[node].mOffset;
+
+            uint32_t used = node;
+
+            if (front > 0)
+            {
+                used = split(node, front);
+                insertFree(node);
+            }
+
+            // 尾部剩余同样放回空闲链表
+            if (mNodes[used].mSize > size)
+            {
+                const uint32_t tail = split(used, size);
+                insertFree(tail);
+            }
+
+            mNodes[used].mFree = false;
+            mUsedBytes += mNodes[used].mSize;
+            ++mAllocationCount;
+
+            outNode   = used;
+            outOffset = mNodes[used].mOffset;
+
+            return true;
+        }
+
+        void free(uint32_t node)
+        {
+            mUsedBytes -= mNodes[node].mSize;
+            --mAllocationCount;
+
+            // 与物理相邻的空闲区间合并
+            const uint32_t next = mNodes[node].mNextPhysical;
+            if (next != InvalidNode && mNodes[next].mFree)
+            {
+                removeFree(next);
+                merge(node, next);
+            }
+
+            const uint32_t previous = mNodes[node].mPrevPhysical;
+            if (previous != InvalidNode && mNodes[previous].mFree)
+            {
+                removeFree(previous);
+                merge(previous, node);
+                node = previous;
+            }
+
+            insertFree(node);
+        }
+
+        /// 最大的空闲区间：从最高的非空档位中找
+        VkDeviceSize getLargestFree() const
+        {
+            if (mFirstLevelBitmap == 0)
+            {
+                return 0;
+            }
+
+            const uint32_t firstLevel  = floorLog2(mFirstLevelBitmap);
+            const uint32_t secondLevel = floorLog2(mSecondLevelBitmaps[firstLevel]);
+
+            VkDeviceSize largest = 0;
+            for (uint32_t node = mFreeHeads[firstLevel][secondLevel]; node != InvalidNode; node = mNodes[node].mNextFree)
+            {
+                largest = std::max(largest, mNodes[node].mSize);
+            }
+
+            return largest;
+        }
+
+        [[nodiscard]] auto getMemory()          const { return mMemory; }
+        [[nodiscard]] auto getSize()            const { return mSize; }
+        [[nodiscard]] auto getMappedData()      const { return mMappedData; }
+        [[nodiscard]] auto getPool()            const { return mPool; }
+        [[nodiscard]] auto getUsedBytes()       const { return mUsedBytes; }
+        [[nodiscard]] auto getAllocationCount() const { return mAllocationCount; }
+
+    private:
+        struct Node
+        {
+            VkDeviceSize mOffset{ 0 };
+            VkDeviceSize mSize{ 0 };
+            uint32_t     mPrevPhysical{ InvalidNode };
+            uint32_t     mNextPhysical{ InvalidNode };
+            uint32_t     mPrevFree{ InvalidNode };
+            uint32_t     mNextFree{ InvalidNode };
+            bool         mFree{ false };
+        };
+
+        uint32_t createNode(VkDeviceSize offset, VkDeviceSize size)
+        {
+            uint32_t node;
+
+            if (!mUnusedNodes.empty())
+            {
+                node = mUnusedNodes.back();
+                mUnusedNodes.pop_back();
+            }
+            else
+            {
+                node = static_cast<uint32_t>(mNodes.size());
+                mNodes.emplace_back();
+            }
+
+            mNodes[node]         = Node{};
+            mNodes[node].mOffset = offset;
+            mNodes[node].mSize   = size;
+
+            return node;
+        }
+
+        /// 把 node 切成 [0, size) 和剩余部分，返回剩余部分的新节点
+        uint32_t split(uint32_t node, VkDeviceSize size)
+        {
+            const uint32_t rest = createNode(mNodes[node].mOffset + size, mNodes[node].mSize - size);
+
+            mNodes[rest].mPrevPhysical = node;
+            mNodes[rest].mNextPhysical = mNodes[node].mNextPhysical;
+
+            if (mNodes[node].mNextPhysical != InvalidNode)
+            {
+                mNodes[mNodes[node].mNextPhysical].mPrevPhysical = rest;
+            }
+
+            mNodes[node].mNextPhysical = rest;
+            mNodes[node].mSize         = size;
+
+            return rest;
+        }
+
+        /// 把物理上紧随其后的 next 并入 node
+        void merge(uint32_t node, uint32_t next)
+        {
+            mNodes[node].mSize        += mNodes[next].mSize;
+            mNodes[node].mNextPhysical = mNodes[next].mNextPhysical;
+
+            if (mNodes[next].mNextPhysical != InvalidNode)
+            {
+                mNodes[mNodes[next].mNextPhysical].mPrevPhysical = node;
+            }
+
+            mUnusedNodes.push_back(next);
+        }
+
+        void insertFree(uint32_t node)
+        {
+            uint32_t firstLevel, secondLevel;
+            mapping(mNodes[node].mSize, firstLevel, secondLevel);
+
+            const uint32_t head = mFreeHeads[firstLevel][secondLevel];
+
+            mNodes[node].mFree     = true;
+            mNodes[node].mPrevFree = InvalidNode;
+            mNodes[node].mNextFree = head;
+
+            if (head != InvalidNode)
+            {
+                mNodes[head].mPrevFree = node;
+            }
+
+            mFreeHeads[firstLevel][secondLevel] = node;
+            mFirstLevelBitmap                  |= 1ull << firstLevel;
+            mSecondLevelBitmaps[firstLevel]    |= 1u << secondLevel;
+        }
+
+        void removeFree(uint32_t node)
+        {
+            uint32_t firstLevel, secondLevel;
+            mapping(mNodes[node].mSize, firstLevel, secondLevel);
+
+            const uint32_t previous = mNodes[node].mPrevFree;
+            const uint32_t next     = mNodes[node].mNextFree;
+
+            if (previous != InvalidNode)
+            {
+                mNodes[previous].mNextFree = next;
+            }
+            else
+            {
+                mFreeHeads[firstLevel][secondLevel] = next;
+
+                if (next == InvalidNode)
+                {
+                    mSecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+
+                    if (mSecondLevelBitmaps[firstLevel] == 0)
+                    {
+                        mFirstLevelBitmap &= ~(1ull << firstLevel);
+                    }
+                }
+            }
+
+            if (next != InvalidNode)
+            {
+                mNodes[next].mPrevFree = previous;
+            }
+
+            mNodes[node].mFree = false;
+        }
+
+        /// 找到一个不小于 size 的空闲区间：先把 size 向上取到所在档位的上界，该档及更高档中任意区间都满足
+        uint32_t findFree(VkDeviceSize size) const
+        {
+            const uint32_t log2 = floorLog2(size);
+            size += (VkDeviceSize(1) << (log2 - SecondLevelBits)) - 1;
+
+            uint32_t firstLevel, secondLevel;
+            mapping(size, firstLevel, secondLevel);
+
+            if (firstLevel >= FirstLevelCount)
+            {
+                return InvalidNode;
+            }
+
+            uint32_t secondMap = mSecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+
+            if (secondMap == 0)
+            {
+                const uint64_t firstMap = firstLevel + 1 < FirstLevelCount ? mFirstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+
+                if (firstMap == 0)
+                {
+                    return InvalidNode;
+                }
+
+                firstLevel = lowestBit(firstMap);
+                secondMap  = mSecondLevelBitmaps[firstLevel];
+            }
+
+            return mFreeHeads[firstLevel][lowestBit(secondMap)];
+        }
+
+    private:
+        VkDeviceMemory mMemory{ VK_NULL_HANDLE };
+        VkDeviceSize   mSize{ 0 };
+        void*          mMappedData{ nullptr };
+        uint32_t       mPool{ 0 };
+
+        std::vector<Node>     mNodes{};
+        std::vector<uint32_t> mUnusedNodes{};
+
+        uint64_t                                                     mFirstLevelBitmap{ 0 };
+        std::array<uint32_t, FirstLevelCount>                        mSecondLevelBitmaps{};
+        std::array<std::array<uint32_t, SecondLevelCount>, FirstLevelCount> mFreeHeads{};
+
+        VkDeviceSize mUsedBytes{ 0 };
+        uint32_t     mAllocationCount{ 0 };
+    };
+
+    MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device)
+    {
+        mPhysicalDevice = physicalDevice;
+        mDevice         = device;
+
+        vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &mMemoryProperties);
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mPhysicalDevice, &properties);
+
+        mBufferImageGranularity = std::max<VkDeviceSize>(1, properties.limits.bufferImageGranularity);
+        mNonCoherentAtomSize    = std::max<VkDeviceSize>(1, properties.limits.nonCoherentAtomSize);
+
+        mPools.resize(mMemoryProperties.memoryTypeCount * 2);
+        mDedicatedCounts.resize(mMemoryProperties.memoryTypeCount, 0);
+        mDedicatedBytes.resize(mMemoryProperties.memoryTypeCount, 0);
+    }
+
+    MemoryAllocator::~MemoryAllocator()
+    {
+        for (size_t pool = 0; pool < mPools.size(); ++pool)
+        {
+            for (auto& block : mPools[pool].mBlocks)
+            {
+                if (block->getAllocationCount() > 0)
+                {
+                    std::cout << "MemoryAllocator: " << block->getAllocationCount() << " allocations leaked in memory type " << pool / 2 << std::endl;
+                }
+
+                freeMemory(block->getMemory());
+            }
+        }
+    }
+
+    MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements,
+                                               VkMemoryPropertyFlags properties,
+                                               ResourceKind kind,
+                                               bool dedicated)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        MemoryAllocation allocation{};
+        allocation.mMemoryType = findMemoryType(requirements.memoryTypeBits, properties);
+        allocation.mSize       = requirements.size;
+
+        const VkDeviceSize blockSize = getBlockSize(allocation.mMemoryType);
+
+        // 步骤1：大资源单独分配，避免一个资源占掉大半个块
+        if (!dedicated && requirements.size <= blockSize / 2)
+        {
+            // 步骤2：粒度大于 1 时线性资源和最优排布图像分池，同一块内不会出现两种资源相邻
+            const bool     optimal = kind == ResourceKind::Optimal && mBufferImageGranularity > 1;
+            const uint32_t poolId  = allocation.mMemoryType * 2 + (optimal ? 1 : 0);
+            auto&          pool    = mPools[poolId];
+
+            auto fill = [&](MemoryBlock* block, uint32_t node, VkDeviceSize offset)
+            {
+                allocation.mMemory     = block->getMemory();
+                allocation.mOffset     = offset;
+                allocation.mBlock      = block;
+                allocation.mNode       = node;
+                allocation.mMappedData = block->getMappedData() ? static_cast<uint8_t*>(block->getMappedData()) + offset : nullptr;
+            };
+
+            uint32_t     node   = 0;
+            VkDeviceSize offset = 0;
+
+            for (auto& block : pool.mBlocks)
+            {
+                if (block->allocate(requirements.size, requirements.alignment, node, offset))
+                {
+                    fill(block.get(), node, offset);
+                    return allocation;
+                }
+            }
+
+            // 步骤3：现有块都放不下，申请新块；显存不足时退回单独分配
+            VkDeviceMemory memory     = VK_NULL_HANDLE;
+            void*          mappedData = nullptr;
+
+            if (allocateMemory(blockSize, allocation.mMemoryType, memory, mappedData))
+            {
+                pool.mBlocks.push_back(std::make_unique<MemoryBlock>(memory, blockSize, mappedData, poolId));
+
+                if (pool.mBlocks.back()->allocate(requirements.size, requirements.alignment, node, offset))
+                {
+                    fill(pool.mBlocks.back().get(), node, offset);
+                    return allocation;
+                }
+            }
+        }
+
+        // 步骤4：独立分配
+        if (!allocateMemory(requirements.size, allocation.mMemoryType, allocation.mMemory, allocation.mMappedData))
+        {
+            throw std::runtime_error("Error: failed to allocate memory!");
+        }
+
+        ++mDedicatedCounts[allocation.mMemoryType];
+        mDedicatedBytes[allocation.mMemoryType] += requirements.size;
+
+        return allocation;
+    }
+
+    void MemoryAllocator::free(MemoryAllocation& allocation)
+    {
+        if (allocation.mMemory == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (allocation.mBlock == nullptr)
+        {
+            freeMemory(allocation.mMemory);
+
+            --mDedicatedCounts[allocation.mMemoryType];
+            mDedicatedBytes[allocation.mMemoryType] -= allocation.mSize;
+        }
+        else
+        {
+            MemoryBlock* block = allocation.mBlock;
+            block->free(allocation.mNode);
+
+            // 空块归还给驱动，但每个池保留一个，避免反复创建销毁同一类资源时来回申请
+            auto& blocks = mPools[block->getPool()].mBlocks;
+
+            if (block->getAllocationCount() == 0 && blocks.size() > 1)
+            {
+                freeMemory(block->getMemory());
+
+                blocks.erase(std::find_if(blocks.begin(), blocks.end(),
+                                          [block](const std::unique_ptr<MemoryBlock>& item) { return item.get() == block; }));
+            }
+        }
+
+        allocation = MemoryAllocation{};
+    }
+
+    void MemoryAllocator::flush(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size)
+    {
+        if (mMemoryProperties.memoryTypes[allocation.mMemoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+        {
+            return;
+        }
+
+        // 刷新范围必须按 nonCoherentAtomSize 对齐；子分配偏移至少 64 字节对齐，扩展后可能碰到相邻分配，刷新它们无害
+        const VkDeviceSize begin = (allocation.mOffset + offset) / mNonCoherentAtomSize * mNonCoherentAtomSize;
+        const VkDeviceSize end   = alignUp(allocation.mOffset + offset + size, mNonCoherentAtomSize);
+
+        const VkDeviceSize memorySize = allocation.mBlock ? allocation.mBlock->getSize() : allocation.mSize;
+
+        VkMappedMemoryRange range{};
+        range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = allocation.mMemory;
+        range.offset = begin;
+        range.size   = end > memorySize ? VK_WHOLE_SIZE : end - begin;
+
+        vkFlushMappedMemoryRanges(mDevice, 1, &range);
+    }
+
+    uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; ++i)
+        {
+            if ((typeFilter & (1 << i)) && ((mMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties))
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("Error: cannot find the property memory type!");
+    }
+
+    MemoryStats MemoryAllocator::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        MemoryStats  total{};
+        VkDeviceSize largestFreeSum = 0;
+
+        for (uint32_t type = 0; type < mMemoryProperties.memoryTypeCount; ++type)
+        {
+            VkDeviceSize typeLargestFreeSum = 0;
+            const MemoryStats stats = collectStats(type, typeLargestFreeSum);
+
+            total.mBlockCount       += stats.mBlockCount;
+            total.mDedicatedCount   += stats.mDedicatedCount;
+            total.mAllocationCount  += stats.mAllocationCount;
+            total.mBlockBytes       += stats.mBlockBytes;
+            total.mUsedBytes        += stats.mUsedBytes;
+            total.mDedicatedBytes   += stats.mDedicatedBytes;
+            total.mFreeBytes        += stats.mFreeBytes;
+            total.mLargestFreeRange  = std::max(total.mLargestFreeRange, stats.mLargestFreeRange);
+            largestFreeSum          += typeLargestFreeSum;
+        }
+
+        total.mFragmentation = total.mFreeBytes > 0 ? 1.0f - float(largestFreeSum) / float(total.mFreeBytes) : 0.0f;
+
+        return total;
+    }
+
+    MemoryStats MemoryAllocator::getStats(uint32_t memoryType) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        VkDeviceSize largestFreeSum = 0;
+        return collectStats(memoryType, largestFreeSum);
+    }
+
+    void MemoryAllocator::printStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        char line[256];
+
+        for (uint32_t type = 0; type < mMemoryProperties.memoryTypeCount; ++type)
+        {
+            VkDeviceSize largestFreeSum = 0;
+            const MemoryStats stats = collectStats(type, largestFreeSum);
+
+            if (stats.mBlockCount == 0 && stats.mDedicatedCount == 0)
+            {
+                continue;
+            }
+
+            std::snprintf(line, sizeof(line),
+                          "MemoryAllocator: type %u (flags 0x%x) blocks %u (%.1f MB, used %.1f MB, %u allocations, fragmentation %.2f), dedicated %u (%.1f MB)",
+                          type, mMemoryProperties.memoryTypes[type].propertyFlags,
+                          stats.mBlockCount, stats.mBlockBytes / 1048576.0, stats.mUsedBytes / 1048576.0, stats.mAllocationCount,
+                          stats.mFragmentation, stats.mDedicatedCount, stats.mDedicatedBytes / 1048576.0);
+
+            std::cout << line << std::endl;
+        }
+    }
+
+    MemoryStats MemoryAllocator::collectStats(uint32_t memoryType, VkDeviceSize& largestFreeSum) const
+    {
+        MemoryStats stats{};
+        largestFreeSum = 0;
+
+        for (uint32_t pool = memoryType * 2; pool < memoryType * 2 + 2; ++pool)
+        {
+            for (const auto& block : mPools[pool].mBlocks)
+            {
+                ++stats.mBlockCount;
+                stats.mAllocationCount  += block->getAllocationCount();
+                stats.mBlockBytes       += block->getSize();
+                stats.mUsedBytes        += block->getUsedBytes();
+                stats.mFreeBytes        += block->getSize() - block->getUsedBytes();
+
+                const VkDeviceSize largestFree = block->getLargestFree();
+                stats.mLargestFreeRange  = std::max(stats.mLargestFreeRange, largestFree);
+                largestFreeSum          += largestFree;
+            }
+        }
+
+        stats.mDedicatedCount = mDedicatedCounts[memoryType];
+        stats.mDedicatedBytes = mDedicatedBytes[memoryType];
+        stats.mFragmentation  = stats.mFreeBytes > 0 ? 1.0f - float(largestFreeSum) / float(stats.mFreeBytes) : 0.0f;
+
+        return stats;
+    }
+
+    VkDeviceSize MemoryAllocator::getBlockSize(uint32_t memoryType) const
+    {
+        // 小堆（如 256MB 的 BAR 区域）按 1/8 取块大小，避免一个块占掉大部分堆
+        const VkDeviceSize heapSize = mMemoryProperties.memoryHeaps[mMemoryProperties.memoryTypes[memoryType].heapIndex].size;
+
+        return std::min(DefaultBlockSize, alignUp(std::max<VkDeviceSize>(heapSize / 8, MinGranularity), MinGranularity));
+    }
+
+    bool MemoryAllocator::allocateMemory(VkDeviceSize size, uint32_t memoryType, VkDeviceMemory& memory, void*& mappedData)
+    {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize  = size;
+        allocInfo.memoryTypeIndex = memoryType;
+
+        if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+        {
+            memory = VK_NULL_HANDLE;
+            return false;
+        }
+
+        // 主机可见内存整块常驻映射，同一块上的多个子分配不能各自 vkMapMemory
+        mappedData = nullptr;
+
+        if (mMemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            if (vkMapMemory(mDevice, memory, 0, VK_WHOLE_SIZE, 0, &mappedData) != VK_SUCCESS)
+            {
+                vkFreeMemory(mDevice, memory, nullptr);
+                memory = VK_NULL_HANDLE;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void MemoryAllocator::freeMemory(VkDeviceMemory memory)
+    {
+        // vkFreeMemory 会隐式解除映射
+        vkFreeMemory(mDevice, memory, nullptr);
+    }
+}
@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include "base.h"
+
+#include <mutex>
+
+namespace LearnVulkan::Wrapper
+{
+    class MemoryBlock;
+
+    // 一次子分配：mMemory 的 [mOffset, mOffset + mSize) 归调用方所有
+    struct MemoryAllocation
+    {
+        VkDeviceMemory mMemory{ VK_NULL_HANDLE };
+        VkDeviceSize   mOffset{ 0 };
+        VkDeviceSize   mSize{ 0 };
+        void*          mMappedData{ nullptr };     // 主机可见内存在整个内存块上常驻映射，这里已加上 mOffset
+        uint32_t       mMemoryType{ 0 };
+        MemoryBlock*   mBlock{ nullptr };          // 为空表示独立分配（dedicated）
+        uint32_t       mNode{ 0 };
+    };
+
+    // 分配器统计
+    struct MemoryStats
+    {
+        uint32_t     mBlockCount{ 0 };
+        uint32_t     mDedicatedCount{ 0 };
+        uint32_t     mAllocationCount{ 0 };        // 子分配数量（不含独立分配）
+        VkDeviceSize mBlockBytes{ 0 };             // 所有内存块的总大小
+        VkDeviceSize mUsedBytes{ 0 };              // 子分配占用的字节数（含对齐到 64 字节的部分）
+        VkDeviceSize mFreeBytes{ 0 };              // 内存块中未使用的字节数
+        VkDeviceSize mDedicatedBytes{ 0 };
+        VkDeviceSize mLargestFreeRange{ 0 };
+        float        mFragmentation{ 0.0f };       // 1 - 各块最大空闲区间之和 / 空闲总量，0 表示每个块的空闲空间都是连续的
+    };
+
+    // 设备内存分配器：每种内存类型按需申请大块 VkDeviceMemory（默认 64MB，小堆取堆大小的 1/8），
+    // 块内用 TLSF（两级分离适配）做子分配，分配和释放都是 O(1)。
+    //   - 对齐：子分配偏移按资源要求的对齐放置，前部空隙拆回空闲链表
+    //   - bufferImageGranularity：大于 1 时线性资源（缓冲区、线性图像）和最优排布图像使用不同的内存块，永远不会相邻
+    //   - 超过块大小一半的资源，或调用方要求时（大图像），单独 vkAllocateMemory
+    // 由 Device 持有，Buffer / Image 通过 Device::getAllocator 使用；线程安全
+    class MemoryAllocator
+    {
+    public:
+        using Ptr = std::shared_ptr<MemoryAllocator>;
+
+        enum class ResourceKind
+        {
+            Linear,    // 缓冲区、VK_IMAGE_TILING_LINEAR 图像
+            Optimal,   // VK_IMAGE_TILING_OPTIMAL 图像
+        };
+
+        // 不小于该大小的图像建议单独分配（调用方通过 allocate 的 dedicated 参数决定）
+        static constexpr VkDeviceSize DedicatedImageSize = 16ull * 1024 * 1024;
+
+        static Ptr create(VkPhysicalDevice physicalDevice, VkDevice device)
+        {
+            return std::make_shared<MemoryAllocator>(physicalDevice, device);
+        }
+
+        MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device);
+
+        ~MemoryAllocator();
+
+        MemoryAllocation allocate(const VkMemoryRequirements& requirements,
+                                  VkMemoryPropertyFlags properties,
+                                  ResourceKind kind,
+                                  bool dedicated = false);
+
+        void free(MemoryAllocation& allocation);
+
+        /// 非 HOST_COHERENT 内存写入后需要刷新，范围按 nonCoherentAtomSize 扩展；一致性内存直接返回
+        void flush(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size);
+
+        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+        [[nodiscard]] MemoryStats getStats() const;
+
+        [[nodiscard]] MemoryStats getStats(uint32_t memoryType) const;
+
+        void printStats() const;
+
+    private:
+        struct Pool
+        {
+            std::vector<std::unique_ptr<MemoryBlock>> mBlocks{};
+        };
+
+        MemoryStats collectStats(uint32_t memoryType, VkDeviceSize& largestFreeSum) const;
+
+        VkDeviceSize getBlockSize(uint32_t memoryType) const;
+
+        bool allocateMemory(VkDeviceSize size, uint32_t memoryType, VkDeviceMemory& memory, void*& mappedData);
+
+        void freeMemory(VkDeviceMemory memory);
+
+    private:
+        VkPhysicalDevice                 mPhysicalDevice{ VK_NULL_HANDLE };
+        VkDevice                         mDevice{ VK_NULL_HANDLE };
+        VkPhysicalDeviceMemoryProperties mMemoryProperties{};
+        VkDeviceSize                     mBufferImageGranularity{ 1 };
+        VkDeviceSize                     mNonCoherentAtomSize{ 1 };
+
+        std::vector<Pool>         mPools{};                  // 下标 = 内存类型 * 2 + (是否为最优排布图像池)
+        std::vector<uint32_t>     mDedicatedCounts{};        // 每种内存类型的独立分配数量
+        std::vector<VkDeviceSize> mDedicatedBytes{};
+
+        mutable std::mutex mMutex{};
+    };
+}
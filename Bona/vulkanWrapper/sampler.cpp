@@ -2,7 +2,7 @@
 
 namespace LearnVulkan::Wrapper
 {
-    Sampler::Sampler(const Device::Ptr& device)
+    Sampler::Sampler(const Device::Ptr& device, float maxLod)
     {
         mDevice = device;
 
@@ -29,7 +29,7 @@ namespace LearnVulkan::Wrapper
         createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         createInfo.mipLodBias = 0.0f;
         createInfo.minLod     = 0.0f;
-        createInfo.maxLod     = 0.0f;
+        createInfo.maxLod     = maxLod;
 
         if (vkCreateSampler(mDevice->getDevice(), &createInfo, nullptr, &mSampler) != VK_SUCCESS)
         {
@@ -9,9 +9,10 @@ namespace LearnVulkan::Wrapper
     {
     public:
         using Ptr = std::shared_ptr<Sampler>;
-        static Ptr create(const Device::Ptr& device) { return std::make_shared<Sampler>(device); }
+        /// maxLod 取纹理的 mip 级别数，采样时可以用到整条 mip 链
+        static Ptr create(const Device::Ptr& device, float maxLod = 0.0f) { return std::make_shared<Sampler>(device, maxLod); }
 
-        Sampler(const Device::Ptr& device);
+        Sampler(const Device::Ptr& device, float maxLod = 0.0f);
 
         ~Sampler();
 
@@ -0,0 +1,152 @@
+﻿#include "samplerCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace LearnVulkan::Wrapper
+{
+    SamplerCache::SamplerCache(VkPhysicalDevice physicalDevice, VkDevice device)
+    {
+        mDevice = device;
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        mMaxAnisotropy   = properties.limits.maxSamplerAnisotropy;
+        mMaxSamplerCount = properties.limits.maxSamplerAllocationCount;
+    }
+
+    SamplerCache::~SamplerCache()
+    {
+        for (auto& [hash, entry] : mSamplers)
+        {
+            vkDestroySampler(mDevice, entry.mSampler, nullptr);
+        }
+    }
+
+    VkSamplerCreateInfo SamplerCache::makeCreateInfo(const SamplerVariant& variant)
+    {
+        const bool nearest = variant.mFilter == VK_FILTER_NEAREST;
+
+        VkSamplerCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+
+        createInfo.magFilter = variant.mFilter;
+        createInfo.minFilter = variant.mFilter;
+
+        createInfo.addressModeU = variant.mAddressMode;
+        createInfo.addressModeV = variant.mAddressMode;
+        createInfo.addressModeW = variant.mAddressMode;
+
+        createInfo.anisotropyEnable = (!nearest && variant.mMaxAnisotropy > 1.0f) ? VK_TRUE : VK_FALSE;
+        createInfo.maxAnisotropy    = createInfo.anisotropyEnable ? variant.mMaxAnisotropy : 1.0f;
+
+        createInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+        createInfo.unnormalizedCoordinates = VK_FALSE;
+
+        createInfo.compareEnable = VK_FALSE;
+        createInfo.compareOp     = VK_COMPARE_OP_ALWAYS;
+
+        createInfo.mipmapMode = nearest ? VK_SAMPLER_MIPMAP_MODE_NEAREST : VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        createInfo.mipLodBias = variant.mLodBias;
+        createInfo.minLod     = 0.0f;
+        createInfo.maxLod     = VK_LOD_CLAMP_NONE;
+
+        return createInfo;
+    }
+
+    VkSampler SamplerCache::get(const SamplerVariant& variant)
+    {
+        return get(makeCreateInfo(variant));
+    }
+
+    VkSampler SamplerCache::get(const VkSamplerCreateInfo& createInfo)
+    {
+        if (createInfo.pNext != nullptr)
+        {
+            throw std::runtime_error("Error: sampler cache does not support create info with a pNext chain!");
+        }
+
+        // 不影响结果的差异先归一化，避免产生重复的采样器
+        VkSamplerCreateInfo key = createInfo;
+
+        if (key.anisotropyEnable)
+        {
+            key.maxAnisotropy = std::min(key.maxAnisotropy, mMaxAnisotropy);
+        }
+        else
+        {
+            key.maxAnisotropy = 1.0f;
+        }
+
+        const size_t hash = hashKey(key);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        ++mRequestCount;
+
+        auto range = mSamplers.equal_range(hash);
+
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (equalKey(it->second.mCreateInfo, key))
+            {
+                return it->second.mSampler;
+            }
+        }
+
+        Entry entry{};
+        entry.mCreateInfo = key;
+
+        if (vkCreateSampler(mDevice, &key, nullptr, &entry.mSampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to create sampler!");
+        }
+
+        mSamplers.emplace(hash, entry);
+
+        if (!mLimitWarned && mMaxSamplerCount > 0 && mSamplers.size() * 4 >= static_cast<size_t>(mMaxSamplerCount) * 3)
+        {
+            mLimitWarned = true;
+            std::cout << "Warning: " << mSamplers.size() << " unique samplers, approaching maxSamplerAllocationCount ("
+                      << mMaxSamplerCount << ")" << std::endl;
+        }
+
+        return entry.mSampler;
+    }
+
+    uint32_t SamplerCache::getSamplerCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return static_cast<uint32_t>(mSamplers.size());
+    }
+
+    uint32_t SamplerCache::getRequestCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mRequestCount;
+    }
+
+    size_t SamplerCache::hashKey(const VkSamplerCreateInfo& createInfo)
+    {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&createInfo) + KeyOffset;
+
+        size_t seed = 0;
+
+        for (size_t i = 0; i < KeySize; i += sizeof(uint32_t))
+        {
+            uint32_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            seed ^= std::hash<uint32_t>()(word) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+
+        return seed;
+    }
+
+    bool SamplerCache::equalKey(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b)
+    {
+        return std::memcmp(reinterpret_cast<const uint8_t*>(&a) + KeyOffset,
+                           reinterpret_cast<const uint8_t*>(&b) + KeyOffset, KeySize) == 0;
+    }
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "base.h"
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace LearnVulkan::Wrapper
+{
+    // 常用的采样状态组合，由 SamplerCache 转换为 VkSamplerCreateInfo 后查找
+    struct SamplerVariant
+    {
+        VkFilter             mFilter{ VK_FILTER_LINEAR };                     // NEAREST 时 mip 之间也取最近一级，并关闭各向异性
+        VkSamplerAddressMode mAddressMode{ VK_SAMPLER_ADDRESS_MODE_REPEAT };  // U / V / W 相同
+        float                mLodBias{ 0.0f };
+        float                mMaxAnisotropy{ 16.0f };                         // 不大于 1 时关闭各向异性
+    };
+
+    // 采样器缓存：按 VkSamplerCreateInfo 的内容去重，状态相同的纹理共用同一个 VkSampler。
+    // 采样器数量受 maxSamplerAllocationCount 限制（部分驱动只有 4000），而大多数纹理的采样状态完全相同。
+    //   - 默认变体为线性 / 重复 / 16 倍各向异性，maxLod 取 VK_LOD_CLAMP_NONE：实际可用的 mip 级别由图像视图决定，
+    //     因此级别数不同的纹理（包括流送中替换的图像）也共用同一个采样器
+    //   - maxAnisotropy 按设备的 maxSamplerAnisotropy 截断后再查找，截断后相同的请求共用一个采样器
+    // 由 Device 持有，通过 Device::getSamplerCache 使用；采样器在缓存销毁时统一销毁；线程安全
+    class SamplerCache
+    {
+    public:
+        using Ptr = std::shared_ptr<SamplerCache>;
+
+        static Ptr create(VkPhysicalDevice physicalDevice, VkDevice device)
+        {
+            return std::make_shared<SamplerCache>(physicalDevice, device);
+        }
+
+        SamplerCache(VkPhysicalDevice physicalDevice, VkDevice device);
+
+        ~SamplerCache();
+
+        /// 取得与 createInfo 状态相同的采样器，没有时创建；不支持带 pNext 链的创建信息
+        VkSampler get(const VkSamplerCreateInfo& createInfo);
+
+        VkSampler get(const SamplerVariant& variant = SamplerVariant{});
+
+        static VkSamplerCreateInfo makeCreateInfo(const SamplerVariant& variant);
+
+        /// 已创建的不同采样器数量
+        [[nodiscard]] uint32_t getSamplerCount() const;
+
+        /// get 的调用次数，与 getSamplerCount 对比即为去重的效果
+        [[nodiscard]] uint32_t getRequestCount() const;
+
+        [[nodiscard]] auto getMaxSamplerCount() const { return mMaxSamplerCount; }
+
+    private:
+        // 缓存键：VkSamplerCreateInfo 中 flags 之后的全部字段，都是 4 字节，没有填充
+        static constexpr size_t KeyOffset = offsetof(VkSamplerCreateInfo, flags);
+        static constexpr size_t KeySize   = sizeof(VkSamplerCreateInfo) - KeyOffset;
+
+        static size_t hashKey(const VkSamplerCreateInfo& createInfo);
+
+        static bool equalKey(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b);
+
+        struct Entry
+        {
+            VkSamplerCreateInfo mCreateInfo{};
+            VkSampler           mSampler{ VK_NULL_HANDLE };
+        };
+
+    private:
+        VkDevice mDevice{ VK_NULL_HANDLE };
+        float    mMaxAnisotropy{ 1.0f };
+        uint32_t mMaxSamplerCount{ 0 };
+
+        std::unordered_multimap<size_t, Entry> mSamplers{};   // 哈希值 -> 采样器，哈希相同时逐字段比较
+        uint32_t                               mRequestCount{ 0 };
+        bool                                   mLimitWarned{ false };
+
+        mutable std::mutex mMutex{};
+    };
+}
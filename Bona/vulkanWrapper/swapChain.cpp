@@ -107,31 +107,13 @@ namespace LearnVulkan::Wrapper
         }
 
         // 步骤12：创建深度图像（用于深度测试）
-        // 每个交换链图像需要对应的深度图像（同步创建，保证与交换链图像一一对应）
-        //mDepthImages.resize(mImageCount);
-
-        // 定义深度图像的子资源范围（仅深度通道，单层）
-        //VkImageSubresourceRange region{};
-        //region.aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT;  // 仅深度通道
-        //region.baseMipLevel   = 0;                          // 基础 Mipmap 层级（无 Mipmap 时为 0）
-        //region.levelCount     = 1;                          // Mipmap 层级数（单层）
-        //region.baseArrayLayer = 0;                          // 基础数组层（单层图像为 0）
-        //region.layerCount     = 1;                          // 数组层数（单层）
-
-        // 循环创建每个深度图像并设置布局
-        //for (int i = 0; i < mImageCount; ++i)
-        //{
-        //    // 创建深度图像对象（格式通常为 VK_FORMAT_D32_SFLOAT 或 VK_FORMAT_D24_UNORM_S8_UINT）
-        //    mDepthImages[i] = Image::createDepthImage(mDevice, mSwapChainExtent.width, mSwapChainExtent.height);
-
-        //    // 设置深度图像的初始布局（从 "未定义" 转换为 "深度模板附件最优"）
-        //    // 使图像准备好用于深度测试阶段
-        //    mDepthImages[i]->setImageLayout(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        //                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-        //                                    VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-        //                                    region,
-        //                                    commandPool);
-        //}
+        // 每个交换链图像对应一张深度图像；渲染通道以 UNDEFINED 为初始布局并清除，不需要预先转换布局
+        mDepthImages.resize(mImageCount);
+
+        for (int i = 0; i < mImageCount; ++i)
+        {
+            mDepthImages[i] = Image::createDepthImage(mDevice, mSwapChainExtent.width, mSwapChainExtent.height);
+        }
     }
 
     void SwapChain::createFrameBuffers(const RenderPass::Ptr& renderPass)
@@ -142,7 +124,7 @@ namespace LearnVulkan::Wrapper
         {
             //FrameBuffer 里面为一帧的数据，比如有n个ColorAttachment 1个DepthStencilAttachment，
             //这些东西的集合为一个FrameBuffer，送入管线，就会形成一个GPU的集合，由上方的Attachments构成
-            std::array<VkImageView, 1> attachments = { mSwapChainImageViews[i] };
+            std::array<VkImageView, 2> attachments = { mSwapChainImageViews[i], mDepthImages[i]->getImageView() };
 
             VkFramebufferCreateInfo frameBufferCreateInfo{};
             frameBufferCreateInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
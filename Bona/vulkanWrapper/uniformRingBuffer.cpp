@@ -0,0 +1,47 @@
+﻿#include "uniformRingBuffer.h"
+
+namespace LearnVulkan::Wrapper
+{
+    UniformRingBuffer::UniformRingBuffer(const Device::Ptr& device, VkDeviceSize frameCapacity, int frameCount)
+    {
+        mDevice     = device;
+        mFrameCount = frameCount;
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mDevice->getPhysicalDevice(), &properties);
+
+        mAlignment = std::max<VkDeviceSize>(1, properties.limits.minUniformBufferOffsetAlignment);
+
+        // 每帧段的起点同样需要满足对齐
+        mFrameCapacity = (frameCapacity + mAlignment - 1) / mAlignment * mAlignment;
+
+        mBuffer = Buffer::createUniformBuffer(mDevice, mFrameCapacity * frameCount, nullptr);
+    }
+
+    void UniformRingBuffer::beginFrame(int frame)
+    {
+        if (frame < 0 || frame >= mFrameCount)
+        {
+            throw std::runtime_error("Error: uniform ring buffer frame index out of range!");
+        }
+
+        mFrameBegin = mFrameCapacity * frame;
+        mCursor     = mFrameBegin;
+    }
+
+    uint32_t UniformRingBuffer::push(const void* data, size_t size)
+    {
+        if (mCursor + size > mFrameBegin + mFrameCapacity)
+        {
+            throw std::runtime_error("Error: uniform ring buffer frame capacity exceeded!");
+        }
+
+        const VkDeviceSize offset = mCursor;
+
+        mBuffer->updateBufferByMap(data, size, offset);
+
+        mCursor = (mCursor + size + mAlignment - 1) / mAlignment * mAlignment;
+
+        return static_cast<uint32_t>(offset);
+    }
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "base.h"
+#include "buffer.h"
+#include "device.h"
+
+namespace LearnVulkan::Wrapper
+{
+    // 每帧统一变量环形缓冲区：一个常驻映射的主机可见缓冲区，按帧划分成 frameCount 段，
+    // 每段内按 minUniformBufferOffsetAlignment 线性子分配。
+    // 配合 VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC 使用，push 返回的偏移作为绑定描述符集时的动态偏移，
+    // 更新一份常量只需一次 memcpy，不需要 vkMapMemory，也不需要为每帧 / 每个物体准备单独的描述符集
+    class UniformRingBuffer
+    {
+    public:
+        using Ptr = std::shared_ptr<UniformRingBuffer>;
+
+        static Ptr create(const Device::Ptr& device, VkDeviceSize frameCapacity, int frameCount)
+        {
+            return std::make_shared<UniformRingBuffer>(device, frameCapacity, frameCount);
+        }
+
+        UniformRingBuffer(const Device::Ptr& device, VkDeviceSize frameCapacity, int frameCount);
+
+        ~UniformRingBuffer() = default;
+
+        /// 开始写第 frame 帧的数据段，该段之前的内容作废（调用方保证 GPU 已不再读取这一帧）
+        void beginFrame(int frame);
+
+        /// 把数据写入当前帧段并返回其在整个缓冲区中的偏移（即动态偏移）；超出每帧容量时抛出异常
+        uint32_t push(const void* data, size_t size);
+
+        template<typename T>
+        uint32_t push(const T& value)
+        {
+            return push(&value, sizeof(T));
+        }
+
+        [[nodiscard]] auto getBuffer()        const { return mBuffer; }
+        [[nodiscard]] auto getAlignment()     const { return mAlignment; }
+        [[nodiscard]] auto getFrameCapacity() const { return mFrameCapacity; }
+
+    private:
+        Device::Ptr  mDevice{ nullptr };
+        Buffer::Ptr  mBuffer{ nullptr };
+        VkDeviceSize mAlignment{ 1 };
+        VkDeviceSize mFrameCapacity{ 0 };
+        int          mFrameCount{ 0 };
+        VkDeviceSize mFrameBegin{ 0 };
+        VkDeviceSize mCursor{ 0 };
+    };
+}
@@ -0,0 +1,729 @@
+﻿#include "uploadContext.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace LearnVulkan::Wrapper
+{
+    UploadContext::UploadContext(const Device::Ptr& device, VkDeviceSize stagingSize)
+    {
+        mDevice      = device;
+        mStagingSize = stagingSize;
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(mDevice->getPhysicalDevice(), &properties);
+
+        // 图像复制的缓冲区偏移需要是 4 和纹素大小的倍数，16 字节同时满足压缩格式的块大小
+        mAlignment = std::max<VkDeviceSize>(16, properties.limits.optimalBufferCopyOffsetAlignment);
+
+        mOwnershipTransfer = mDevice->hasDedicatedTransferQueue();
+        mTransferFamily    = mDevice->getTransferQueueFamily().value();
+        mGraphicFamily     = mDevice->getGraphicQueueFamily().value();
+
+        mCommandPool = CommandPool::create(mDevice, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, mTransferFamily);
+
+        if (mOwnershipTransfer)
+        {
+            mAcquirePool = CommandPool::create(mDevice);
+        }
+
+        mBatches.resize(MaxBatchesInFlight);
+
+        for (auto& batch : mBatches)
+        {
+            batch.mCommandBuffer = CommandBuffer::create(mDevice, mCommandPool);
+            batch.mFence         = Fence::create(mDevice, false);
+
+            if (mOwnershipTransfer)
+            {
+                batch.mAcquireCommandBuffer = CommandBuffer::create(mDevice, mAcquirePool);
+                batch.mTransferSemaphore    = Semaphore::create(mDevice);
+            }
+        }
+
+        // 可映射的显存足够大时暂存区放在显存里：CPU 写入经 PCIe 直达显存，复制在显存内部完成
+        mStagingDeviceLocal = mDevice->hasHostVisibleDeviceLocalMemory();
+
+        if (mStagingDeviceLocal)
+        {
+            mStagingBuffer = Buffer::create(mDevice,
+                                            mStagingSize,
+                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+        else
+        {
+            mStagingBuffer = Buffer::createStageBuffer(mDevice, mStagingSize);
+        }
+    }
+
+    UploadContext::~UploadContext()
+    {
+        // 没有 flush 的请求也要完成，否则目标资源里是未定义的内容；析构函数不能抛出，失败时只记录
+        try
+        {
+            submit();
+            wait();
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "Warning: pending uploads were not completed: " << e.what() << std::endl;
+        }
+    }
+
+    void UploadContext::uploadBuffer(const Buffer::Ptr& dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+    {
+        if (data == nullptr || size == 0)
+        {
+            return;
+        }
+
+        auto [src, srcOffset] = stage(data, size);
+
+        BufferCopy copy{};
+        copy.mSrc              = src;
+        copy.mDst              = dst;
+        copy.mRegion.srcOffset = srcOffset;
+        copy.mRegion.dstOffset = dstOffset;
+        copy.mRegion.size      = size;
+
+        mBufferCopies.push_back(copy);
+        mUploadedBytes += size;
+    }
+
+    void UploadContext::uploadImage(const Image::Ptr& dst,
+                                    const void* data,
+                                    VkDeviceSize size,
+                                    VkImageLayout finalLayout,
+                                    VkPipelineStageFlags dstStageMask,
+                                    bool generateMipmaps)
+    {
+        MipLevel level{};
+        level.mOffset = 0;
+        level.mWidth  = static_cast<uint32_t>(dst->getWidth());
+        level.mHeight = static_cast<uint32_t>(dst->getHeight());
+
+        if (data == nullptr)
+        {
+            return;
+        }
+
+        addImageCopy(dst, size, [&](uint8_t* staging) { memcpy(staging, data, static_cast<size_t>(size)); },
+                     { level }, finalLayout, dstStageMask, generateMipmaps && dst->getMipLevels() > 1);
+    }
+
+    void UploadContext::uploadImageLevels(const Image::Ptr& dst,
+                                          const void* data,
+                                          VkDeviceSize size,
+                                          const std::vector<MipLevel>& levels,
+                                          VkImageLayout finalLayout,
+                                          VkPipelineStageFlags dstStageMask)
+    {
+        if (data == nullptr)
+        {
+            return;
+        }
+
+        addImageCopy(dst, size, [&](uint8_t* staging) { memcpy(staging, data, static_cast<size_t>(size)); },
+                     levels, finalLayout, dstStageMask, false);
+    }
+
+    void UploadContext::uploadImageLevels(const Image::Ptr& dst,
+                                          VkDeviceSize size,
+                                          const std::vector<MipLevel>& levels,
+                                          const StagingWriter& write,
+                                          VkImageLayout finalLayout,
+                                          VkPipelineStageFlags dstStageMask,
+                                          bool generateMipmaps)
+    {
+        addImageCopy(dst, size, write, levels, finalLayout, dstStageMask, generateMipmaps && dst->getMipLevels() > 1);
+    }
+
+    void UploadContext::uploadImageFromHost(const Image::Ptr& dst,
+                                            const std::shared_ptr<void>& hostData,
+                                            VkDeviceSize size,
+                                            const std::vector<MipLevel>& levels,
+                                            VkImageLayout finalLayout,
+                                            VkPipelineStageFlags dstStageMask,
+                                            bool generateMipmaps)
+    {
+        if (hostData == nullptr || size == 0 || levels.empty())
+        {
+            return;
+        }
+
+        generateMipmaps = generateMipmaps && dst->getMipLevels() > 1;
+
+        if (!canImport(hostData.get(), size))
+        {
+            const void* data = hostData.get();
+            addImageCopy(dst, size, [&](uint8_t* staging) { memcpy(staging, data, static_cast<size_t>(size)); },
+                         levels, finalLayout, dstStageMask, generateMipmaps);
+            return;
+        }
+
+        // 导入的大小也要按对齐取整，allocateHostMemory 已经把分配向上取整到页
+        const VkDeviceSize alignment = mDevice->getHostPointerAlignment();
+        const VkDeviceSize importSize = (size + alignment - 1) / alignment * alignment;
+
+        auto src = Buffer::createHostImportBuffer(mDevice, hostData.get(), importSize);
+
+        addImageCopy(src, 0, dst, levels, finalLayout, dstStageMask, generateMipmaps, hostData);
+
+        mUploadedBytes += size;
+        mImportedBytes += size;
+    }
+
+    bool UploadContext::canImport(const void* hostData, VkDeviceSize size) const
+    {
+        const VkDeviceSize alignment = mDevice->getHostPointerAlignment();
+
+        // 只有 allocateHostMemory 按页分配的大块内存满足对齐，且设备的对齐要求不能比页更大
+        return mDevice->supportsHostPointerImport() &&
+               size >= HostImportMinSize &&
+               HostImportAlignment % alignment == 0 &&
+               reinterpret_cast<uintptr_t>(hostData) % alignment == 0 &&
+               mDevice->getHostPointerMemoryTypes(hostData) != 0;
+    }
+
+    void* UploadContext::allocateHostMemory(size_t size)
+    {
+        const size_t alignment   = size >= HostImportMinSize ? HostImportAlignment : 16;
+        const size_t alignedSize = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+
+#ifdef _WIN32
+        return _aligned_malloc(alignedSize, alignment);
+#else
+        return std::aligned_alloc(alignment, alignedSize);
+#endif
+    }
+
+    void* UploadContext::reallocateHostMemory(void* memory, size_t oldSize, size_t newSize)
+    {
+        void* result = allocateHostMemory(newSize);
+
+        if (result != nullptr && memory != nullptr)
+        {
+            memcpy(result, memory, std::min(oldSize, newSize));
+            freeHostMemory(memory);
+        }
+
+        return result;
+    }
+
+    void UploadContext::freeHostMemory(void* memory)
+    {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+
+    void UploadContext::addImageCopy(const Image::Ptr& dst,
+                                     VkDeviceSize size,
+                                     const StagingWriter& write,
+                                     const std::vector<MipLevel>& levels,
+                                     VkImageLayout finalLayout,
+                                     VkPipelineStageFlags dstStageMask,
+                                     bool generateMipmaps)
+    {
+        if (size == 0 || levels.empty())
+        {
+            return;
+        }
+
+        auto [src, srcOffset] = stage(size, write);
+
+        addImageCopy(src, srcOffset, dst, levels, finalLayout, dstStageMask, generateMipmaps);
+
+        mUploadedBytes += size;
+    }
+
+    void UploadContext::addImageCopy(const Buffer::Ptr& src,
+                                     VkDeviceSize srcOffset,
+                                     const Image::Ptr& dst,
+                                     const std::vector<MipLevel>& levels,
+                                     VkImageLayout finalLayout,
+                                     VkPipelineStageFlags dstStageMask,
+                                     bool generateMipmaps,
+                                     const std::shared_ptr<void>& hostData)
+    {
+        ImageCopy copy{};
+        copy.mSrc             = src;
+        copy.mDst             = dst;
+        copy.mFinalLayout     = finalLayout;
+        copy.mDstStageMask    = dstStageMask;
+        copy.mGenerateMipmaps = generateMipmaps;
+        copy.mHostData        = hostData;
+
+        for (uint32_t level = 0; level < levels.size(); ++level)
+        {
+            VkBufferImageCopy region{};
+            region.bufferOffset                    = srcOffset + levels[level].mOffset;
+            region.bufferRowLength                 = 0;
+            region.bufferImageHeight               = 0;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount     = dst->getArrayLayers();
+            region.imageOffset                     = { 0, 0, 0 };
+            region.imageExtent                     = { levels[level].mWidth, levels[level].mHeight, 1 };
+
+            copy.mRegions.push_back(region);
+        }
+
+        mImageCopies.push_back(copy);
+    }
+
+    std::pair<Buffer::Ptr, VkDeviceSize> UploadContext::stage(const void* data, VkDeviceSize size)
+    {
+        return stage(size, [&](uint8_t* staging) { memcpy(staging, data, static_cast<size_t>(size)); });
+    }
+
+    std::pair<Buffer::Ptr, VkDeviceSize> UploadContext::stage(VkDeviceSize size, const StagingWriter& write)
+    {
+        VkDeviceSize offset = 0;
+
+        while (!tryReserve(size, offset))
+        {
+            // 空间不够：先按顺序回收已提交的批次，仍不够就把正在收集的这批提交出去
+            if (mInFlightBatches > 0)
+            {
+                retireOldest();
+                continue;
+            }
+
+            if (mPendingAllocations > 0)
+            {
+                submit();
+                continue;
+            }
+
+            // 整个环形缓冲区都放不下，使用一次性的暂存缓冲区
+            auto buffer = Buffer::createStageBuffer(mDevice, size);
+            write(static_cast<uint8_t*>(buffer->getAllocation().mMappedData));
+
+            return { buffer, 0 };
+        }
+
+        // 暂存区是常驻映射的 HOST_COHERENT 内存，写完不需要刷新
+        write(static_cast<uint8_t*>(mStagingBuffer->getAllocation().mMappedData) + offset);
+
+        return { mStagingBuffer, offset };
+    }
+
+    bool UploadContext::tryReserve(VkDeviceSize size, VkDeviceSize& offset)
+    {
+        const bool empty = mPendingAllocations == 0 && mInFlightBatches == 0;
+
+        if (empty)
+        {
+            mHead = 0;
+            mTail = 0;
+        }
+
+        const VkDeviceSize start = (mHead + mAlignment - 1) / mAlignment * mAlignment;
+
+        // 回绕后不允许写到恰好等于 mTail，保证非空时 mHead != mTail
+        if (empty)
+        {
+            if (size > mStagingSize)
+            {
+                return false;
+            }
+
+            offset = 0;
+        }
+        else if (mHead >= mTail)
+        {
+            if (start + size <= mStagingSize)
+            {
+                offset = start;
+            }
+            else if (size < mTail)
+            {
+                offset = 0;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (start + size >= mTail)
+            {
+                return false;
+            }
+
+            offset = start;
+        }
+
+        mHead = offset + size;
+        ++mPendingAllocations;
+
+        return true;
+    }
+
+    void UploadContext::recordCopies(const CommandBuffer::Ptr& commandBuffer)
+    {
+        auto fullRange = [](const Image::Ptr& image)
+        {
+            VkImageSubresourceRange range{};
+            range.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            range.baseMipLevel   = 0;
+            range.levelCount     = image->getMipLevels();
+            range.baseArrayLayer = 0;
+            range.layerCount     = image->getArrayLayers();
+            return range;
+        };
+
+        // 步骤1：所有图像（全部 mip 级别）一次屏障转换到 TRANSFER_DST
+        std::vector<VkImageMemoryBarrier> barriers{};
+        barriers.reserve(mImageCopies.size());
+
+        for (const auto& copy : mImageCopies)
+        {
+            barriers.push_back(copy.mDst->transitionLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, fullRange(copy.mDst)));
+        }
+
+        commandBuffer->transferImageLayout(barriers, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        // 步骤2：缓冲区复制按 (目标, 源, 目标偏移) 排序，源和目标都首尾相接的区域合并，
+        // 同一对源 / 目标缓冲区的所有区域放进一次 vkCmdCopyBuffer
+        std::sort(mBufferCopies.begin(), mBufferCopies.end(), [](const BufferCopy& a, const BufferCopy& b)
+        {
+            if (a.mDst->getBuffer() != b.mDst->getBuffer())
+            {
+                return a.mDst->getBuffer() < b.mDst->getBuffer();
+            }
+
+            if (a.mSrc->getBuffer() != b.mSrc->getBuffer())
+            {
+                return a.mSrc->getBuffer() < b.mSrc->getBuffer();
+            }
+
+            return a.mRegion.dstOffset < b.mRegion.dstOffset;
+        });
+
+        std::vector<VkBufferCopy> regions{};
+
+        for (size_t i = 0; i < mBufferCopies.size(); ++i)
+        {
+            const auto& copy = mBufferCopies[i];
+
+            if (!regions.empty() &&
+                regions.back().srcOffset + regions.back().size == copy.mRegion.srcOffset &&
+                regions.back().dstOffset + regions.back().size == copy.mRegion.dstOffset)
+            {
+                regions.back().size += copy.mRegion.size;
+            }
+            else
+            {
+                regions.push_back(copy.mRegion);
+            }
+
+            const bool lastOfGroup = i + 1 == mBufferCopies.size() ||
+                                     mBufferCopies[i + 1].mDst != copy.mDst ||
+                                     mBufferCopies[i + 1].mSrc != copy.mSrc;
+
+            if (lastOfGroup)
+            {
+                commandBuffer->copyBufferToBuffer(copy.mSrc->getBuffer(),
+                                                   copy.mDst->getBuffer(),
+                                                   static_cast<uint32_t>(regions.size()),
+                                                   regions);
+                mCopyRegionCount += regions.size();
+                regions.clear();
+            }
+        }
+
+        // 步骤3：图像复制，每个图像的所有 mip 级别一次 vkCmdCopyBufferToImage
+        for (const auto& copy : mImageCopies)
+        {
+            commandBuffer->copyBufferToImage(copy.mSrc->getBuffer(),
+                                              copy.mDst->getImage(),
+                                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                              copy.mRegions);
+            mCopyRegionCount += copy.mRegions.size();
+        }
+
+        // 步骤4：图像转换到最终布局。需要 blit 生成 mip 的图像保持 TRANSFER_DST，
+        // blit 只能在图形队列上执行，独立传输队列时放到获取命令缓冲区里
+        barriers.clear();
+        VkPipelineStageFlags imageDstStages = 0;
+
+        std::vector<ImageCopy*> mipmapCopies{};
+
+        for (auto& copy : mImageCopies)
+        {
+            if (!copy.mGenerateMipmaps)
+            {
+                barriers.push_back(copy.mDst->transitionLayout(copy.mFinalLayout, fullRange(copy.mDst)));
+                imageDstStages |= copy.mDstStageMask;
+            }
+            else if (mOwnershipTransfer)
+            {
+                VkImageMemoryBarrier barrier{};
+                barrier.sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.oldLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.newLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.srcAccessMask    = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask    = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.image            = copy.mDst->getImage();
+                barrier.subresourceRange = fullRange(copy.mDst);
+
+                barriers.push_back(barrier);
+                imageDstStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+                mAcquireMipmaps.push_back(copy);
+            }
+            else
+            {
+                mipmapCopies.push_back(&copy);
+            }
+        }
+
+        // 缓冲区写入要对之后的顶点 / 索引 / 着色器 / 间接参数读取可见
+        const VkAccessFlags bufferReadAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                               VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+                                               VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+        const VkPipelineStageFlags bufferReadStages = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                                      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        if (!mOwnershipTransfer)
+        {
+            commandBuffer->transferImageLayout(barriers, VK_PIPELINE_STAGE_TRANSFER_BIT, imageDstStages);
+
+            for (auto* copy : mipmapCopies)
+            {
+                copy->mDst->generateMipmaps(commandBuffer, copy->mFinalLayout, copy->mDstStageMask);
+            }
+
+            if (!mBufferCopies.empty())
+            {
+                VkMemoryBarrier memoryBarrier{};
+                memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                memoryBarrier.dstAccessMask = bufferReadAccess;
+
+                commandBuffer->memoryBarrier(memoryBarrier, VK_PIPELINE_STAGE_TRANSFER_BIT, bufferReadStages);
+            }
+
+            return;
+        }
+
+        // 步骤5（独立传输队列）：传输队列释放所有权，同样的屏障（访问掩码换边）留给图形队列获取。
+        // 布局转换在释放和获取两侧的屏障里写成相同的 old / new，只执行一次
+        std::vector<VkImageMemoryBarrier>  releaseImages{};
+        std::vector<VkBufferMemoryBarrier> releaseBuffers{};
+
+        for (auto barrier : barriers)
+        {
+            barrier.srcQueueFamilyIndex = mTransferFamily;
+            barrier.dstQueueFamilyIndex = mGraphicFamily;
+
+            auto acquire = barrier;
+            acquire.srcAccessMask = 0;
+            mAcquireImageBarriers.push_back(acquire);
+
+            barrier.dstAccessMask = 0;
+            releaseImages.push_back(barrier);
+        }
+
+        for (size_t i = 0; i < mBufferCopies.size(); ++i)
+        {
+            // 已按目标排序，同一缓冲区只需要一个屏障
+            if (i > 0 && mBufferCopies[i - 1].mDst == mBufferCopies[i].mDst)
+            {
+                continue;
+            }
+
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask       = 0;
+            barrier.srcQueueFamilyIndex = mTransferFamily;
+            barrier.dstQueueFamilyIndex = mGraphicFamily;
+            barrier.buffer              = mBufferCopies[i].mDst->getBuffer();
+            barrier.offset              = 0;
+            barrier.size                = VK_WHOLE_SIZE;
+            releaseBuffers.push_back(barrier);
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = bufferReadAccess;
+            mAcquireBufferBarriers.push_back(barrier);
+        }
+
+        commandBuffer->pipelineBarrier(releaseBuffers, releaseImages, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        mAcquireStageMask = imageDstStages | (releaseBuffers.empty() ? 0 : bufferReadStages);
+    }
+
+    void UploadContext::submitAcquire(Batch& batch)
+    {
+        const auto& acquireCommandBuffer = batch.mAcquireCommandBuffer;
+
+        acquireCommandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        acquireCommandBuffer->pipelineBarrier(mAcquireBufferBarriers,
+                                               mAcquireImageBarriers,
+                                               VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                               mAcquireStageMask != 0 ? mAcquireStageMask : static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT));
+
+        for (const auto& copy : mAcquireMipmaps)
+        {
+            copy.mDst->generateMipmaps(acquireCommandBuffer, copy.mFinalLayout, copy.mDstStageMask);
+        }
+
+        acquireCommandBuffer->end();
+
+        mAcquireBufferBarriers.clear();
+        mAcquireImageBarriers.clear();
+        mAcquireMipmaps.clear();
+        mAcquireStageMask = 0;
+
+        auto commandBuffer = acquireCommandBuffer->getCommandBuffer();
+        auto semaphore     = batch.mTransferSemaphore->getSemaphore();
+
+        // 等待阶段取 TOP_OF_PIPE 之后的所有阶段，获取屏障的源阶段 TOP_OF_PIPE 与之衔接
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores    = &semaphore;
+        submitInfo.pWaitDstStageMask  = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+
+        if (vkQueueSubmit(mDevice->getGraphicQueue(), 1, &submitInfo, batch.mFence->getFence()) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to submit upload acquire command buffer!");
+        }
+    }
+
+    void UploadContext::submit()
+    {
+        if (mBufferCopies.empty() && mImageCopies.empty())
+        {
+            return;
+        }
+
+        // 所有批次槽都在执行时才等待最早的一批
+        if (mInFlightBatches == mBatches.size())
+        {
+            retireOldest();
+        }
+
+        auto& batch = mBatches[(mOldestBatch + mInFlightBatches) % mBatches.size()];
+
+        batch.mCommandBuffer->begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        recordCopies(batch.mCommandBuffer);
+        batch.mCommandBuffer->end();
+
+        auto commandBuffer = batch.mCommandBuffer->getCommandBuffer();
+        auto semaphore     = mOwnershipTransfer ? batch.mTransferSemaphore->getSemaphore() : VK_NULL_HANDLE;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers    = &commandBuffer;
+
+        // 独立传输队列时复制完成通过信号量交给图形队列的获取提交，栅栏挂在后者上
+        if (mOwnershipTransfer)
+        {
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores    = &semaphore;
+        }
+
+        batch.mFence->resetFence();
+
+        if (vkQueueSubmit(mDevice->getTransferQueue(), 1, &submitInfo, mOwnershipTransfer ? VK_NULL_HANDLE : batch.mFence->getFence()) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Error: failed to submit upload command buffer!");
+        }
+
+        if (mOwnershipTransfer)
+        {
+            submitAcquire(batch);
+        }
+
+        // 复制请求引用的资源转入这个批次，完成前保持存活
+        for (auto& copy : mBufferCopies)
+        {
+            batch.mBuffers.push_back(std::move(copy.mSrc));
+            batch.mBuffers.push_back(std::move(copy.mDst));
+        }
+
+        for (auto& copy : mImageCopies)
+        {
+            batch.mBuffers.push_back(std::move(copy.mSrc));
+            batch.mImages.push_back(std::move(copy.mDst));
+
+            if (copy.mHostData != nullptr)
+            {
+                batch.mHostData.push_back(std::move(copy.mHostData));
+            }
+        }
+
+        mBufferCopies.clear();
+        mImageCopies.clear();
+
+        batch.mHead         = mHead;
+        mPendingAllocations = 0;
+        ++mInFlightBatches;
+
+        ++mSubmitCount;
+    }
+
+    void UploadContext::retireOldest()
+    {
+        auto& batch = mBatches[mOldestBatch];
+
+        batch.mFence->block();
+
+        batch.mBuffers.clear();
+        batch.mImages.clear();
+
+        // 导入的缓冲区（及其内存）已随上面释放，之后才能释放主机内存
+        batch.mHostData.clear();
+
+        // 这一批占用的是 mTail 到提交时的 mHead 之间，之后的批次和正在收集的数据都在它后面
+        mTail        = batch.mHead;
+        mOldestBatch = (mOldestBatch + 1) % mBatches.size();
+        --mInFlightBatches;
+    }
+
+    void UploadContext::wait()
+    {
+        while (mInFlightBatches > 0)
+        {
+            retireOldest();
+        }
+    }
+
+    bool UploadContext::poll()
+    {
+        // 按提交顺序回收，较晚的批次即使先完成也等前面的批次回收后再回收
+        while (mInFlightBatches > 0 && mBatches[mOldestBatch].mFence->isSignaled())
+        {
+            retireOldest();
+        }
+
+        return mInFlightBatches == 0;
+    }
+
+    void UploadContext::flush()
+    {
+        submit();
+        wait();
+    }
+}
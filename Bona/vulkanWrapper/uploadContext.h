@@ -0,0 +1,232 @@
+﻿#pragma once
+
+#include "base.h"
+#include "device.h"
+#include "buffer.h"
+#include "image.h"
+#include "commandPool.h"
+#include "commandBuffer.h"
+#include "fence.h"
+#include "semaphore.h"
+
+#include <functional>
+
+namespace LearnVulkan::Wrapper
+{
+    // 批量上传上下文：持有一个常驻映射的暂存环形缓冲区和 MaxBatchesInFlight 个批次槽（各自的命令缓冲区和栅栏）。
+    // uploadBuffer / uploadImage 只把数据拷进暂存区并记下复制请求，submit 时把所有请求录制进一个空闲槽的命令缓冲区、
+    // 一次提交，由该槽的栅栏跟踪完成；同一目标缓冲区首尾相接的复制区域合并成一个，同一对源 / 目标缓冲区只发一次 vkCmdCopyBuffer。
+    // 环形缓冲区里同时容纳若干“已提交未完成”的批次和“正在收集”的一批数据，按提交顺序回收；
+    // 只有空间不够或所有槽都未完成时才等待最早的一批，主循环里流送的提交因此不会阻塞渲染。
+    // 超过整个环形缓冲区的单次上传使用临时暂存缓冲区。
+    //
+    // 设备有独立传输队列时复制在传输队列上执行：传输命令缓冲区末尾释放目标资源的队列族所有权，
+    // 再向图形队列提交一个等待信号量、只包含获取屏障的小命令缓冲区，栅栏挂在这次提交上。
+    // 之后提交到图形队列的渲染命令按提交顺序排在获取屏障之后，因此 submit 之后不需要等待就可以继续渲染，
+    // wait / poll 只是为了回收暂存空间。目标资源应是新创建的（上传覆盖其全部内容），
+    // 否则传输队列不先获取所有权，未覆盖的部分内容未定义。
+    //
+    // 暂存区优先放在 DEVICE_LOCAL | HOST_VISIBLE 内存里（Resizable BAR / 集成显卡），CPU 写入后复制不再跨 PCIe 读取系统内存；
+    // 设备支持 VK_EXT_external_memory_host 时，allocateHostMemory 分配的大块主机内存可以直接导入为复制源，完全不经过暂存区。
+    //
+    // 用法：加载资源时把同一个 UploadContext 传给各个 Buffer::createXxx / Model::loadModel，全部创建完后调用一次 submit（或 flush）
+    class UploadContext
+    {
+    public:
+        using Ptr = std::shared_ptr<UploadContext>;
+
+        static constexpr VkDeviceSize DefaultStagingSize = 32 * 1024 * 1024;
+
+        /// 同时在执行的批次数，都未完成时 submit 才等待最早的一批
+        static constexpr uint32_t MaxBatchesInFlight = 3;
+
+        /// 直接向暂存区写入数据的回调，参数为可写 size 字节的映射地址。
+        /// 暂存区可能是写合并的显存映射，回调只应顺序写入，不要回读已写的内容
+        using StagingWriter = std::function<void(uint8_t* dst)>;
+
+        /// 不小于 HostImportMinSize 的主机分配按 HostImportAlignment 对齐、大小向上取整，满足导入要求
+        static constexpr size_t HostImportAlignment = 4096;
+        static constexpr size_t HostImportMinSize   = 64 * 1024;
+
+        /// 可导入的主机内存（用 freeHostMemory 释放），供解码器直接把结果解到这里
+        static void* allocateHostMemory(size_t size);
+
+        static void* reallocateHostMemory(void* memory, size_t oldSize, size_t newSize);
+
+        static void freeHostMemory(void* memory);
+
+        static Ptr create(const Device::Ptr& device, VkDeviceSize stagingSize = DefaultStagingSize)
+        {
+            return std::make_shared<UploadContext>(device, stagingSize);
+        }
+
+        UploadContext(const Device::Ptr& device, VkDeviceSize stagingSize = DefaultStagingSize);
+
+        ~UploadContext();
+
+        /// 把 [data, data + size) 写入 dst 的 [dstOffset, dstOffset + size)，dst 需要 TRANSFER_DST 用途
+        void uploadBuffer(const Buffer::Ptr& dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+        /// 把紧密排列的像素写入图像第 0 级，提交时依次转换到 TRANSFER_DST、复制、转换到 finalLayout。
+        /// generateMipmaps 时其余级别在图形队列上用 blit 逐级降采样生成
+        void uploadImage(const Image::Ptr& dst,
+                         const void* data,
+                         VkDeviceSize size,
+                         VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         bool generateMipmaps = false);
+
+        /// 上传预先生成的 mip 链：data 中第 i 级位于 levels[i].mOffset
+        void uploadImageLevels(const Image::Ptr& dst,
+                               const void* data,
+                               VkDeviceSize size,
+                               const std::vector<MipLevel>& levels,
+                               VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        /// 同上，但数据由 write 直接写进暂存区（如解压的输出），不需要先放进中间内存再拷贝。
+        /// generateMipmaps 时 levels 只含第 0 级，其余级别同 uploadImage 一样用 blit 生成
+        void uploadImageLevels(const Image::Ptr& dst,
+                               VkDeviceSize size,
+                               const std::vector<MipLevel>& levels,
+                               const StagingWriter& write,
+                               VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                               bool generateMipmaps = false);
+
+        /// 同 uploadImageLevels，hostData 由 allocateHostMemory 分配：设备支持导入主机内存时直接作为复制源，
+        /// 否则拷进暂存区。hostData 在这一批上传完成前保持存活
+        void uploadImageFromHost(const Image::Ptr& dst,
+                                 const std::shared_ptr<void>& hostData,
+                                 VkDeviceSize size,
+                                 const std::vector<MipLevel>& levels,
+                                 VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                 VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 bool generateMipmaps = false);
+
+        /// 暂存区是否在可映射的显存里
+        [[nodiscard]] bool isStagingDeviceLocal() const { return mStagingDeviceLocal; }
+
+        /// 把收集到的复制请求录制并提交（有独立传输队列时提交到传输队列），不等待；
+        /// 只有 MaxBatchesInFlight 批都未完成时先等待最早的一批
+        void submit();
+
+        /// 等待所有已提交的批次完成并回收其暂存空间
+        void wait();
+
+        /// 不阻塞：按提交顺序回收已完成批次的暂存空间，返回是否没有未完成的批次
+        bool poll();
+
+        /// submit + wait，返回后所有上传的数据对之后的提交可见
+        void flush();
+
+        [[nodiscard]] auto getSubmitCount()     const { return mSubmitCount; }
+        [[nodiscard]] auto getCopyRegionCount() const { return mCopyRegionCount; }
+        [[nodiscard]] auto getUploadedBytes()   const { return mUploadedBytes; }
+        [[nodiscard]] auto getImportedBytes()   const { return mImportedBytes; }
+
+    private:
+        struct BufferCopy
+        {
+            Buffer::Ptr  mSrc{ nullptr };
+            Buffer::Ptr  mDst{ nullptr };
+            VkBufferCopy mRegion{};
+        };
+
+        struct ImageCopy
+        {
+            std::shared_ptr<void>          mHostData{ nullptr };   // 导入的主机内存，声明在 mSrc 之前，保证后于 mSrc 释放
+            Buffer::Ptr                    mSrc{ nullptr };
+            Image::Ptr                     mDst{ nullptr };
+            std::vector<VkBufferImageCopy> mRegions{};
+            VkImageLayout                  mFinalLayout{ VK_IMAGE_LAYOUT_UNDEFINED };
+            VkPipelineStageFlags           mDstStageMask{ 0 };
+            bool                           mGenerateMipmaps{ false };
+        };
+
+        // 一个批次槽：提交后直到栅栏触发前，命令缓冲区和引用的资源（目标和临时暂存缓冲区）都不能复用或释放
+        struct Batch
+        {
+            CommandBuffer::Ptr mCommandBuffer{ nullptr };
+            CommandBuffer::Ptr mAcquireCommandBuffer{ nullptr };   // 独立传输队列时图形队列上的获取命令缓冲区
+            Semaphore::Ptr     mTransferSemaphore{ nullptr };      // 独立传输队列时传输 -> 图形的信号量
+            Fence::Ptr         mFence{ nullptr };
+
+            VkDeviceSize                       mHead{ 0 };   // 提交时的 mHead，这一批完成后 mTail 前进到这里
+            std::vector<Buffer::Ptr>           mBuffers{};
+            std::vector<Image::Ptr>            mImages{};
+            std::vector<std::shared_ptr<void>> mHostData{};
+        };
+
+        void addImageCopy(const Buffer::Ptr& src,
+                          VkDeviceSize srcOffset,
+                          const Image::Ptr& dst,
+                          const std::vector<MipLevel>& levels,
+                          VkImageLayout finalLayout,
+                          VkPipelineStageFlags dstStageMask,
+                          bool generateMipmaps,
+                          const std::shared_ptr<void>& hostData = nullptr);
+
+        void addImageCopy(const Image::Ptr& dst,
+                          VkDeviceSize size,
+                          const StagingWriter& write,
+                          const std::vector<MipLevel>& levels,
+                          VkImageLayout finalLayout,
+                          VkPipelineStageFlags dstStageMask,
+                          bool generateMipmaps);
+
+        bool canImport(const void* hostData, VkDeviceSize size) const;
+
+        /// 在暂存区中为 size 字节找位置并写入 data，返回所在缓冲区和偏移
+        std::pair<Buffer::Ptr, VkDeviceSize> stage(const void* data, VkDeviceSize size);
+
+        std::pair<Buffer::Ptr, VkDeviceSize> stage(VkDeviceSize size, const StagingWriter& write);
+
+        bool tryReserve(VkDeviceSize size, VkDeviceSize& offset);
+
+        void recordCopies(const CommandBuffer::Ptr& commandBuffer);
+
+        void submitAcquire(Batch& batch);
+
+        /// 等待最早提交的一批完成并回收
+        void retireOldest();
+
+    private:
+        Device::Ptr      mDevice{ nullptr };
+        CommandPool::Ptr mCommandPool{ nullptr };
+
+        // 批次槽按环形使用：[mOldestBatch, mOldestBatch + mInFlightBatches) 为已提交未完成的批次
+        std::vector<Batch> mBatches{};
+        size_t             mOldestBatch{ 0 };
+        size_t             mInFlightBatches{ 0 };
+
+        // 独立传输队列时：获取命令缓冲区所在的图形命令池，以及录制时收集、留给获取提交的屏障
+        bool                               mOwnershipTransfer{ false };
+        uint32_t                           mTransferFamily{ 0 };
+        uint32_t                           mGraphicFamily{ 0 };
+        CommandPool::Ptr                   mAcquirePool{ nullptr };
+        std::vector<VkBufferMemoryBarrier> mAcquireBufferBarriers{};
+        std::vector<VkImageMemoryBarrier>  mAcquireImageBarriers{};
+        std::vector<ImageCopy>             mAcquireMipmaps{};
+        VkPipelineStageFlags               mAcquireStageMask{ 0 };
+
+        Buffer::Ptr  mStagingBuffer{ nullptr };
+        VkDeviceSize mStagingSize{ 0 };
+        bool         mStagingDeviceLocal{ false };
+        VkDeviceSize mAlignment{ 16 };
+
+        // 环形缓冲区中 [mTail, mHead) 为在用区域（mHead < mTail 时跨越末尾回绕）；
+        // mPendingAllocations 是正在收集的这批在环形缓冲区中的分配数，它为 0 且没有未完成的批次时环形缓冲区为空
+        VkDeviceSize mHead{ 0 };
+        VkDeviceSize mTail{ 0 };
+        size_t       mPendingAllocations{ 0 };
+
+        std::vector<BufferCopy> mBufferCopies{};
+        std::vector<ImageCopy>  mImageCopies{};
+
+        uint64_t     mSubmitCount{ 0 };
+        uint64_t     mCopyRegionCount{ 0 };
+        VkDeviceSize mUploadedBytes{ 0 };
+        VkDeviceSize mImportedBytes{ 0 };
+    };
+}